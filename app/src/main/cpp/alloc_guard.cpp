@@ -0,0 +1,129 @@
+#include "alloc_guard.h"
+
+#ifndef NDEBUG
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "mem_tracker.h"
+
+namespace {
+    thread_local bool frameActive = false;
+    thread_local uint32_t frameAllocs = 0;
+    // Set from one thread, read by every allocating thread.
+    std::atomic<bool> failFast{false};
+
+    // Every block is prefixed with its size and tag so frees can be
+    // credited back to the right MemTracker bucket, and with how far the
+    // header sits from the start of the malloc block, which over-aligned
+    // blocks need to find it again.
+    struct BlockHeader {
+        size_t size;
+        MemTag tag;
+        uint32_t offset;
+    };
+    const size_t headerSize = alignof(std::max_align_t);
+    static_assert(sizeof(BlockHeader) <= headerSize, "header must not break alignment");
+
+    void *allocate(size_t size, size_t align = headerSize) {
+        if (frameActive) {
+            frameAllocs++;
+            if (failFast.load(std::memory_order_relaxed)) {
+                abort();
+            }
+        }
+        // malloc returns headerSize-aligned memory, so the first align
+        // boundary past the header is at most align bytes in.
+        align = align > headerSize ? align : headerSize;
+        auto *base = static_cast<char *>(malloc(align + size));
+        if (!base) {
+            abort();
+        }
+        auto block = ((uintptr_t) base + headerSize + align - 1) & ~(uintptr_t) (align - 1);
+        auto *header = reinterpret_cast<BlockHeader *>(block - headerSize);
+        header->size = size;
+        header->tag = MemTracker::currentTag();
+        header->offset = (uint32_t) ((char *) header - base);
+        MemTracker::onAlloc(header->tag, size);
+        return reinterpret_cast<void *>(block);
+    }
+
+    void release(void *p) {
+        if (!p) {
+            return;
+        }
+        auto *header = reinterpret_cast<BlockHeader *>(static_cast<char *>(p) - headerSize);
+        MemTracker::onFree(header->tag, header->size);
+        free(reinterpret_cast<char *>(header) - header->offset);
+    }
+}
+
+namespace AllocGuard {
+    void beginFrame() {
+        frameAllocs = 0;
+        frameActive = true;
+    }
+
+    uint32_t endFrame() {
+        frameActive = false;
+        return frameAllocs;
+    }
+
+    void setFailFast(bool enabled) {
+        failFast.store(enabled, std::memory_order_relaxed);
+    }
+}
+
+// Replacements for the global allocation functions. The library is built
+// without exceptions in mind, so allocation failure aborts instead of throwing.
+void *operator new(size_t size) { return allocate(size); }
+
+void *operator new[](size_t size) { return allocate(size); }
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return allocate(size); }
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return allocate(size); }
+
+void operator delete(void *p) noexcept { release(p); }
+
+void operator delete[](void *p) noexcept { release(p); }
+
+void operator delete(void *p, size_t) noexcept { release(p); }
+
+void operator delete[](void *p, size_t) noexcept { release(p); }
+
+void operator delete(void *p, const std::nothrow_t &) noexcept { release(p); }
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept { release(p); }
+
+// Over-aligned types (alignas above alignof(std::max_align_t)) come here.
+void *operator new(size_t size, std::align_val_t align) { return allocate(size, (size_t) align); }
+
+void *operator new[](size_t size, std::align_val_t align) {
+    return allocate(size, (size_t) align);
+}
+
+void *operator new(size_t size, std::align_val_t align, const std::nothrow_t &) noexcept {
+    return allocate(size, (size_t) align);
+}
+
+void *operator new[](size_t size, std::align_val_t align, const std::nothrow_t &) noexcept {
+    return allocate(size, (size_t) align);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept { release(p); }
+
+void operator delete[](void *p, std::align_val_t) noexcept { release(p); }
+
+void operator delete(void *p, size_t, std::align_val_t) noexcept { release(p); }
+
+void operator delete[](void *p, size_t, std::align_val_t) noexcept { release(p); }
+
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept { release(p); }
+
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept { release(p); }
+
+#endif
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Debug-only detector for heap allocations inside the frame loop.
+ * Debug builds replace the global operator new/delete and count every
+ * allocation made by a thread while it is between beginFrame() and
+ * endFrame(). With fail-fast enabled the first such allocation aborts, so
+ * the offending call stack ends up in the tombstone.
+ * Release builds (NDEBUG) compile all of this down to nothing.
+ */
+namespace AllocGuard {
+#ifndef NDEBUG
+
+    void beginFrame();
+
+    /**
+     * @return the number of heap allocations made by this thread since beginFrame()
+     */
+    uint32_t endFrame();
+
+    void setFailFast(bool enabled);
+
+#else
+
+    inline void beginFrame() {}
+
+    inline uint32_t endFrame() { return 0; }
+
+    inline void setFailFast(bool) {}
+
+#endif
+}
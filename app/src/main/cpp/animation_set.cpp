@@ -0,0 +1,123 @@
+#include "animation_set.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Zero-length segments are steps: they hold their first key.
+    inline float inverseLength(float length) {
+        return length > 0 ? 1.0f / length : 0.0f;
+    }
+}
+
+AnimationSet::TrackId AnimationSet::addTrack(size_t first, size_t count, float length,
+                                             bool looping) {
+    auto id = (TrackId) time.size();
+    firstSegment.push_back((uint32_t) first);
+    segmentCount.push_back((uint32_t) count);
+    cursor.push_back(0);
+    time.push_back(0);
+    speed.push_back(1);
+    duration.push_back(length);
+    // A zero-length track cannot wrap; it just holds its first key.
+    loop.push_back(looping && length > 0 ? 1.0f : 0.0f);
+    for (auto *v: {&u, &p0, &p1, &m0, &m1, &values}) {
+        v->push_back(0);
+    }
+    values[id] = count ? segments[first].p0 : 0;
+    return id;
+}
+
+AnimationSet::TrackId AnimationSet::addHermite(const float *times, const float *keys,
+                                               const float *tangents, size_t n,
+                                               bool looping) {
+    auto first = segments.size();
+    for (size_t i = 0; i + 1 < n; i++) {
+        float length = times[i + 1] - times[i];
+        segments.push_back(Segment{times[i], inverseLength(length), keys[i], keys[i + 1],
+                                   tangents[i] * length, tangents[i + 1] * length});
+    }
+    return addTrack(first, segments.size() - first, n ? times[n - 1] : 0, looping);
+}
+
+AnimationSet::TrackId AnimationSet::addBezier(const float *times, const float *keys,
+                                              const float *controls, size_t n, bool looping) {
+    auto first = segments.size();
+    for (size_t i = 0; i + 1 < n; i++) {
+        float length = times[i + 1] - times[i];
+        // A cubic Bezier's end tangents are three times its control legs.
+        segments.push_back(Segment{times[i], inverseLength(length), keys[i], keys[i + 1],
+                                   3 * (controls[2 * i] - keys[i]),
+                                   3 * (keys[i + 1] - controls[2 * i + 1])});
+    }
+    return addTrack(first, segments.size() - first, n ? times[n - 1] : 0, looping);
+}
+
+AnimationSet::TrackId AnimationSet::addTween(float from, float to, float seconds, bool looping) {
+    if (!(seconds > 0)) {
+        // No duration (or a bad one): a step that holds the target.
+        from = to;
+        seconds = 0;
+    }
+    const float times[] = {0, seconds};
+    const float keys[] = {from, to};
+    const float slope = seconds > 0 ? (to - from) / seconds : 0;
+    const float tangents[] = {slope, slope};
+    return addHermite(times, keys, tangents, 2, looping);
+}
+
+void AnimationSet::update(float dt) {
+    const size_t n = time.size();
+    float *__restrict t = time.data();
+    const float *__restrict s = speed.data();
+    const float *__restrict d = duration.data();
+    const float *__restrict l = loop.data();
+    for (size_t i = 0; i < n; i++) {
+        float next = t[i] + dt * s[i];
+        float wrapped = next - d[i] * std::floor(next / d[i]);
+        float clamped = std::min(std::max(next, 0.0f), d[i]);
+        t[i] = l[i] != 0 ? wrapped : clamped;
+    }
+
+    // Segment lookup and gather; playheads rarely skip a segment, so walk
+    // from the previous one.
+    for (size_t i = 0; i < n; i++) {
+        auto count = segmentCount[i];
+        if (!count) {
+            u[i] = p0[i] = p1[i] = m0[i] = m1[i] = 0;
+            continue;
+        }
+        auto *seg = &segments[firstSegment[i]];
+        auto c = cursor[i];
+        while (c + 1 < count && t[i] >= seg[c + 1].t0) {
+            c++;
+        }
+        while (c > 0 && t[i] < seg[c].t0) {
+            c--;
+        }
+        cursor[i] = c;
+        auto &sg = seg[c];
+        u[i] = std::min(std::max((t[i] - sg.t0) * sg.invLength, 0.0f), 1.0f);
+        p0[i] = sg.p0;
+        p1[i] = sg.p1;
+        m0[i] = sg.m0;
+        m1[i] = sg.m1;
+    }
+
+    const float *__restrict uu = u.data();
+    const float *__restrict a = p0.data();
+    const float *__restrict b = p1.data();
+    const float *__restrict ma = m0.data();
+    const float *__restrict mb = m1.data();
+    float *__restrict out = values.data();
+    for (size_t i = 0; i < n; i++) {
+        float x = uu[i];
+        float x2 = x * x;
+        float x3 = x2 * x;
+        float h00 = 2 * x3 - 3 * x2 + 1;
+        float h10 = x3 - 2 * x2 + x;
+        float h01 = -2 * x3 + 3 * x2;
+        float h11 = x3 - x2;
+        out[i] = h00 * a[i] + h10 * ma[i] + h01 * b[i] + h11 * mb[i];
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Batch evaluator for scalar animation tracks.
+ * Every track is a run of cubic Hermite segments in one packed array;
+ * linear tweens and Bezier curves are converted to Hermite form when added.
+ * update() advances all playheads by an explicit delta time (scaled per
+ * track), finds each track's current segment (cached, so normally O(1)),
+ * gathers the segment coefficients into structure-of-arrays scratch and
+ * then evaluates every track in one vectorizable loop.
+ */
+class AnimationSet {
+public:
+    typedef uint32_t TrackId;
+
+private:
+    struct Segment {
+        float t0;
+        float invLength;
+        // Endpoints and tangents, the latter in value units per segment.
+        float p0, p1, m0, m1;
+    };
+
+    std::vector<Segment> segments;
+    // Per-track state, one array per field.
+    std::vector<uint32_t> firstSegment, segmentCount, cursor;
+    std::vector<float> time, speed, duration, loop;
+    // Gathered coefficients for the evaluation pass.
+    std::vector<float> u, p0, p1, m0, m1;
+    std::vector<float> values;
+
+    TrackId addTrack(size_t first, size_t count, float length, bool looping);
+
+public:
+    /**
+     * Keyframes at ascending times with a tangent (value per second) at each.
+     */
+    TrackId addHermite(const float *times, const float *keys, const float *tangents, size_t n,
+                       bool looping);
+
+    /**
+     * Keyframes joined by cubic Bezier segments; segment i uses control
+     * values controls[2i] (leaving key i) and controls[2i+1] (entering key i+1).
+     */
+    TrackId addBezier(const float *times, const float *keys, const float *controls, size_t n,
+                      bool looping);
+
+    /**
+     * Straight ramp from one value to another over a duration in seconds.
+     * A duration that is not positive makes a step straight to the target.
+     */
+    TrackId addTween(float from, float to, float seconds, bool looping);
+
+    inline void setSpeed(TrackId id, float scale) { speed[id] = scale; }
+
+    inline void setTime(TrackId id, float seconds) { time[id] = seconds; }
+
+    inline float getDuration(TrackId id) const { return duration[id]; }
+
+    /**
+     * Advance every track by dt seconds (times its speed) and re-evaluate.
+     */
+    void update(float dt);
+
+    inline float value(TrackId id) const { return values[id]; }
+
+    inline size_t size() const { return time.size(); }
+};
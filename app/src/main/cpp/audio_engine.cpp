@@ -0,0 +1,354 @@
+#include "audio_engine.h"
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "engine_clock.h"
+#include "logging.h"
+
+bool AudioEngine::send(const Command &command) {
+    if (commands.push(command)) {
+        return true;
+    }
+    droppedCommands.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+AudioEngine::VoiceId AudioEngine::play(const AudioClip *clip, float gain, float pan, bool loop,
+                                       Resampler resampler) {
+    VoiceId id = nextId++;
+    if (!nextId) {
+        nextId = 1;
+    }
+    return send(Command{Op::Play, loop, resampler, id, clip, nullptr, gain, pan}) ? id : 0;
+}
+
+AudioEngine::VoiceId AudioEngine::playStream(AudioStream *stream, float gain, float pan) {
+    VoiceId id = nextId++;
+    if (!nextId) {
+        nextId = 1;
+    }
+    return send(Command{Op::PlayStream, false, Resampler::Linear, id, nullptr, stream, gain,
+                        pan}) ? id : 0;
+}
+
+void AudioEngine::setVoice(VoiceId id, float gain, float pan) {
+    send(Command{Op::Set, false, Resampler::Linear, id, nullptr, nullptr, gain, pan});
+}
+
+void AudioEngine::stopVoice(VoiceId id) {
+    send(Command{Op::Stop, false, Resampler::Linear, id, nullptr, nullptr, 0, 0});
+}
+
+void AudioEngine::stopAll() {
+    send(Command{Op::StopAll, false, Resampler::Linear, 0, nullptr, nullptr, 0, 0});
+}
+
+AudioEngine::Stats AudioEngine::getStats() const {
+    Stats s{};
+    s.callbacks = callbacks.load(std::memory_order_relaxed);
+    s.lastCallbackNs = lastCallbackNs.load(std::memory_order_relaxed);
+    s.maxCallbackNs = maxCallbackNs.load(std::memory_order_relaxed);
+    s.avgCallbackNs = s.callbacks ? totalCallbackNs.load(std::memory_order_relaxed) /
+                                    (int64_t) s.callbacks : 0;
+    s.budgetNs = (int64_t) burstFrames * 1000000000LL / sampleRate;
+#if defined(__ANDROID__)
+    s.xruns = stream ? AAudioStream_getXRunCount(stream) : 0;
+#else
+    s.xruns = hostXruns.load(std::memory_order_relaxed);
+#endif
+    s.droppedCommands = droppedCommands.load(std::memory_order_relaxed);
+    s.activeVoices = activeVoices.load(std::memory_order_relaxed);
+    return s;
+}
+
+void AudioEngine::applyCommand(const Command &command) {
+    if (command.op == Op::StopAll) {
+        for (auto &v : voices) {
+            v.id = 0;
+        }
+        return;
+    }
+    Voice *voice = nullptr;
+    for (auto &v : voices) {
+        bool starts = command.op == Op::Play || command.op == Op::PlayStream;
+        if (starts ? v.id == 0 : v.id == command.id) {
+            voice = &v;
+            break;
+        }
+    }
+    if (!voice) {
+        // Out of voices, or the voice already finished.
+        return;
+    }
+    if (command.op == Op::Stop) {
+        voice->id = 0;
+        return;
+    }
+    if (command.op == Op::Play) {
+        if (!command.clip || !command.clip->frames) {
+            return;
+        }
+        voice->id = command.id;
+        voice->stream = nullptr;
+        mixer.start(voice->state, command.clip, command.loop, command.resampler);
+    } else if (command.op == Op::PlayStream) {
+        if (!command.stream) {
+            return;
+        }
+        voice->id = command.id;
+        voice->stream = command.stream;
+    }
+    AudioMixer::setGainPan(voice->state, command.gain, command.pan);
+}
+
+bool AudioEngine::mixStream(Voice &voice, float *out, uint32_t frames) {
+    while (frames) {
+        uint32_t want = std::min(frames, AudioMixer::blockFrames);
+        uint32_t got = voice.stream->read(streamScratch, want);
+        AudioMixer::mixStereo(out, streamScratch, got, voice.state.gainL, voice.state.gainR);
+        if (got < want) {
+            // Underrun (counted by the stream) or the end.
+            return !voice.stream->finished();
+        }
+        out += got * channelCount;
+        frames -= got;
+    }
+    return true;
+}
+
+void AudioEngine::mix(float *out, int32_t frames) {
+    uint32_t active = 0;
+    for (auto &v : voices) {
+        if (!v.id) {
+            continue;
+        }
+        bool playing = v.stream ? mixStream(v, out, (uint32_t) frames)
+                                : mixer.mix(v.state, out, (uint32_t) frames);
+        if (!playing) {
+            v.id = 0;
+        }
+        active += v.id != 0;
+    }
+    activeVoices.store(active, std::memory_order_relaxed);
+}
+
+void AudioEngine::render(float *out, int32_t frames) {
+    int64_t begin = monotonicNs();
+    Command command;
+    while (commands.pop(command)) {
+        applyCommand(command);
+    }
+    memset(out, 0, sizeof(float) * frames * channelCount);
+    mix(out, frames);
+    int64_t elapsed = monotonicNs() - begin;
+    // Single writer: plain load/store pairs are enough.
+    lastCallbackNs.store(elapsed, std::memory_order_relaxed);
+    if (elapsed > maxCallbackNs.load(std::memory_order_relaxed)) {
+        maxCallbackNs.store(elapsed, std::memory_order_relaxed);
+    }
+    totalCallbackNs.store(totalCallbackNs.load(std::memory_order_relaxed) + elapsed,
+                          std::memory_order_relaxed);
+    callbacks.store(callbacks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+#if defined(__ANDROID__)
+
+aaudio_data_callback_result_t AudioEngine::dataCallback(AAudioStream *, void *user,
+                                                        void *audioData, int32_t numFrames) {
+    static_cast<AudioEngine *>(user)->render(static_cast<float *>(audioData), numFrames);
+    return AAUDIO_CALLBACK_RESULT_CONTINUE;
+}
+
+void AudioEngine::errorCallback(AAudioStream *, void *user, aaudio_result_t error) {
+    // The stream may not be closed from its own callback; leave that to maintain().
+    if (error == AAUDIO_ERROR_DISCONNECTED) {
+        static_cast<AudioEngine *>(user)->streamLost.store(true, std::memory_order_release);
+    }
+}
+
+bool AudioEngine::openStream() {
+    AAudioStreamBuilder *builder = nullptr;
+    if (AAudio_createStreamBuilder(&builder) != AAUDIO_OK) {
+        return false;
+    }
+    AAudioStreamBuilder_setDirection(builder, AAUDIO_DIRECTION_OUTPUT);
+    AAudioStreamBuilder_setPerformanceMode(builder, AAUDIO_PERFORMANCE_MODE_LOW_LATENCY);
+    AAudioStreamBuilder_setSharingMode(builder, AAUDIO_SHARING_MODE_EXCLUSIVE);
+    AAudioStreamBuilder_setFormat(builder, AAUDIO_FORMAT_PCM_FLOAT);
+    AAudioStreamBuilder_setChannelCount(builder, channelCount);
+    AAudioStreamBuilder_setDataCallback(builder, dataCallback, this);
+    AAudioStreamBuilder_setErrorCallback(builder, errorCallback, this);
+    auto result = AAudioStreamBuilder_openStream(builder, &stream);
+    AAudioStreamBuilder_delete(builder);
+    if (result != AAUDIO_OK) {
+        LOGW("audio: openStream failed: %s", AAudio_convertResultToText(result));
+        stream = nullptr;
+        return false;
+    }
+    sampleRate = AAudioStream_getSampleRate(stream);
+    burstFrames = AAudioStream_getFramesPerBurst(stream);
+    mixer.setOutputRate((uint32_t) sampleRate);
+    // Double buffering: the lowest latency that still tolerates one late callback.
+    AAudioStream_setBufferSizeInFrames(stream, burstFrames * 2);
+    LOGI("audio: %d Hz, burst %d frames, %s, %s", sampleRate, burstFrames,
+         AAudioStream_getSharingMode(stream) == AAUDIO_SHARING_MODE_EXCLUSIVE
+         ? "exclusive" : "shared",
+         AAudioStream_getPerformanceMode(stream) == AAUDIO_PERFORMANCE_MODE_LOW_LATENCY
+         ? "low latency" : "normal latency");
+    return true;
+}
+
+bool AudioEngine::open(const char *) {
+    close();
+    streamLost.store(false, std::memory_order_relaxed);
+    return openStream();
+}
+
+void AudioEngine::close() {
+    if (stream) {
+        AAudioStream_requestStop(stream);
+        AAudioStream_close(stream);
+        stream = nullptr;
+    }
+    started = false;
+}
+
+void AudioEngine::start() {
+    if (stream && !started) {
+        started = AAudioStream_requestStart(stream) == AAUDIO_OK;
+    }
+}
+
+void AudioEngine::stop() {
+    if (stream && started) {
+        AAudioStream_requestStop(stream);
+        started = false;
+    }
+}
+
+bool AudioEngine::maintain() {
+    if (!streamLost.exchange(false, std::memory_order_acquire)) {
+        return false;
+    }
+    bool wasStarted = started;
+    LOGI("audio: output disconnected, reopening");
+    if (stream) {
+        AAudioStream_close(stream);
+        stream = nullptr;
+    }
+    started = false;
+    if (!openStream()) {
+        return false;
+    }
+    if (wasStarted) {
+        start();
+    }
+    return true;
+}
+
+#else
+
+namespace {
+    void writeLe32(FILE *f, uint32_t v) {
+        uint8_t b[4] = {(uint8_t) v, (uint8_t) (v >> 8), (uint8_t) (v >> 16), (uint8_t) (v >> 24)};
+        fwrite(b, 1, 4, f);
+    }
+
+    void writeLe16(FILE *f, uint16_t v) {
+        uint8_t b[2] = {(uint8_t) v, (uint8_t) (v >> 8)};
+        fwrite(b, 1, 2, f);
+    }
+
+    void writeWavHeader(FILE *f, int32_t sampleRate, uint32_t dataBytes) {
+        const uint16_t bytesPerFrame = AudioEngine::channelCount * sizeof(float);
+        fseek(f, 0, SEEK_SET);
+        fwrite("RIFF", 1, 4, f);
+        writeLe32(f, 36 + dataBytes);
+        fwrite("WAVEfmt ", 1, 8, f);
+        writeLe32(f, 16);
+        writeLe16(f, 3);  // IEEE float
+        writeLe16(f, AudioEngine::channelCount);
+        writeLe32(f, (uint32_t) sampleRate);
+        writeLe32(f, (uint32_t) sampleRate * bytesPerFrame);
+        writeLe16(f, bytesPerFrame);
+        writeLe16(f, 32);
+        fwrite("data", 1, 4, f);
+        writeLe32(f, dataBytes);
+    }
+}
+
+bool AudioEngine::open(const char *wavPath) {
+    close();
+    sinkBuffer.assign((size_t) burstFrames * channelCount, 0);
+    if (wavPath) {
+        wav = fopen(wavPath, "wb");
+        if (!wav) {
+            LOGW("audio: cannot write %s", wavPath);
+            return false;
+        }
+        wavBytes = 0;
+        writeWavHeader(wav, sampleRate, 0);
+    }
+    LOGI("audio: host sink, %d Hz, burst %d frames%s%s", sampleRate, burstFrames,
+         wavPath ? ", writing " : "", wavPath ? wavPath : "");
+    return true;
+}
+
+void AudioEngine::close() {
+    stop();
+    if (wav) {
+        writeWavHeader(wav, sampleRate, wavBytes);
+        fclose(wav);
+        wav = nullptr;
+    }
+}
+
+void AudioEngine::start() {
+    if (started) {
+        return;
+    }
+    sinkRunning.store(true, std::memory_order_relaxed);
+    sinkThread = std::thread(&AudioEngine::sinkMain, this);
+    started = true;
+}
+
+void AudioEngine::stop() {
+    if (!started) {
+        return;
+    }
+    sinkRunning.store(false, std::memory_order_relaxed);
+    sinkThread.join();
+    started = false;
+}
+
+bool AudioEngine::maintain() {
+    return false;
+}
+
+void AudioEngine::sinkMain() {
+    pthread_setname_np(pthread_self(), "engine-audio");
+    const auto period = std::chrono::nanoseconds((int64_t) burstFrames * 1000000000LL /
+                                                 sampleRate);
+    auto deadline = std::chrono::steady_clock::now();
+    while (sinkRunning.load(std::memory_order_relaxed)) {
+        render(sinkBuffer.data(), burstFrames);
+        if (wav) {
+            wavBytes += (uint32_t) (sizeof(float) *
+                                    fwrite(sinkBuffer.data(), sizeof(float), sinkBuffer.size(),
+                                           wav));
+        }
+        deadline += period;
+        std::this_thread::sleep_until(deadline);
+        if (std::chrono::steady_clock::now() > deadline + period) {
+            // A real device would have run dry; resynchronize like it does.
+            hostXruns.fetch_add(1, std::memory_order_relaxed);
+            deadline = std::chrono::steady_clock::now();
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "audio_mixer.h"
+#include "audio_stream.h"
+#include "spsc_ring.h"
+
+#if defined(__ANDROID__)
+#include <aaudio/AAudio.h>
+#endif
+
+/**
+ * Stereo float output with a real-time mixing callback.
+ * On Android this is an AAudio stream in low-latency, exclusive mode (the
+ * system may grant shared instead). Elsewhere a timer thread drives the
+ * same callback and either discards the output or writes it to a WAV file.
+ * The engine thread controls voices through a lock-free command queue;
+ * the callback drains it and mixes through AudioMixer without locks or
+ * allocation.
+ */
+class AudioEngine {
+public:
+    typedef uint32_t VoiceId;
+
+    static const int channelCount = 2;
+    static const int maxVoices = 32;
+
+    struct Stats {
+        uint64_t callbacks;
+        int64_t lastCallbackNs;
+        int64_t maxCallbackNs;
+        int64_t avgCallbackNs;
+        // Time one burst of audio lasts; callbacks must stay well below it.
+        int64_t budgetNs;
+        int32_t xruns;
+        uint32_t droppedCommands;
+        uint32_t activeVoices;
+    };
+
+private:
+    enum class Op : uint8_t {
+        Play, PlayStream, Stop, Set, StopAll
+    };
+
+    struct Command {
+        Op op;
+        bool loop;
+        Resampler resampler;
+        VoiceId id;
+        const AudioClip *clip;
+        AudioStream *stream;
+        float gain;
+        float pan;
+    };
+
+    struct Voice {
+        VoiceId id;
+        // Set for streamed voices, which only use the gains of state.
+        AudioStream *stream;
+        AudioMixer::Voice state;
+    };
+
+    SpscRing<Command> commands{256};
+    // Owned by the callback thread.
+    AudioMixer mixer;
+    Voice voices[maxVoices] = {};
+    float streamScratch[AudioMixer::blockFrames * channelCount];
+
+    int32_t sampleRate = 48000;
+    int32_t burstFrames = 192;
+    VoiceId nextId = 1;
+    bool started = false;
+
+    std::atomic<uint64_t> callbacks{0};
+    std::atomic<int64_t> lastCallbackNs{0};
+    std::atomic<int64_t> maxCallbackNs{0};
+    std::atomic<int64_t> totalCallbackNs{0};
+    std::atomic<int32_t> hostXruns{0};
+    std::atomic<uint32_t> droppedCommands{0};
+    std::atomic<uint32_t> activeVoices{0};
+    std::atomic<bool> streamLost{false};
+
+#if defined(__ANDROID__)
+    AAudioStream *stream = nullptr;
+
+    bool openStream();
+
+    static aaudio_data_callback_result_t dataCallback(AAudioStream *stream, void *user,
+                                                      void *audioData, int32_t numFrames);
+
+    static void errorCallback(AAudioStream *stream, void *user, aaudio_result_t error);
+#else
+    std::thread sinkThread;
+    std::atomic<bool> sinkRunning{false};
+    FILE *wav = nullptr;
+    uint32_t wavBytes = 0;
+    std::vector<float> sinkBuffer;
+
+    void sinkMain();
+#endif
+
+    bool send(const Command &command);
+
+    void applyCommand(const Command &command);
+
+    bool mixStream(Voice &voice, float *out, uint32_t frames);
+
+    void mix(float *out, int32_t frames);
+
+public:
+    ~AudioEngine() { close(); }
+
+    /**
+     * Open the output. wavPath only applies to the host sink; nullptr
+     * discards the audio.
+     * @return false if no output stream could be opened
+     */
+    bool open(const char *wavPath = nullptr);
+
+    void close();
+
+    void start();
+
+    void stop();
+
+    /**
+     * Reopen the stream if the device was disconnected (e.g. headphones
+     * unplugged). Call regularly from the engine thread.
+     * @return true if the stream was reopened; the sample rate may have changed
+     */
+    bool maintain();
+
+    inline int32_t getSampleRate() const { return sampleRate; }
+
+    inline int32_t getBurstFrames() const { return burstFrames; }
+
+    /*
+     * Voice control. Commands take effect at the next callback; call these
+     * from the engine thread only (the queue has a single producer).
+     */
+
+    /**
+     * @param pan -1 (left) to 1 (right)
+     * @param resampler used when the clip's rate differs from the output rate
+     * @return the voice id, or 0 if the command queue was full
+     */
+    VoiceId play(const AudioClip *clip, float gain = 1, float pan = 0, bool loop = false,
+                 Resampler resampler = Resampler::Linear);
+
+    /**
+     * Play a stream that an AudioStreamer keeps filled. The voice ends when
+     * the stream finishes; the stream must outlive the voice.
+     */
+    VoiceId playStream(AudioStream *stream, float gain = 1, float pan = 0);
+
+    void setVoice(VoiceId id, float gain, float pan);
+
+    void stopVoice(VoiceId id);
+
+    void stopAll();
+
+    Stats getStats() const;
+
+    /**
+     * Fill frames of interleaved stereo output. This is the real-time
+     * callback body: no locks, no allocation, no I/O.
+     */
+    void render(float *out, int32_t frames);
+};
@@ -0,0 +1,329 @@
+#include "audio_mixer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+    const uint64_t one = 1ull << 32;
+    const uint64_t fracMask = one - 1;
+    // Source frames before/after the interpolation point a sinc window reads.
+    const int tapsBefore = AudioMixer::sincTaps / 2 - 1;
+    const int tapsAfter = AudioMixer::sincTaps / 2;
+    const float int16Scale = 1.0f / 32768;
+
+    void copyMonoFloat(const float *src, float *l, uint32_t n) {
+        memcpy(l, src, n * sizeof(float));
+    }
+
+    void deinterleaveFloat(const float *src, float *l, float *r, uint32_t n) {
+        uint32_t i = 0;
+#if defined(__ARM_NEON)
+        for (; i + 4 <= n; i += 4) {
+            float32x4x2_t v = vld2q_f32(src + i * 2);
+            vst1q_f32(l + i, v.val[0]);
+            vst1q_f32(r + i, v.val[1]);
+        }
+#elif defined(__SSE2__)
+        for (; i + 4 <= n; i += 4) {
+            __m128 a = _mm_loadu_ps(src + i * 2);
+            __m128 b = _mm_loadu_ps(src + i * 2 + 4);
+            _mm_storeu_ps(l + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(r + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+#endif
+        for (; i < n; i++) {
+            l[i] = src[i * 2];
+            r[i] = src[i * 2 + 1];
+        }
+    }
+
+    void convertMonoInt16(const int16_t *src, float *l, uint32_t n) {
+        uint32_t i = 0;
+#if defined(__ARM_NEON)
+        float32x4_t scale = vdupq_n_f32(int16Scale);
+        for (; i + 8 <= n; i += 8) {
+            int16x8_t v = vld1q_s16(src + i);
+            vst1q_f32(l + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+            vst1q_f32(l + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+        }
+#elif defined(__SSE2__)
+        __m128 scale = _mm_set1_ps(int16Scale);
+        for (; i + 8 <= n; i += 8) {
+            __m128i v = _mm_loadu_si128((const __m128i *) (src + i));
+            // Duplicate each sample into both halves of a lane, then shift
+            // right arithmetically to sign-extend.
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+            _mm_storeu_ps(l + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(l + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+#endif
+        for (; i < n; i++) {
+            l[i] = src[i] * int16Scale;
+        }
+    }
+
+    void convertStereoInt16(const int16_t *src, float *l, float *r, uint32_t n) {
+        uint32_t i = 0;
+#if defined(__ARM_NEON)
+        float32x4_t scale = vdupq_n_f32(int16Scale);
+        for (; i + 4 <= n; i += 4) {
+            int16x4x2_t v = vld2_s16(src + i * 2);
+            vst1q_f32(l + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(v.val[0])), scale));
+            vst1q_f32(r + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(v.val[1])), scale));
+        }
+#elif defined(__SSE2__)
+        __m128 scale = _mm_set1_ps(int16Scale);
+        for (; i + 4 <= n; i += 4) {
+            __m128i v = _mm_loadu_si128((const __m128i *) (src + i * 2));
+            __m128 a = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+            __m128 b = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+            _mm_storeu_ps(l + i, _mm_mul_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)), scale));
+            _mm_storeu_ps(r + i, _mm_mul_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)), scale));
+        }
+#endif
+        for (; i < n; i++) {
+            l[i] = src[i * 2] * int16Scale;
+            r[i] = src[i * 2 + 1] * int16Scale;
+        }
+    }
+
+    inline float dot8(const float *a, const float *b) {
+#if defined(__ARM_NEON)
+        float32x4_t s = vmulq_f32(vld1q_f32(a), vld1q_f32(b));
+        s = vmlaq_f32(s, vld1q_f32(a + 4), vld1q_f32(b + 4));
+        float32x2_t h = vadd_f32(vget_low_f32(s), vget_high_f32(s));
+        return vget_lane_f32(vpadd_f32(h, h), 0);
+#elif defined(__SSE2__)
+        __m128 s = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a), _mm_loadu_ps(b)),
+                              _mm_mul_ps(_mm_loadu_ps(a + 4), _mm_loadu_ps(b + 4)));
+        s = _mm_add_ps(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(2, 3, 0, 1)));
+        s = _mm_add_ss(s, _mm_movehl_ps(s, s));
+        return _mm_cvtss_f32(s);
+#else
+        float s = 0;
+        for (int i = 0; i < 8; i++) {
+            s += a[i] * b[i];
+        }
+        return s;
+#endif
+    }
+
+    /**
+     * out[2i] += l[i] * gl; out[2i + 1] += r[i] * gr
+     */
+    void accumulate(float *out, const float *l, const float *r, float gl, float gr,
+                    uint32_t n) {
+        uint32_t i = 0;
+#if defined(__ARM_NEON)
+        float32x4_t vgl = vdupq_n_f32(gl);
+        float32x4_t vgr = vdupq_n_f32(gr);
+        for (; i + 4 <= n; i += 4) {
+            float32x4x2_t o = vld2q_f32(out + i * 2);
+            o.val[0] = vmlaq_f32(o.val[0], vld1q_f32(l + i), vgl);
+            o.val[1] = vmlaq_f32(o.val[1], vld1q_f32(r + i), vgr);
+            vst2q_f32(out + i * 2, o);
+        }
+#elif defined(__SSE2__)
+        __m128 vgl = _mm_set1_ps(gl);
+        __m128 vgr = _mm_set1_ps(gr);
+        for (; i + 4 <= n; i += 4) {
+            __m128 a = _mm_mul_ps(_mm_loadu_ps(l + i), vgl);
+            __m128 b = _mm_mul_ps(_mm_loadu_ps(r + i), vgr);
+            float *o = out + i * 2;
+            _mm_storeu_ps(o, _mm_add_ps(_mm_loadu_ps(o), _mm_unpacklo_ps(a, b)));
+            _mm_storeu_ps(o + 4, _mm_add_ps(_mm_loadu_ps(o + 4), _mm_unpackhi_ps(a, b)));
+        }
+#endif
+        for (; i < n; i++) {
+            out[i * 2] += l[i] * gl;
+            out[i * 2 + 1] += r[i] * gr;
+        }
+    }
+}
+
+AudioMixer::AudioMixer(uint32_t outputRate) : outputRate(outputRate) {
+    // Cut off a little below the source Nyquist frequency: 8 taps leave a
+    // wide transition band.
+    const double cutoff = 0.9;
+    const double pi = 3.14159265358979;
+    sincTable.reset(new float[sincPhases * sincTaps]);
+    for (int p = 0; p < sincPhases; p++) {
+        double phase = (double) p / sincPhases;
+        double taps[sincTaps];
+        double sum = 0;
+        for (int k = 0; k < sincTaps; k++) {
+            double x = k - tapsBefore - phase;
+            double s = x == 0 ? 1 : std::sin(pi * cutoff * x) / (pi * cutoff * x);
+            double w = 0.42 + 0.5 * std::cos(pi * x / tapsAfter) +
+                       0.08 * std::cos(2 * pi * x / tapsAfter);
+            taps[k] = s * w;
+            sum += taps[k];
+        }
+        // Unity gain at DC for every phase.
+        for (int k = 0; k < sincTaps; k++) {
+            sincTable[p * sincTaps + k] = (float) (taps[k] / sum);
+        }
+    }
+    const size_t srcFrames = blockFrames * maxStep + sincTaps + 1;
+    scratch.reset(new float[srcFrames * 2 + blockFrames * 2]());
+    srcL = scratch.get();
+    srcR = srcL + srcFrames;
+    dstL = srcR + srcFrames;
+    dstR = dstL + blockFrames;
+}
+
+void AudioMixer::start(Voice &voice, const AudioClip *clip, bool loop,
+                       Resampler resampler) const {
+    voice.clip = clip;
+    voice.position = 0;
+    voice.loop = loop;
+    voice.resampler = resampler;
+    retune(voice);
+}
+
+void AudioMixer::retune(Voice &voice) const {
+    voice.step = std::clamp(((uint64_t) voice.clip->sampleRate << 32) / outputRate,
+                            (uint64_t) 1, maxStep * one);
+    voice.stepRate = outputRate;
+}
+
+void AudioMixer::setGainPan(Voice &voice, float gain, float pan) {
+    float angle = (std::fmin(std::fmax(pan, -1.0f), 1.0f) + 1) * 0.785398163f;
+    voice.gainL = gain * std::cos(angle);
+    voice.gainR = gain * std::sin(angle);
+}
+
+void AudioMixer::decode(const Voice &voice, int64_t first, uint32_t count) {
+    const AudioClip &clip = *voice.clip;
+    const int64_t frames = clip.frames;
+    const bool stereo = clip.channels == 2;
+    uint32_t i = 0;
+    while (i < count) {
+        int64_t s = first + i;
+        if (voice.loop) {
+            s = ((s % frames) + frames) % frames;
+        }
+        uint32_t n;
+        if (s < 0 || s >= frames) {
+            // Silence before the start and after the end.
+            n = s < 0 ? (uint32_t) std::min<int64_t>(count - i, -s) : count - i;
+            std::fill(srcL + i, srcL + i + n, 0.0f);
+            std::fill(srcR + i, srcR + i + n, 0.0f);
+        } else {
+            n = (uint32_t) std::min<int64_t>(count - i, frames - s);
+            if (clip.format == SampleFormat::Float) {
+                auto *src = static_cast<const float *>(clip.samples) + s * clip.channels;
+                if (stereo) {
+                    deinterleaveFloat(src, srcL + i, srcR + i, n);
+                } else {
+                    copyMonoFloat(src, srcL + i, n);
+                }
+            } else {
+                auto *src = static_cast<const int16_t *>(clip.samples) + s * clip.channels;
+                if (stereo) {
+                    convertStereoInt16(src, srcL + i, srcR + i, n);
+                } else {
+                    convertMonoInt16(src, srcL + i, n);
+                }
+            }
+        }
+        i += n;
+    }
+}
+
+void AudioMixer::resample(const Voice &voice, const float *src, float *dst,
+                          uint32_t frames) const {
+    // src[0] is source frame (position >> 32) - tapsBefore.
+    uint64_t p = (voice.position & fracMask) + (uint64_t) tapsBefore * one;
+    if (voice.resampler == Resampler::Linear) {
+        for (uint32_t i = 0; i < frames; i++, p += voice.step) {
+            const float *s = src + (p >> 32);
+            float frac = (float) (p & fracMask) * (1.0f / 4294967296.0f);
+            dst[i] = s[0] + (s[1] - s[0]) * frac;
+        }
+        return;
+    }
+    const float *table = sincTable.get();
+    for (uint32_t i = 0; i < frames; i++, p += voice.step) {
+        uint32_t phase = (uint32_t) ((p & fracMask) >> (32 - 7));
+        dst[i] = dot8(src + (p >> 32) - tapsBefore, table + phase * sincTaps);
+    }
+}
+
+void AudioMixer::mixBlock(Voice &voice, float *out, uint32_t frames) {
+    const bool stereo = voice.clip->channels == 2;
+    const int64_t first = (int64_t) (voice.position >> 32) - tapsBefore;
+    if (voice.step == one && !(voice.position & fracMask)) {
+        // Already at the output rate: decode and mix.
+        decode(voice, first + tapsBefore, frames);
+        accumulate(out, srcL, stereo ? srcR : srcL, voice.gainL, voice.gainR, frames);
+    } else {
+        uint64_t last = (voice.position + (frames - 1) * voice.step) >> 32;
+        auto count = (uint32_t) ((int64_t) last + tapsAfter + 1 - first);
+        decode(voice, first, count);
+        resample(voice, srcL, dstL, frames);
+        if (stereo) {
+            resample(voice, srcR, dstR, frames);
+        }
+        accumulate(out, dstL, stereo ? dstR : dstL, voice.gainL, voice.gainR, frames);
+    }
+    voice.position += frames * voice.step;
+}
+
+bool AudioMixer::mix(Voice &voice, float *out, uint32_t frames) {
+    if (voice.stepRate != outputRate) {
+        retune(voice);
+    }
+    const uint64_t end = (uint64_t) voice.clip->frames << 32;
+    while (frames) {
+        uint32_t n = std::min(frames, blockFrames);
+        if (!voice.loop) {
+            if (voice.position >= end) {
+                return false;
+            }
+            uint64_t left = (end - voice.position + voice.step - 1) / voice.step;
+            n = (uint32_t) std::min<uint64_t>(n, left);
+        }
+        mixBlock(voice, out, n);
+        out += n * 2;
+        frames -= n;
+        if (voice.position >= end) {
+            if (!voice.loop) {
+                return false;
+            }
+            voice.position %= end;
+        }
+    }
+    return true;
+}
+
+void AudioMixer::mixStereo(float *out, const float *src, uint32_t frames, float gainL,
+                           float gainR) {
+    uint32_t i = 0;
+    const uint32_t n = frames * 2;
+#if defined(__ARM_NEON)
+    const float g[4] = {gainL, gainR, gainL, gainR};
+    float32x4_t vg = vld1q_f32(g);
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(out + i, vmlaq_f32(vld1q_f32(out + i), vld1q_f32(src + i), vg));
+    }
+#elif defined(__SSE2__)
+    __m128 vg = _mm_setr_ps(gainL, gainR, gainL, gainR);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i),
+                                          _mm_mul_ps(_mm_loadu_ps(src + i), vg)));
+    }
+#endif
+    for (; i < n; i += 2) {
+        out[i] += src[i] * gainL;
+        out[i + 1] += src[i + 1] * gainR;
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+enum class SampleFormat : uint8_t {
+    Float, Int16
+};
+
+/**
+ * PCM data for a voice: interleaved mono or stereo, float or int16, at any
+ * sample rate. The samples are not copied and must outlive every voice
+ * playing them.
+ */
+struct AudioClip {
+    const void *samples;
+    uint32_t frames;
+    uint16_t channels;
+    SampleFormat format;
+    uint32_t sampleRate;
+};
+
+enum class Resampler : uint8_t {
+    // Two-point interpolation; cheapest, some aliasing.
+    Linear,
+    // 8-tap Blackman-windowed sinc from a 128-phase table.
+    Sinc
+};
+
+/**
+ * Resamples voices to the output rate and accumulates them, with gain and
+ * pan, into an interleaved stereo buffer.
+ * Each block is processed in three passes over small planar scratch
+ * buffers: decode the source span to float (deinterleaving and converting
+ * int16), resample, then pan and accumulate. Decode, the sinc dot products
+ * and accumulation use NEON or SSE2; voices at the output rate skip the
+ * resampling pass. Owned by the audio callback thread; nothing here locks
+ * or allocates after construction.
+ */
+class AudioMixer {
+public:
+    static const uint32_t blockFrames = 256;
+    // Highest supported source/output rate ratio, e.g. 192 kHz into 48 kHz.
+    static const uint32_t maxStep = 4;
+    static const int sincTaps = 8;
+    static const int sincPhases = 128;
+
+    struct Voice {
+        const AudioClip *clip;
+        // Source position in 32.32 fixed-point frames.
+        uint64_t position;
+        uint64_t step;
+        // Output rate step was computed for.
+        uint32_t stepRate;
+        float gainL, gainR;
+        bool loop;
+        Resampler resampler;
+    };
+
+private:
+    uint32_t outputRate;
+    std::unique_ptr<float[]> sincTable;
+    std::unique_ptr<float[]> scratch;
+    float *srcL, *srcR;
+    float *dstL, *dstR;
+
+    void decode(const Voice &voice, int64_t first, uint32_t count);
+
+    void resample(const Voice &voice, const float *src, float *dst, uint32_t frames) const;
+
+    void mixBlock(Voice &voice, float *out, uint32_t frames);
+
+    void retune(Voice &voice) const;
+
+public:
+    explicit AudioMixer(uint32_t outputRate = 48000);
+
+    /**
+     * Change the output rate; voices already playing are retuned on their
+     * next mix(), keeping their position in the clip.
+     */
+    void setOutputRate(uint32_t rate) { outputRate = rate; }
+
+    inline uint32_t getOutputRate() const { return outputRate; }
+
+    /**
+     * Reset a voice to the start of clip.
+     */
+    void start(Voice &voice, const AudioClip *clip, bool loop, Resampler resampler) const;
+
+    /**
+     * @param pan -1 (left) to 1 (right), constant power
+     */
+    static void setGainPan(Voice &voice, float gain, float pan);
+
+    /**
+     * out[2i] += src[2i] * gainL; out[2i + 1] += src[2i + 1] * gainR
+     * for already resampled interleaved stereo, e.g. a streamed voice.
+     */
+    static void mixStereo(float *out, const float *src, uint32_t frames, float gainL,
+                          float gainR);
+
+    /**
+     * Add frames of the voice into interleaved stereo out and advance it.
+     * @return false once a non-looping voice has played to its end
+     */
+    bool mix(Voice &voice, float *out, uint32_t frames);
+};
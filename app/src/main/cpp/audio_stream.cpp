@@ -0,0 +1,621 @@
+#include "audio_stream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <strings.h>
+
+#if defined(__ANDROID__)
+#include <android/asset_manager.h>
+#include <media/NdkMediaCodec.h>
+#include <media/NdkMediaExtractor.h>
+#include <unistd.h>
+#endif
+
+#include "logging.h"
+
+namespace {
+    // Source frames decoded per step of pump().
+    const uint32_t chunkFrames = 1024;
+}
+
+struct AudioStream::Decoder {
+    uint32_t sampleRate = 0;
+    uint32_t channels = 0;
+
+    virtual ~Decoder() = default;
+
+    /**
+     * Decode up to maxFrames as interleaved stereo float at sampleRate.
+     * @return frames decoded; 0 either at the end or when no data is ready yet
+     */
+    virtual uint32_t decode(float *out, uint32_t maxFrames) = 0;
+
+    virtual bool atEnd() const = 0;
+
+    virtual bool rewind() = 0;
+
+    virtual size_t memoryBytes() const = 0;
+};
+
+namespace {
+    /**
+     * 16-bit or float PCM WAV, mono or stereo.
+     */
+    class WavDecoder : public AudioStream::Decoder {
+    private:
+#if defined(__ANDROID__)
+        AAsset *asset;
+
+        size_t readBytes(void *dst, size_t n) {
+            int r = AAsset_read(asset, dst, n);
+            return r > 0 ? (size_t) r : 0;
+        }
+
+        bool seekTo(int64_t offset) { return AAsset_seek(asset, (off_t) offset, SEEK_SET) >= 0; }
+#else
+        FILE *file;
+
+        size_t readBytes(void *dst, size_t n) { return fread(dst, 1, n, file); }
+
+        bool seekTo(int64_t offset) { return fseek(file, (long) offset, SEEK_SET) == 0; }
+#endif
+        bool isFloat = false;
+        uint32_t frameBytes = 0;
+        int64_t dataOffset = 0;
+        uint32_t framesLeft = 0;
+        uint32_t totalFrames = 0;
+        std::vector<uint8_t> raw;
+
+        static uint32_t le32(const uint8_t *p) {
+            return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+        }
+
+        static uint16_t le16(const uint8_t *p) { return (uint16_t) (p[0] | (p[1] << 8)); }
+
+    public:
+#if defined(__ANDROID__)
+        explicit WavDecoder(AAsset *asset) : asset(asset) {}
+
+        ~WavDecoder() override { AAsset_close(asset); }
+#else
+
+        explicit WavDecoder(FILE *file) : file(file) {}
+
+        ~WavDecoder() override { fclose(file); }
+
+#endif
+
+        bool parse() {
+            uint8_t header[12];
+            if (readBytes(header, 12) != 12 || memcmp(header, "RIFF", 4) ||
+                memcmp(header + 8, "WAVE", 4)) {
+                return false;
+            }
+            int64_t offset = 12;
+            uint16_t format = 0, bits = 0;
+            uint32_t dataBytes = 0;
+            for (;;) {
+                uint8_t chunk[8];
+                if (readBytes(chunk, 8) != 8) {
+                    return false;
+                }
+                uint32_t size = le32(chunk + 4);
+                offset += 8;
+                if (!memcmp(chunk, "fmt ", 4)) {
+                    uint8_t fmt[40] = {};
+                    if (size < 16 || readBytes(fmt, std::min<uint32_t>(size, 40)) < 16) {
+                        return false;
+                    }
+                    format = le16(fmt);
+                    channels = le16(fmt + 2);
+                    sampleRate = le32(fmt + 4);
+                    bits = le16(fmt + 14);
+                    if (format == 0xfffe && size >= 26) {
+                        // WAVE_FORMAT_EXTENSIBLE: the real format leads the sub-format GUID.
+                        format = le16(fmt + 24);
+                    }
+                } else if (!memcmp(chunk, "data", 4)) {
+                    dataOffset = offset;
+                    dataBytes = size;
+                    break;
+                }
+                offset += size + (size & 1);
+                if (!seekTo(offset)) {
+                    return false;
+                }
+            }
+            isFloat = format == 3 && bits == 32;
+            if (!(isFloat || (format == 1 && bits == 16)) || channels < 1 || channels > 2 ||
+                !sampleRate) {
+                return false;
+            }
+            frameBytes = channels * bits / 8;
+            totalFrames = framesLeft = dataBytes / frameBytes;
+            raw.resize((size_t) chunkFrames * frameBytes);
+            return true;
+        }
+
+        uint32_t decode(float *out, uint32_t maxFrames) override {
+            uint32_t n = std::min({maxFrames, framesLeft, chunkFrames});
+            n = (uint32_t) (readBytes(raw.data(), (size_t) n * frameBytes) / frameBytes);
+            framesLeft = n ? framesLeft - n : 0;
+            for (uint32_t i = 0; i < n; i++) {
+                for (uint32_t c = 0; c < 2; c++) {
+                    const uint8_t *p = raw.data() + i * frameBytes +
+                                       (channels == 2 ? c : 0) * (frameBytes / channels);
+                    if (isFloat) {
+                        memcpy(&out[i * 2 + c], p, 4);
+                    } else {
+                        out[i * 2 + c] = (int16_t) le16(p) * (1.0f / 32768);
+                    }
+                }
+            }
+            return n;
+        }
+
+        bool atEnd() const override { return !framesLeft; }
+
+        bool rewind() override {
+            framesLeft = totalFrames;
+            return seekTo(dataOffset);
+        }
+
+        size_t memoryBytes() const override { return raw.capacity(); }
+    };
+
+#if defined(__ANDROID__)
+
+    /**
+     * Compressed audio through AMediaExtractor and AMediaCodec.
+     */
+    class MediaDecoder : public AudioStream::Decoder {
+    private:
+        // Values of the "pcm-encoding" format key (AudioFormat.ENCODING_PCM_*).
+        static const int32_t pcm16Bit = 2;
+        static const int32_t pcm8Bit = 3;
+        static const int32_t pcmFloat = 4;
+
+        int fd;
+        AMediaExtractor *extractor = nullptr;
+        AMediaCodec *codec = nullptr;
+        bool inputDone = false;
+        bool outputDone = false;
+        int32_t encoding = pcm16Bit;
+        uint32_t sampleBytes = 2;
+        // Output buffer being consumed, if any.
+        ssize_t outIndex = -1;
+        AMediaCodecBufferInfo outInfo{};
+        int32_t outOffset = 0;
+        // Largest buffer index and size seen on each side; the codec's pools
+        // are at least that big. Read from the audio engine's thread.
+        size_t inputSlots = 0, inputCapacity = 0;
+        size_t outputSlots = 0, outputCapacity = 0;
+        std::atomic<size_t> bufferBytes{0};
+
+        /**
+         * @return false for a layout or sample encoding this cannot convert
+         */
+        bool readFormat(AMediaFormat *format) {
+            int32_t rate = 0, count = 0;
+            AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_SAMPLE_RATE, &rate);
+            AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_CHANNEL_COUNT, &count);
+            sampleRate = (uint32_t) rate;
+            channels = (uint32_t) count;
+            // AMEDIAFORMAT_KEY_PCM_ENCODING is API 28; a missing key means 16-bit.
+            encoding = pcm16Bit;
+            AMediaFormat_getInt32(format, "pcm-encoding", &encoding);
+            switch (encoding) {
+                case pcm16Bit:
+                    sampleBytes = 2;
+                    break;
+                case pcm8Bit:
+                    sampleBytes = 1;
+                    break;
+                case pcmFloat:
+                    sampleBytes = 4;
+                    break;
+                default:
+                    LOGW("audio stream: unsupported PCM encoding %d", encoding);
+                    return false;
+            }
+            return sampleRate && channels >= 1 && channels <= 2;
+        }
+
+        float sample(const uint8_t *p) const {
+            if (encoding == pcmFloat) {
+                float v;
+                memcpy(&v, p, 4);
+                return v;
+            }
+            if (encoding == pcm8Bit) {
+                // 8-bit PCM is unsigned around 128.
+                return ((int) *p - 128) * (1.0f / 128);
+            }
+            int16_t v;
+            memcpy(&v, p, 2);
+            return v * (1.0f / 32768);
+        }
+
+        void noteBuffer(size_t &slots, size_t &size, size_t index, size_t capacity) {
+            if (index < slots && capacity <= size) {
+                return;
+            }
+            slots = std::max(slots, index + 1);
+            size = std::max(size, capacity);
+            bufferBytes.store(inputSlots * inputCapacity + outputSlots * outputCapacity,
+                              std::memory_order_relaxed);
+        }
+
+        void feedInput() {
+            if (inputDone) {
+                return;
+            }
+            ssize_t index = AMediaCodec_dequeueInputBuffer(codec, 0);
+            if (index < 0) {
+                return;
+            }
+            size_t capacity;
+            uint8_t *buffer = AMediaCodec_getInputBuffer(codec, (size_t) index, &capacity);
+            noteBuffer(inputSlots, inputCapacity, (size_t) index, capacity);
+            ssize_t size = AMediaExtractor_readSampleData(extractor, buffer, capacity);
+            if (size < 0) {
+                AMediaCodec_queueInputBuffer(codec, (size_t) index, 0, 0, 0,
+                                             AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM);
+                inputDone = true;
+                return;
+            }
+            AMediaCodec_queueInputBuffer(codec, (size_t) index, 0, (size_t) size,
+                                         (uint64_t) AMediaExtractor_getSampleTime(extractor), 0);
+            AMediaExtractor_advance(extractor);
+        }
+
+        void releaseOutput() {
+            AMediaCodec_releaseOutputBuffer(codec, (size_t) outIndex, false);
+            if (outInfo.flags & AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM) {
+                outputDone = true;
+            }
+            outIndex = -1;
+        }
+
+    public:
+        explicit MediaDecoder(int fd) : fd(fd) {}
+
+        ~MediaDecoder() override {
+            if (codec) {
+                if (outIndex >= 0) {
+                    AMediaCodec_releaseOutputBuffer(codec, (size_t) outIndex, false);
+                }
+                AMediaCodec_stop(codec);
+                AMediaCodec_delete(codec);
+            }
+            if (extractor) {
+                AMediaExtractor_delete(extractor);
+            }
+            ::close(fd);
+        }
+
+        bool open(off64_t start, off64_t length) {
+            extractor = AMediaExtractor_new();
+            if (AMediaExtractor_setDataSourceFd(extractor, fd, start, length) != AMEDIA_OK) {
+                return false;
+            }
+            for (size_t i = 0; i < AMediaExtractor_getTrackCount(extractor); i++) {
+                AMediaFormat *format = AMediaExtractor_getTrackFormat(extractor, i);
+                const char *mime = nullptr;
+                if (AMediaFormat_getString(format, AMEDIAFORMAT_KEY_MIME, &mime) &&
+                    !strncmp(mime, "audio/", 6)) {
+                    AMediaExtractor_selectTrack(extractor, i);
+                    // The decoder reports its real output format before the first buffer.
+                    bool ok = readFormat(format);
+                    codec = AMediaCodec_createDecoderByType(mime);
+                    ok = ok && codec &&
+                         AMediaCodec_configure(codec, format, nullptr, nullptr, 0) ==
+                         AMEDIA_OK && AMediaCodec_start(codec) == AMEDIA_OK;
+                    AMediaFormat_delete(format);
+                    return ok;
+                }
+                AMediaFormat_delete(format);
+            }
+            return false;
+        }
+
+        uint32_t decode(float *out, uint32_t maxFrames) override {
+            uint32_t produced = 0;
+            // Bounded, so a stalled codec hands control back to pump().
+            for (int attempts = 0; produced < maxFrames && attempts < 8; attempts++) {
+                if (outIndex >= 0) {
+                    size_t capacity;
+                    const uint8_t *data =
+                            AMediaCodec_getOutputBuffer(codec, (size_t) outIndex, &capacity) +
+                            outInfo.offset + outOffset;
+                    noteBuffer(outputSlots, outputCapacity, (size_t) outIndex, capacity);
+                    uint32_t frameBytes = channels * sampleBytes;
+                    uint32_t n = std::min(maxFrames - produced,
+                                          (uint32_t) (outInfo.size - outOffset) / frameBytes);
+                    for (uint32_t i = 0; i < n; i++) {
+                        const uint8_t *frame = data + i * frameBytes;
+                        out[(produced + i) * 2] = sample(frame);
+                        out[(produced + i) * 2 + 1] =
+                                sample(frame + (channels - 1) * sampleBytes);
+                    }
+                    produced += n;
+                    outOffset += (int32_t) (n * frameBytes);
+                    if (outOffset + (int32_t) frameBytes > outInfo.size) {
+                        releaseOutput();
+                    }
+                    attempts = 0;
+                    continue;
+                }
+                if (outputDone) {
+                    break;
+                }
+                feedInput();
+                AMediaCodecBufferInfo info;
+                ssize_t index = AMediaCodec_dequeueOutputBuffer(codec, &info, 2000);
+                if (index >= 0) {
+                    outIndex = index;
+                    outInfo = info;
+                    outOffset = 0;
+                    if (info.size <= 0) {
+                        releaseOutput();
+                    }
+                } else if (index == AMEDIACODEC_INFO_OUTPUT_FORMAT_CHANGED) {
+                    AMediaFormat *format = AMediaCodec_getOutputFormat(codec);
+                    if (!readFormat(format)) {
+                        // Nothing sensible to convert; end the stream.
+                        outputDone = true;
+                    }
+                    AMediaFormat_delete(format);
+                }
+            }
+            return produced;
+        }
+
+        bool atEnd() const override { return outputDone; }
+
+        bool rewind() override {
+            if (outIndex >= 0) {
+                AMediaCodec_releaseOutputBuffer(codec, (size_t) outIndex, false);
+                outIndex = -1;
+            }
+            AMediaExtractor_seekTo(extractor, 0, AMEDIAEXTRACTOR_SEEK_CLOSEST_SYNC);
+            AMediaCodec_flush(codec);
+            inputDone = outputDone = false;
+            return true;
+        }
+
+        size_t memoryBytes() const override {
+            return bufferBytes.load(std::memory_order_relaxed);
+        }
+    };
+
+    bool hasSuffix(const char *s, const char *suffix) {
+        size_t n = strlen(s), m = strlen(suffix);
+        return n >= m && !strcasecmp(s + n - m, suffix);
+    }
+
+#endif
+}
+
+AudioStream::AudioStream(uint32_t outputRate, float bufferSeconds)
+        : ring((size_t) (outputRate * bufferSeconds) * 2), outputRate(outputRate),
+          requestedRate(outputRate) {
+    decoded.resize(chunkFrames * 2);
+}
+
+AudioStream::~AudioStream() = default;
+
+bool AudioStream::open(AAssetManager *assets, const char *path, bool loop) {
+    close();
+    this->loop = loop;
+#if defined(__ANDROID__)
+    AAsset *asset = assets ? AAssetManager_open(assets, path, AASSET_MODE_RANDOM) : nullptr;
+    if (!asset) {
+        LOGW("audio stream: cannot open %s", path);
+        return false;
+    }
+    if (hasSuffix(path, ".wav")) {
+        auto wav = std::make_unique<WavDecoder>(asset);
+        if (wav->parse()) {
+            decoder = std::move(wav);
+        }
+    } else {
+        off64_t start, length;
+        int fd = AAsset_openFileDescriptor64(asset, &start, &length);
+        AAsset_close(asset);
+        if (fd < 0) {
+            LOGW("audio stream: %s is compressed in the APK and cannot be streamed", path);
+            return false;
+        }
+        auto media = std::make_unique<MediaDecoder>(fd);
+        if (media->open(start, length)) {
+            decoder = std::move(media);
+        }
+    }
+#else
+    (void) assets;
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        LOGW("audio stream: cannot open %s", path);
+        return false;
+    }
+    auto wav = std::make_unique<WavDecoder>(file);
+    if (wav->parse()) {
+        decoder = std::move(wav);
+    }
+#endif
+    if (!decoder) {
+        LOGW("audio stream: unsupported format in %s", path);
+        return false;
+    }
+    previous[0] = previous[1] = 0;
+    phase = 1;
+    ended.store(false, std::memory_order_relaxed);
+    primed.store(false, std::memory_order_relaxed);
+    underruns.store(0, std::memory_order_relaxed);
+    LOGI("audio stream: %s, %u Hz, %u ch, %zu KiB buffered", path, decoder->sampleRate,
+         decoder->channels, ring.capacity() * sizeof(float) / 1024);
+    return true;
+}
+
+void AudioStream::setOutputRate(uint32_t rate) {
+    requestedRate.store(rate, std::memory_order_relaxed);
+}
+
+void AudioStream::close() {
+    decoder.reset();
+    ring.clear();
+    ended.store(true, std::memory_order_release);
+}
+
+bool AudioStream::pump() {
+    if (!decoder) {
+        return false;
+    }
+    // The resampler's phase is in source frames, so it carries across a change.
+    outputRate = requestedRate.load(std::memory_order_relaxed);
+    bool progress = false;
+    while (!ended.load(std::memory_order_relaxed)) {
+        const uint32_t sourceRate = decoder->sampleRate;
+        // Leave room for what the resampler may emit from one chunk.
+        size_t space = ring.writable() / 2;
+        if (space < 64) {
+            break;
+        }
+        auto chunk = (uint32_t) std::min<uint64_t>(chunkFrames,
+                                                   (uint64_t) (space - 2) * sourceRate /
+                                                   outputRate);
+        uint32_t n = chunk ? decoder->decode(decoded.data(), chunk) : 0;
+        if (!n) {
+            if (!decoder->atEnd()) {
+                break;
+            }
+            if (loop && decoder->rewind()) {
+                continue;
+            }
+            ended.store(true, std::memory_order_release);
+            break;
+        }
+        progress = true;
+        if (sourceRate == outputRate) {
+            ring.write(decoded.data(), n * 2);
+            continue;
+        }
+        // Linear interpolation over previous, decoded[0], ..., decoded[n - 1].
+        const double step = (double) sourceRate / outputRate;
+        size_t maxOut = (size_t) (n / step) + 2;
+        if (resampled.size() < maxOut * 2) {
+            resampled.resize(maxOut * 2);
+        }
+        size_t produced = 0;
+        for (; phase < n; phase += step, produced++) {
+            auto i = (uint32_t) phase;
+            auto f = (float) (phase - i);
+            const float *a = i ? &decoded[(i - 1) * 2] : previous;
+            const float *b = &decoded[i * 2];
+            resampled[produced * 2] = a[0] + (b[0] - a[0]) * f;
+            resampled[produced * 2 + 1] = a[1] + (b[1] - a[1]) * f;
+        }
+        phase -= n;
+        previous[0] = decoded[(n - 1) * 2];
+        previous[1] = decoded[(n - 1) * 2 + 1];
+        ring.write(resampled.data(), produced * 2);
+    }
+    primed.store(true, std::memory_order_release);
+    return progress;
+}
+
+uint32_t AudioStream::read(float *out, uint32_t frames) {
+    auto got = (uint32_t) (ring.read(out, (size_t) frames * 2) / 2);
+    if (got < frames && primed.load(std::memory_order_acquire) &&
+        !ended.load(std::memory_order_acquire)) {
+        underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    return got;
+}
+
+AudioStream::Stats AudioStream::getStats() const {
+    Stats s{};
+    s.underruns = underruns.load(std::memory_order_relaxed);
+    s.bufferedFrames = (uint32_t) (ring.readable() / 2);
+    s.memoryBytes = ring.capacity() * sizeof(float) +
+                    (decoded.capacity() + resampled.capacity()) * sizeof(float) +
+                    (decoder ? decoder->memoryBytes() : 0);
+    s.finished = finished();
+    return s;
+}
+
+void AudioStreamer::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running) {
+        return;
+    }
+    running = true;
+    thread = std::thread(&AudioStreamer::threadMain, this);
+}
+
+void AudioStreamer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) {
+            return;
+        }
+        running = false;
+    }
+    wake.notify_all();
+    thread.join();
+}
+
+void AudioStreamer::add(AudioStream *stream) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        streams.push_back(stream);
+        // Room for the I/O thread's copy, so its passes never allocate.
+        batch.reserve(streams.capacity());
+        added = true;
+    }
+    wake.notify_all();
+}
+
+void AudioStreamer::remove(AudioStream *stream) {
+    std::unique_lock<std::mutex> lock(mutex);
+    streams.erase(std::remove(streams.begin(), streams.end(), stream), streams.end());
+    idle.wait(lock, [&]() { return pumping != stream; });
+}
+
+void AudioStreamer::threadMain() {
+    if (onThreadStart) {
+        onThreadStart();
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running) {
+        added = false;
+        batch.assign(streams.begin(), streams.end());
+        for (auto *stream : batch) {
+            // Skip streams removed while the lock was dropped.
+            if (!running ||
+                std::find(streams.begin(), streams.end(), stream) == streams.end()) {
+                continue;
+            }
+            pumping = stream;
+            lock.unlock();
+            stream->pump();
+            lock.lock();
+            pumping = nullptr;
+            idle.notify_all();
+        }
+        auto woken = [this]() { return !running || added; };
+        if (streams.empty()) {
+            wake.wait(lock, woken);
+        } else {
+            // Far shorter than any ring, and cheap when there is nothing to do.
+            wake.wait_for(lock, std::chrono::milliseconds(20), woken);
+        }
+    }
+    lock.unlock();
+    if (onThreadExit) {
+        onThreadExit();
+    }
+}
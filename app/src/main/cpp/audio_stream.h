@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "spsc_ring.h"
+
+struct AAssetManager;
+
+/**
+ * A long sound (music, ambience) decoded incrementally instead of loaded
+ * whole. An I/O thread calls pump() to decode and resample to the output
+ * rate into a lock-free ring; the audio callback only calls read().
+ * On Android the source is an asset: WAV is parsed directly and anything
+ * else (Ogg Vorbis, Opus, MP3, AAC) goes through the platform decoder,
+ * which needs the asset stored uncompressed in the APK (the default for
+ * those extensions). Elsewhere the source is a plain WAV file.
+ */
+class AudioStream {
+public:
+    struct Decoder;
+
+    struct Stats {
+        // Callbacks that wanted more audio than was buffered.
+        uint32_t underruns;
+        uint32_t bufferedFrames;
+        // Ring plus decode buffers, and the platform decoder's buffers seen so far.
+        size_t memoryBytes;
+        bool finished;
+    };
+
+private:
+    std::unique_ptr<Decoder> decoder;
+    SpscRing<float> ring;
+    // I/O side; takes requestedRate at the start of each pump().
+    uint32_t outputRate;
+    std::atomic<uint32_t> requestedRate;
+    bool loop = false;
+
+    // I/O side: one decoded chunk, resampled with state carried across chunks.
+    std::vector<float> decoded;
+    std::vector<float> resampled;
+    float previous[2] = {};
+    double phase = 1;
+
+    std::atomic<bool> ended{true};
+    // Set by the first pump(); reads before it are not underruns.
+    std::atomic<bool> primed{false};
+    std::atomic<uint32_t> underruns{0};
+
+public:
+    /**
+     * @param bufferSeconds ring length; the I/O thread must refill within it
+     */
+    explicit AudioStream(uint32_t outputRate, float bufferSeconds = 0.5f);
+
+    ~AudioStream();
+
+    /**
+     * Open a source and reset the buffer. Call before handing the stream to
+     * an AudioStreamer or AudioEngine, or after removing it from both.
+     * @param assets asset manager, or nullptr to read path from the file system
+     */
+    bool open(AAssetManager *assets, const char *path, bool loop);
+
+    void close();
+
+    inline bool isOpen() const { return decoder != nullptr; }
+
+    /**
+     * Resample to a new output rate, e.g. after the device was reopened at
+     * another one. Taken by the next pump(); audio already buffered plays out
+     * at the old rate. The ring keeps its size.
+     */
+    void setOutputRate(uint32_t rate);
+
+    /**
+     * I/O side: decode until the ring is full or the source ends.
+     * @return true if anything was decoded
+     */
+    bool pump();
+
+    /**
+     * Real-time side: copy up to frames of interleaved stereo out.
+     * @return frames copied; a short read after the first fill and before the
+     *         end counts an underrun
+     */
+    uint32_t read(float *out, uint32_t frames);
+
+    /**
+     * @return true once the source has ended and every frame has been read
+     */
+    inline bool finished() const {
+        return ended.load(std::memory_order_acquire) && !ring.readable();
+    }
+
+    Stats getStats() const;
+};
+
+/**
+ * I/O thread keeping a set of AudioStreams topped up.
+ * Streams are polled a few times per ring length, which keeps the audio
+ * callback free of any signalling. Decoding happens outside the lock, so
+ * add() and remove() never wait for a whole pump of every stream.
+ */
+class AudioStreamer {
+private:
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    // Signalled whenever the I/O thread finishes pumping a stream.
+    std::condition_variable idle;
+    std::vector<AudioStream *> streams;
+    // I/O thread's copy of streams for one pass.
+    std::vector<AudioStream *> batch;
+    // Stream being pumped outside the lock, if any.
+    AudioStream *pumping = nullptr;
+    bool added = false;
+    bool running = false;
+
+    void threadMain();
+
+public:
+    // Run on the I/O thread as it starts and right before it exits.
+    std::function<void()> onThreadStart;
+    std::function<void()> onThreadExit;
+
+    ~AudioStreamer() { stop(); }
+
+    void start();
+
+    void stop();
+
+    /**
+     * Start refilling a stream. The I/O thread makes the first fill right
+     * away; a voice playing the stream meanwhile reads silence, which is not
+     * counted as an underrun.
+     */
+    void add(AudioStream *stream);
+
+    /**
+     * Stop refilling a stream; once this returns the I/O thread no longer
+     * touches it. Waits for a pump of that stream already under way.
+     */
+    void remove(AudioStream *stream);
+};
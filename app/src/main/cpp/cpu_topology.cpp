@@ -0,0 +1,89 @@
+#include "cpu_topology.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <sched.h>
+#include <unistd.h>
+
+namespace {
+    bool readUint(const char *format, int cpu, uint32_t *value) {
+        char path[128];
+        snprintf(path, sizeof(path), format, cpu);
+        FILE *fp = fopen(path, "r");
+        if (!fp) {
+            return false;
+        }
+        unsigned long v;
+        bool ok = fscanf(fp, "%lu", &v) == 1;
+        fclose(fp);
+        if (ok) {
+            *value = (uint32_t) v;
+        }
+        return ok;
+    }
+}
+
+void CpuTopology::load() {
+    cores.clear();
+    maxCapacity = 0;
+    long count = sysconf(_SC_NPROCESSORS_CONF);
+    for (int cpu = 0; cpu < count; cpu++) {
+        uint32_t online = 1;
+        // cpu0 has no online file on most kernels; treat missing as online.
+        readUint("/sys/devices/system/cpu/cpu%d/online", cpu, &online);
+        if (!online) {
+            continue;
+        }
+        uint32_t capacity = 0;
+        if (!readUint("/sys/devices/system/cpu/cpu%d/cpu_capacity", cpu, &capacity)) {
+            readUint("/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", cpu, &capacity);
+        }
+        cores.push_back(Core{cpu, capacity});
+        maxCapacity = std::max(maxCapacity, capacity);
+    }
+    std::stable_sort(cores.begin(), cores.end(), [](const Core &a, const Core &b) {
+        return a.capacity > b.capacity;
+    });
+}
+
+std::vector<int> CpuTopology::clusterOf(const Core &core) const {
+    std::vector<int> ids;
+    for (auto &c: cores) {
+        if (c.capacity == core.capacity) {
+            ids.push_back(c.id);
+        }
+    }
+    return ids;
+}
+
+std::vector<int> CpuTopology::bigCores() const {
+    std::vector<int> ids;
+    for (auto &c: cores) {
+        if (isBig(c)) {
+            ids.push_back(c.id);
+        }
+    }
+    return ids;
+}
+
+std::vector<int> CpuTopology::littleCores() const {
+    std::vector<int> ids;
+    for (auto &c: cores) {
+        if (!isBig(c)) {
+            ids.push_back(c.id);
+        }
+    }
+    return ids;
+}
+
+bool CpuTopology::pinCurrentThread(const std::vector<int> &cpus) {
+    if (cpus.empty()) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto cpu: cpus) {
+        CPU_SET(cpu, &set);
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Core layout read from sysfs, used to place threads on big.LITTLE parts.
+ * Capacity comes from cpu_capacity (the scheduler's 0-1024 scale), falling
+ * back to cpuinfo_max_freq; if neither exists every core is treated as big.
+ */
+class CpuTopology {
+public:
+    struct Core {
+        int id;
+        uint32_t capacity;
+    };
+
+private:
+    // Online cores, highest capacity first.
+    std::vector<Core> cores;
+    uint32_t maxCapacity = 0;
+
+public:
+    void load();
+
+    inline const std::vector<Core> &getCores() const { return cores; }
+
+    inline bool isBig(const Core &core) const { return core.capacity == maxCapacity; }
+
+    /**
+     * @return ids of every core sharing this core's capacity (its cluster)
+     */
+    std::vector<int> clusterOf(const Core &core) const;
+
+    std::vector<int> bigCores() const;
+
+    std::vector<int> littleCores() const;
+
+    /**
+     * Restrict the calling thread to the given cores.
+     * @return false if the kernel refused (e.g. cores offline or sandboxed)
+     */
+    static bool pinCurrentThread(const std::vector<int> &cpus);
+};
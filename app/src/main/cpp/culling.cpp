@@ -0,0 +1,199 @@
+#include "culling.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+#if defined(__ARM_NEON)
+    typedef float32x4_t f4;
+    typedef uint32x4_t m4;
+
+    inline f4 load(const float *p) { return vld1q_f32(p); }
+
+    inline f4 splat(float v) { return vdupq_n_f32(v); }
+
+    inline f4 add(f4 a, f4 b) { return vaddq_f32(a, b); }
+
+    inline f4 sub(f4 a, f4 b) { return vsubq_f32(a, b); }
+
+    inline f4 mul(f4 a, f4 b) { return vmulq_f32(a, b); }
+
+    inline m4 le(f4 a, f4 b) { return vcleq_f32(a, b); }
+
+    inline m4 both(m4 a, m4 b) { return vandq_u32(a, b); }
+
+    inline unsigned bits(m4 m) {
+        const uint32_t weights[4] = {1, 2, 4, 8};
+        uint32x4_t w = vandq_u32(m, vld1q_u32(weights));
+#if defined(__aarch64__)
+        return vaddvq_u32(w);
+#else
+        uint32x2_t s = vadd_u32(vget_low_u32(w), vget_high_u32(w));
+        return vget_lane_u32(vpadd_u32(s, s), 0);
+#endif
+    }
+#elif defined(__SSE2__)
+    typedef __m128 f4;
+    typedef __m128 m4;
+
+    inline f4 load(const float *p) { return _mm_loadu_ps(p); }
+
+    inline f4 splat(float v) { return _mm_set1_ps(v); }
+
+    inline f4 add(f4 a, f4 b) { return _mm_add_ps(a, b); }
+
+    inline f4 sub(f4 a, f4 b) { return _mm_sub_ps(a, b); }
+
+    inline f4 mul(f4 a, f4 b) { return _mm_mul_ps(a, b); }
+
+    inline m4 le(f4 a, f4 b) { return _mm_cmple_ps(a, b); }
+
+    inline m4 both(m4 a, m4 b) { return _mm_and_ps(a, b); }
+
+    inline unsigned bits(m4 m) { return (unsigned) _mm_movemask_ps(m); }
+#else
+    struct f4 {
+        float v[4];
+    };
+    typedef unsigned m4;
+
+    inline f4 load(const float *p) { return f4{{p[0], p[1], p[2], p[3]}}; }
+
+    inline f4 splat(float v) { return f4{{v, v, v, v}}; }
+
+#define CULLING_LANEWISE(name, op) \
+    inline f4 name(f4 a, f4 b) { \
+        return f4{{a.v[0] op b.v[0], a.v[1] op b.v[1], a.v[2] op b.v[2], a.v[3] op b.v[3]}}; \
+    }
+
+    CULLING_LANEWISE(add, +)
+
+    CULLING_LANEWISE(sub, -)
+
+    CULLING_LANEWISE(mul, *)
+
+#undef CULLING_LANEWISE
+
+    inline m4 le(f4 a, f4 b) {
+        return (a.v[0] <= b.v[0]) | (a.v[1] <= b.v[1]) << 1 | (a.v[2] <= b.v[2]) << 2 |
+               (a.v[3] <= b.v[3]) << 3;
+    }
+
+    inline m4 both(m4 a, m4 b) { return a & b; }
+
+    inline unsigned bits(m4 m) { return m; }
+#endif
+
+    /**
+     * Append base + lane for every set bit of mask.
+     */
+    inline size_t emit(unsigned mask, uint32_t base, uint32_t *out, size_t count) {
+        while (mask) {
+            out[count++] = base + (uint32_t) __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+        return count;
+    }
+
+    /**
+     * Run test(i, streams...) over groups of four. The final partial group
+     * reads from zero-padded copies and masks off the missing lanes.
+     */
+    template<size_t Streams, typename Test>
+    size_t forGroups(const float *const (&streams)[Streams], size_t n, uint32_t *out,
+                     Test test) {
+        size_t count = 0;
+        size_t whole = n & ~size_t(3);
+        for (size_t i = 0; i < whole; i += 4) {
+            const float *at[Streams];
+            for (size_t s = 0; s < Streams; s++) {
+                at[s] = streams[s] + i;
+            }
+            count = emit(test(at), (uint32_t) i, out, count);
+        }
+        if (whole < n) {
+            float tail[Streams][4];
+            const float *at[Streams];
+            memset(tail, 0, sizeof(tail));
+            for (size_t s = 0; s < Streams; s++) {
+                memcpy(tail[s], streams[s] + whole, (n - whole) * sizeof(float));
+                at[s] = tail[s];
+            }
+            unsigned live = (1u << (n - whole)) - 1;
+            count = emit(test(at) & live, (uint32_t) whole, out, count);
+        }
+        return count;
+    }
+}
+
+Frustum Frustum::fromMatrix(const float m[16]) {
+    // Gribb/Hartmann: rows of the matrix combined; m[col * 4 + row].
+    auto row = [m](int r, int c) { return m[c * 4 + r]; };
+    Frustum f;
+    for (int p = 0; p < 6; p++) {
+        int axis = p / 2;
+        float sign = (p & 1) ? -1.0f : 1.0f;
+        for (int c = 0; c < 4; c++) {
+            f.planes[p][c] = row(3, c) + sign * row(axis, c);
+        }
+        float len = std::sqrt(f.planes[p][0] * f.planes[p][0] +
+                              f.planes[p][1] * f.planes[p][1] +
+                              f.planes[p][2] * f.planes[p][2]);
+        if (len > 0) {
+            for (auto &v: f.planes[p]) {
+                v /= len;
+            }
+        }
+    }
+    return f;
+}
+
+namespace Culling {
+    size_t points2D(const float *x, const float *y, size_t n, float radius,
+                    const Viewport2D &view, uint32_t *out) {
+        f4 minX = splat(view.minX - radius), maxX = splat(view.maxX + radius);
+        f4 minY = splat(view.minY - radius), maxY = splat(view.maxY + radius);
+        const float *const streams[2] = {x, y};
+        return forGroups(streams, n, out, [&](const float *const (&at)[2]) {
+            f4 px = load(at[0]), py = load(at[1]);
+            return bits(both(both(le(minX, px), le(px, maxX)),
+                             both(le(minY, py), le(py, maxY))));
+        });
+    }
+
+    size_t aabbs2D(const float *minX, const float *minY, const float *maxX, const float *maxY,
+                   size_t n, const Viewport2D &view, uint32_t *out) {
+        f4 vMinX = splat(view.minX), vMaxX = splat(view.maxX);
+        f4 vMinY = splat(view.minY), vMaxY = splat(view.maxY);
+        const float *const streams[4] = {minX, minY, maxX, maxY};
+        return forGroups(streams, n, out, [&](const float *const (&at)[4]) {
+            return bits(both(both(le(load(at[0]), vMaxX), le(vMinX, load(at[2]))),
+                             both(le(load(at[1]), vMaxY), le(vMinY, load(at[3])))));
+        });
+    }
+
+    size_t spheres3D(const float *x, const float *y, const float *z, const float *radius,
+                     size_t n, const Frustum &frustum, uint32_t *out) {
+        const float *const streams[4] = {x, y, z, radius};
+        return forGroups(streams, n, out, [&](const float *const (&at)[4]) {
+            f4 px = load(at[0]), py = load(at[1]), pz = load(at[2]);
+            f4 negR = sub(splat(0), load(at[3]));
+            unsigned mask = 0xf;
+            for (auto &p: frustum.planes) {
+                f4 dist = add(add(mul(splat(p[0]), px), mul(splat(p[1]), py)),
+                              add(mul(splat(p[2]), pz), splat(p[3])));
+                mask &= bits(le(negR, dist));
+                if (!mask) {
+                    break;
+                }
+            }
+            return mask;
+        });
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct Viewport2D {
+    float minX, minY, maxX, maxY;
+};
+
+/**
+ * Six inward-facing planes (nx, ny, nz, d); a point p is inside a plane
+ * when dot(n, p) + d >= 0.
+ */
+struct Frustum {
+    float planes[6][4];
+
+    /**
+     * Extract the planes from a column-major view-projection matrix
+     * (OpenGL clip-space convention), normalized so distances are metric.
+     */
+    static Frustum fromMatrix(const float m[16]);
+};
+
+/**
+ * Visibility tests over packed bounds arrays, four objects per step with
+ * NEON or SSE2 (scalar elsewhere). Each writes the indices of the visible
+ * objects to out, in ascending order, and returns how many there are; out
+ * must have room for n entries.
+ */
+namespace Culling {
+    size_t points2D(const float *x, const float *y, size_t n, float radius,
+                    const Viewport2D &view, uint32_t *out);
+
+    size_t aabbs2D(const float *minX, const float *minY, const float *maxX, const float *maxY,
+                   size_t n, const Viewport2D &view, uint32_t *out);
+
+    size_t spheres3D(const float *x, const float *y, const float *z, const float *radius,
+                     size_t n, const Frustum &frustum, uint32_t *out);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+
+/**
+ * @return CLOCK_MONOTONIC time in nanoseconds
+ */
+inline int64_t monotonicNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
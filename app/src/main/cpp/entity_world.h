@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "slot_map.h"
+
+/**
+ * Initial component values for a moving entity.
+ */
+struct MotionDesc {
+    float x, y;
+    float vx, vy;
+    float angle;
+    float spin;
+};
+
+/**
+ * Entity storage for moving objects, kept as structure-of-arrays.
+ * Each component field is its own contiguous float array, so systems run
+ * as plain loops over restrict-qualified pointers that the compiler turns
+ * into NEON/SSE code. Entities are addressed through SlotMap handles; the
+ * SlotMap value is a caller-defined kind id, and its swap-on-erase is
+ * mirrored on every component array to keep them packed.
+ */
+class EntityWorld {
+private:
+    SlotMap<uint32_t> entities;
+    std::vector<float> posX, posY;
+    std::vector<float> velX, velY;
+    std::vector<float> angle, spin;
+
+    /**
+     * floor() for |x| < 2^31 through an integer conversion, which SSE2 and
+     * NEON vectorize; std::floor needs SSE4.1 to stay inline on x86.
+     */
+    static inline float floorSmall(float x) {
+        auto t = (float) (int32_t) x;
+        return t - (float) (t > x);
+    }
+
+    template<typename F>
+    void forEachArray(F f) {
+        f(posX);
+        f(posY);
+        f(velX);
+        f(velY);
+        f(angle);
+        f(spin);
+    }
+
+public:
+    void reserve(size_t capacity) {
+        entities.reserve(capacity);
+        forEachArray([capacity](std::vector<float> &a) { a.reserve(capacity); });
+    }
+
+    SlotHandle spawn(const MotionDesc &desc, uint32_t kind = 0) {
+        posX.push_back(desc.x);
+        posY.push_back(desc.y);
+        velX.push_back(desc.vx);
+        velY.push_back(desc.vy);
+        angle.push_back(desc.angle);
+        spin.push_back(desc.spin);
+        return entities.insert(kind);
+    }
+
+    void destroy(SlotHandle h) {
+        auto hole = entities.erase(h);
+        if (hole == SlotMap<uint32_t>::npos) {
+            return;
+        }
+        forEachArray([hole](std::vector<float> &a) {
+            a[hole] = a.back();
+            a.pop_back();
+        });
+    }
+
+    inline bool alive(SlotHandle h) const { return entities.contains(h); }
+
+    inline size_t size() const { return entities.size(); }
+
+    inline size_t indexOf(SlotHandle h) const { return entities.indexOf(h); }
+
+    inline SlotHandle handleAt(size_t index) const { return entities.handleAt(index); }
+
+    inline const float *positionsX() const { return posX.data(); }
+
+    inline const float *positionsY() const { return posY.data(); }
+
+    inline const float *angles() const { return angle.data(); }
+
+    void setVelocity(SlotHandle h, float vx, float vy) {
+        auto i = entities.indexOf(h);
+        if (i != SlotMap<uint32_t>::npos) {
+            velX[i] = vx;
+            velY[i] = vy;
+        }
+    }
+
+    /**
+     * Integrate position and rotation for entities [begin, end).
+     * Ranges are independent, so callers may split the world across threads.
+     */
+    void update(float dt, size_t begin, size_t end) {
+        const float twoPi = 6.28318531f;
+        const float invTwoPi = 1.0f / twoPi;
+        float *__restrict px = posX.data();
+        float *__restrict py = posY.data();
+        const float *__restrict vx = velX.data();
+        const float *__restrict vy = velY.data();
+        for (size_t i = begin; i < end; i++) {
+            px[i] += vx[i] * dt;
+            py[i] += vy[i] * dt;
+        }
+        float *__restrict a = angle.data();
+        const float *__restrict s = spin.data();
+        for (size_t i = begin; i < end; i++) {
+            float t = a[i] + s[i] * dt;
+            // Branch-free wrap into [0, 2pi) keeps the loop vectorizable.
+            a[i] = t - twoPi * floorSmall(t * invTwoPi);
+        }
+    }
+
+    void update(float dt) { update(dt, 0, size()); }
+
+    /**
+     * Wrap positions of entities [begin, end) into [0, width) x [0, height),
+     * so objects leaving one edge come back at the opposite one.
+     */
+    void wrap(float width, float height, size_t begin, size_t end) {
+        const float invWidth = 1 / width, invHeight = 1 / height;
+        float *__restrict px = posX.data();
+        float *__restrict py = posY.data();
+        for (size_t i = begin; i < end; i++) {
+            px[i] -= width * floorSmall(px[i] * invWidth);
+            py[i] -= height * floorSmall(py[i] * invHeight);
+        }
+    }
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+/**
+ * Linear (bump) allocator for scratch data that only lives for one frame.
+ * The backing block is allocated once up front; reset() releases everything
+ * at once and is called by the engine right after eglSwapBuffers().
+ */
+class FrameArena {
+private:
+    std::unique_ptr<uint8_t[]> buffer;
+    size_t capacity;
+    size_t offset;
+    size_t highWater;
+    uint32_t overflows;
+
+public:
+    explicit FrameArena(size_t capacity)
+            : buffer(new uint8_t[capacity]), capacity(capacity), offset(0), highWater(0),
+              overflows(0) {}
+
+    FrameArena(const FrameArena &) = delete;
+
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    /**
+     * Carve size bytes out of the arena.
+     * @return nullptr when the arena is exhausted (never falls back to the heap)
+     */
+    void *alloc(size_t size, size_t align = alignof(std::max_align_t)) {
+        size_t aligned = (offset + align - 1) & ~(align - 1);
+        if (aligned + size > capacity) {
+            overflows++;
+            return nullptr;
+        }
+        offset = aligned + size;
+        if (highWater < offset) {
+            highWater = offset;
+        }
+        return buffer.get() + aligned;
+    }
+
+    /**
+     * Allocate an uninitialized array of count elements of a trivial type.
+     */
+    template<typename T>
+    T *allocArray(size_t count) {
+        return static_cast<T *>(alloc(sizeof(T) * count, alignof(T)));
+    }
+
+    /**
+     * Drop every allocation made since the last reset.
+     */
+    void reset() { offset = 0; }
+
+    inline size_t used() const { return offset; }
+
+    inline size_t getCapacity() const { return capacity; }
+
+    inline size_t getHighWater() const { return highWater; }
+
+    inline uint32_t getOverflows() const { return overflows; }
+};
@@ -0,0 +1,125 @@
+#include "frame_loop.h"
+
+#include <android/input.h>
+
+#include <cmath>
+
+#include "alloc_guard.h"
+#include "audio_engine.h"
+#include "engine_clock.h"
+#include "gpu_resources.h"
+#include "job_system.h"
+#include "logging.h"
+#include "mem_tracker.h"
+#include "perf_counters.h"
+#include "scene.h"
+#include "session_replay.h"
+#include "task.h"
+#include "texture_residency.h"
+#include "thermal_governor.h"
+
+void FrameLoop::init(const Systems &frameSystems) {
+    systems = frameSystems;
+    lastFrameNs = 0;
+}
+
+void FrameLoop::audioOutputChanged() {
+    auto rate = (uint32_t) systems.audio->getSampleRate();
+    for (auto &b: blips) {
+        if (b->clip.sampleRate == rate) {
+            blip = &b->clip;
+            return;
+        }
+    }
+    MemTagScope tag(MemTag::Audio);
+    const float seconds = 0.08f;
+    auto b = std::make_unique<Blip>();
+    b->samples.resize((size_t) ((float) rate * seconds));
+    for (size_t i = 0; i < b->samples.size(); i++) {
+        float t = (float) i / (float) rate;
+        b->samples[i] = std::sin(6.28318531f * 880 * t) * std::exp(-t * 40);
+    }
+    b->clip = AudioClip{b->samples.data(), (uint32_t) b->samples.size(), 1,
+                        SampleFormat::Float, rate};
+    blip = &b->clip;
+    blips.push_back(std::move(b));
+}
+
+void FrameLoop::touch(int32_t action, float x, float y) {
+    PerfScope perf(HotPath::Input);
+    if (action == AMOTION_EVENT_ACTION_DOWN && blip) {
+        int32_t width = systems.scene->windowWidth();
+        float pan = width ? x * 2 / (float) width - 1 : 0;
+        systems.audio->play(blip, 0.5f, pan);
+    }
+    systems.scene->touch(action, x, y, systems.thermal->quality().effectQuality);
+}
+
+void FrameLoop::accelerometer(float x, float y, float z) const {
+    PerfScope log(HotPath::Log);
+    LOGI("accelerometer: x=%f y=%f z=%f", x, y, z);
+}
+
+uint32_t FrameLoop::step(int64_t frameStartNs) {
+    AllocGuard::beginFrame();
+    auto &replay = *systems.replay;
+    // Step by measured time, clamped so a stall does not teleport
+    // everything; the first frame after a pause assumes 60 Hz.
+    float dt = lastFrameNs ? (float) ((frameStartNs - lastFrameNs) / 1e9) : 1.0f / 60;
+    dt = dt < 0.1f ? dt : 0.1f;
+    lastFrameNs = frameStartNs;
+    if (replay.isActive()) {
+        dt = replay.beginFrame(frameStartNs);
+        while (auto *e = replay.next()) {
+            if (e->type == SessionEvent::Type::Touch) {
+                touch(e->action, e->x, e->y);
+            } else {
+                accelerometer(e->x, e->y, e->z);
+            }
+        }
+    }
+    auto *thermal = systems.thermal;
+    if (thermal->sampleDue(frameStartNs)) {
+        // A binder call (a file read on the stand-in): off this thread.
+        systems.jobs->submitBackground([](void *governor, uint32_t, uint32_t) {
+            static_cast<ThermalGovernor *>(governor)->sample();
+        }, thermal);
+    }
+    if (thermal->update() && onQualityChange) {
+        onQualityChange();
+    }
+    {
+        PerfScope perf(HotPath::Animate);
+        systems.scheduler->tick(frameStartNs);
+        // Done with events; draw next animation frame.
+        systems.scene->update(dt);
+    }
+    // Spread re-uploads after a context loss over several frames.
+    systems.gpu->rehydrate(2000000);
+    // Presenting is throttled to the screen update rate, which paces the
+    // caller's loop; dt above keeps motion correct at any rate.
+    draw();
+    // Load the mips this frame's draws asked for.
+    systems.textures->update(2000000);
+    auto allocs = AllocGuard::endFrame();
+    if (allocs) {
+        LOGW("%u heap allocations during frame", allocs);
+    }
+    if (replay.isActive()) {
+        replay.endFrame(monotonicNs() - frameStartNs, allocs);
+    }
+    return allocs;
+}
+
+void FrameLoop::draw() {
+    if (!drawable) {
+        return;
+    }
+    {
+        PerfScope perf(HotPath::CommandRecording);
+        systems.scene->draw();
+    }
+    if (present) {
+        present();
+    }
+}
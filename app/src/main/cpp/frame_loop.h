@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "audio_mixer.h"
+
+class AudioEngine;
+class GpuResources;
+class JobSystem;
+class Scene;
+class Scheduler;
+class SessionReplay;
+class TextureResidency;
+class ThermalGovernor;
+
+/**
+ * The engine's frame, shared by Engine::animate() and the headless replay
+ * runner so both measure the same work: replayed input, thermal sampling,
+ * tasks and the scene update, GL rehydration, draw recording and texture
+ * streaming, each timed with PerfCounters. Touches (with their blip) and
+ * accelerometer samples go through here too, live or replayed. The
+ * platform presents the frame and applies quality changes through hooks.
+ * Engine thread only.
+ */
+class FrameLoop {
+public:
+    /**
+     * What a frame drives; everything but the touch sound is required.
+     */
+    struct Systems {
+        Scene *scene;
+        GpuResources *gpu;
+        TextureResidency *textures;
+        ThermalGovernor *thermal;
+        Scheduler *scheduler;
+        JobSystem *jobs;
+        SessionReplay *replay;
+        AudioEngine *audio;
+    };
+
+private:
+    struct Blip {
+        std::vector<float> samples;
+        AudioClip clip;
+    };
+
+    Systems systems{};
+    // Start of the previous frame; 0 when animation was paused.
+    int64_t lastFrameNs = 0;
+    // One blip per output rate seen: voices may still be playing an older
+    // one after the stream comes back at another rate, so none is freed.
+    std::vector<std::unique_ptr<Blip>> blips;
+    const AudioClip *blip = nullptr;
+    // A surface and a current context to draw into.
+    bool drawable = false;
+
+public:
+    // Swap the recorded frame to the screen; time it as HotPath::Swap.
+    std::function<void()> present;
+    // The thermal level changed; apply its quality.
+    std::function<void()> onQualityChange;
+
+    void init(const Systems &frameSystems);
+
+    /**
+     * Use a touch blip at the audio output's rate, synthesizing it the
+     * first time that rate is seen: a decaying 880 Hz sine. Call whenever
+     * the output is (re)opened.
+     */
+    void audioOutputChanged();
+
+    /**
+     * A touch in window coordinates, live or replayed.
+     * @param action AMOTION_EVENT_ACTION_* without the pointer index
+     */
+    void touch(int32_t action, float x, float y);
+
+    /**
+     * An accelerometer sample, live or replayed.
+     */
+    void accelerometer(float x, float y, float z) const;
+
+    /**
+     * One animated frame: feed the replay's due events, sample thermal
+     * state, tick tasks, update the scene, rehydrate, draw and present,
+     * then stream textures. Steps by measured time since the last frame,
+     * clamped, or by the replay's frame time while one is active.
+     * @return heap allocations during the frame (debug builds)
+     */
+    uint32_t step(int64_t frameStartNs);
+
+    /**
+     * Record the scene's draw commands and present them; nothing while
+     * there is no surface.
+     */
+    void draw();
+
+    /**
+     * A surface and context came up (true) or are going away (false).
+     */
+    inline void setDrawable(bool ready) { drawable = ready; }
+
+    /**
+     * Animation stopped; the next frame assumes 60 Hz.
+     */
+    inline void pause() { lastFrameNs = 0; }
+};
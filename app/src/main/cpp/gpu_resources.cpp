@@ -0,0 +1,326 @@
+#include "gpu_resources.h"
+
+#include <android/asset_manager.h>
+#include <strings.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "engine_clock.h"
+#include "logging.h"
+#include "mem_tracker.h"
+
+namespace {
+    bool endsWith(const std::string &s, const char *suffix) {
+        size_t n = strlen(suffix);
+        return s.size() >= n && strcasecmp(s.c_str() + s.size() - n, suffix) == 0;
+    }
+
+    /**
+     * Uncompressed true-color (type 2) or grayscale (type 3) TGA.
+     */
+    bool decodeTga(const std::vector<uint8_t> &file, GpuData &data) {
+        if (file.size() < 18) {
+            return false;
+        }
+        const uint8_t *h = file.data();
+        uint32_t idLength = h[0], type = h[2], bits = h[16];
+        uint32_t width = h[12] | h[13] << 8, height = h[14] | h[15] << 8;
+        bool topDown = h[17] & 0x20;
+        uint32_t channels = bits / 8;
+        if (h[1] || (type != 2 && type != 3) || (type == 2 && bits != 24 && bits != 32) ||
+            (type == 3 && bits != 8)) {
+            LOGW("gpu: unsupported tga (type %u, %u bits)", type, bits);
+            return false;
+        }
+        size_t offset = 18 + idLength;
+        size_t rowBytes = (size_t) width * channels;
+        if (file.size() < offset + rowBytes * height) {
+            return false;
+        }
+        data.width = width;
+        data.height = height;
+        data.format = channels == 4 ? GL_RGBA : channels == 3 ? GL_RGB : GL_LUMINANCE;
+        data.bytes.resize(rowBytes * height);
+        for (uint32_t y = 0; y < height; y++) {
+            // GL rows start at the bottom, like TGA's default origin.
+            const uint8_t *src = &file[offset + rowBytes * (topDown ? height - 1 - y : y)];
+            uint8_t *dst = &data.bytes[rowBytes * y];
+            if (channels == 1) {
+                memcpy(dst, src, rowBytes);
+                continue;
+            }
+            for (uint32_t x = 0; x < width; x++, src += channels, dst += channels) {
+                // BGR(A) to RGB(A).
+                dst[0] = src[2];
+                dst[1] = src[1];
+                dst[2] = src[0];
+                if (channels == 4) {
+                    dst[3] = src[3];
+                }
+            }
+        }
+        return true;
+    }
+}
+
+uint32_t GpuData::bytesPerPixel(GLenum format) {
+    switch (format) {
+        case GL_RGBA:
+            return 4;
+        case GL_RGB:
+            return 3;
+        case GL_LUMINANCE_ALPHA:
+            return 2;
+        default:
+            return 1;
+    }
+}
+
+bool GpuResources::loadAsset(AAssetManager *assets, const std::string &path, GpuData &data) {
+    AAsset *asset = assets ? AAssetManager_open(assets, path.c_str(), AASSET_MODE_BUFFER)
+                           : nullptr;
+    if (!asset) {
+        LOGW("gpu: cannot open %s", path.c_str());
+        return false;
+    }
+    std::vector<uint8_t> file((size_t) AAsset_getLength64(asset));
+    bool ok = AAsset_read(asset, file.data(), file.size()) == (int) file.size();
+    AAsset_close(asset);
+    if (!ok) {
+        return false;
+    }
+    if (endsWith(path, ".tga")) {
+        return decodeTga(file, data);
+    }
+    data.bytes = std::move(file);
+    data.width = (uint32_t) data.bytes.size();
+    data.height = 1;
+    return true;
+}
+
+void GpuResources::setCacheBudget(size_t bytes) {
+    cacheBudget = bytes;
+    trimCache();
+}
+
+SlotHandle GpuResources::addTexture(const std::string &asset, const GpuTextureParams &params,
+                                    int priority, Loader loader) {
+    Resource resource;
+    resource.texture = true;
+    resource.asset = asset;
+    resource.textureParams = params;
+    resource.priority = priority;
+    resource.loader = std::move(loader);
+    return resources.insert(std::move(resource));
+}
+
+SlotHandle GpuResources::addBuffer(const std::string &asset, const GpuBufferParams &params,
+                                   int priority, Loader loader) {
+    Resource resource;
+    resource.texture = false;
+    resource.asset = asset;
+    resource.bufferParams = params;
+    resource.priority = priority;
+    resource.loader = std::move(loader);
+    return resources.insert(std::move(resource));
+}
+
+void GpuResources::remove(SlotHandle handle) {
+    auto *resource = resources.get(handle);
+    if (!resource) {
+        return;
+    }
+    if (resource->name && contextReady) {
+        if (resource->texture) {
+            glDeleteTextures(1, &resource->name);
+        } else {
+            glDeleteBuffers(1, &resource->name);
+        }
+    }
+    cacheBytes -= resource->cached.bytes.size();
+    resources.erase(handle);
+    // A stale handle left in the queue is skipped when it comes up.
+}
+
+void GpuResources::clear() {
+    while (!resources.empty()) {
+        remove(resources.handleAt(resources.size() - 1));
+    }
+    queue.clear();
+}
+
+GLuint GpuResources::get(SlotHandle handle) {
+    auto *resource = resources.get(handle);
+    if (!resource || !contextReady) {
+        return 0;
+    }
+    resource->lastUse = ++useCounter;
+    if (!resource->name) {
+        bool queued = resource->queued;
+        auto start = monotonicNs();
+        if (upload(*resource) && queued) {
+            rehydration.rehydrateNs += monotonicNs() - start;
+        }
+    }
+    return resource->name;
+}
+
+bool GpuResources::upload(Resource &resource) {
+    bool fromCache = !resource.cached.bytes.empty();
+    GpuData loaded;
+    const GpuData *data = &resource.cached;
+    if (!fromCache && (resource.loader || !resource.asset.empty())) {
+        bool ok;
+        {
+            // Decoded data may stay on as the cache entry; charge it to assets.
+            MemTagScope tag(MemTag::Assets);
+            ok = resource.loader ? resource.loader(assets, resource.asset, loaded)
+                                 : loadAsset(assets, resource.asset, loaded);
+        }
+        if (!ok) {
+            LOGW("gpu: failed to load %s", resource.asset.c_str());
+            resource.queued = false;
+            return false;
+        }
+        data = &loaded;
+    }
+
+    if (resource.texture) {
+        auto &params = resource.textureParams;
+        glGenTextures(1, &resource.name);
+        glBindTexture(GL_TEXTURE_2D, resource.name);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, params.minFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, params.magFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, params.wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, params.wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, params.mipmaps ? GL_TRUE : GL_FALSE);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, (GLint) data->format, (GLsizei) data->width,
+                     (GLsizei) data->height, 0, data->format, GL_UNSIGNED_BYTE,
+                     data->bytes.empty() ? nullptr : data->bytes.data());
+        glBindTexture(GL_TEXTURE_2D, 0);
+        resource.gpuBytes = (size_t) data->width * data->height *
+                            GpuData::bytesPerPixel(data->format);
+        if (params.mipmaps) {
+            resource.gpuBytes += resource.gpuBytes / 3;
+        }
+    } else {
+        auto &params = resource.bufferParams;
+        resource.gpuBytes = data->bytes.empty() ? params.size : data->bytes.size();
+        glGenBuffers(1, &resource.name);
+        glBindBuffer(params.target, resource.name);
+        glBufferData(params.target, (GLsizeiptr) resource.gpuBytes,
+                     data->bytes.empty() ? nullptr : data->bytes.data(), params.usage);
+        glBindBuffer(params.target, 0);
+    }
+
+    if (resource.queued) {
+        resource.queued = false;
+        rehydration.rehydrateBytes += resource.gpuBytes;
+        rehydration.rehydrated++;
+        if (fromCache) {
+            rehydration.cacheHits++;
+        } else if (data == &loaded) {
+            rehydration.reloads++;
+        }
+    }
+    resource.wanted = true;
+    if (!fromCache && !loaded.bytes.empty() && loaded.bytes.size() <= cacheBudget) {
+        cacheBytes += loaded.bytes.size();
+        resource.cached = std::move(loaded);
+        trimCache();
+    }
+    return true;
+}
+
+void GpuResources::trimCache() {
+    while (cacheBytes > cacheBudget) {
+        Resource *victim = nullptr;
+        for (auto &resource: resources) {
+            if (resource.cached.bytes.empty()) {
+                continue;
+            }
+            if (!victim || resource.priority < victim->priority ||
+                (resource.priority == victim->priority && resource.lastUse < victim->lastUse)) {
+                victim = &resource;
+            }
+        }
+        if (!victim) {
+            break;
+        }
+        cacheBytes -= victim->cached.bytes.size();
+        victim->cached = GpuData();
+    }
+}
+
+void GpuResources::onContextLost() {
+    // The objects die with the context; only the names are forgotten.
+    contextReady = false;
+    queue.clear();
+    for (size_t i = 0; i < resources.size(); i++) {
+        auto &resource = resources.data()[i];
+        resource.name = 0;
+        resource.queued = resource.wanted;
+        if (resource.queued) {
+            queue.push_back(resources.handleAt(i));
+        }
+    }
+    // Highest priority first; the queue is consumed from the back.
+    std::stable_sort(queue.begin(), queue.end(), [this](SlotHandle a, SlotHandle b) {
+        return resources.get(a)->priority < resources.get(b)->priority;
+    });
+    rehydration = Stats{};
+}
+
+void GpuResources::onContextReady() {
+    contextReady = true;
+    contextReadyNs = monotonicNs();
+}
+
+bool GpuResources::rehydrate(int64_t budgetNs) {
+    if (!contextReady || queue.empty()) {
+        return false;
+    }
+    auto start = monotonicNs();
+    auto now = start;
+    while (!queue.empty() && now - start < budgetNs) {
+        auto *resource = resources.get(queue.back());
+        queue.pop_back();
+        if (resource && resource->queued && !resource->name) {
+            upload(*resource);
+        }
+        now = monotonicNs();
+    }
+    rehydration.rehydrateNs += now - start;
+    if (queue.empty()) {
+        finishRehydration();
+    }
+    return !queue.empty();
+}
+
+void GpuResources::finishRehydration() {
+    rehydration.rehydrateWallNs = monotonicNs() - contextReadyNs;
+    LOGI("gpu: rehydrated %u resources, %zu KiB (%u from cache) in %.2fms over %.1fms",
+         rehydration.rehydrated, rehydration.rehydrateBytes / 1024,
+         rehydration.cacheHits, rehydration.rehydrateNs / 1e6,
+         rehydration.rehydrateWallNs / 1e6);
+}
+
+GpuResources::Stats GpuResources::getStats() const {
+    Stats stats = rehydration;
+    stats.resources = (uint32_t) resources.size();
+    stats.resident = 0;
+    stats.pending = 0;
+    stats.gpuBytes = 0;
+    for (auto &resource: resources) {
+        if (resource.name) {
+            stats.resident++;
+            stats.gpuBytes += resource.gpuBytes;
+        } else if (resource.queued) {
+            stats.pending++;
+        }
+    }
+    stats.cacheBytes = cacheBytes;
+    return stats;
+}
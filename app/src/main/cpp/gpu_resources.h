@@ -0,0 +1,175 @@
+#pragma once
+
+#include <GLES/gl.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "slot_map.h"
+
+struct AAssetManager;
+
+/**
+ * CPU-side contents of a GPU resource. Textures are tightly packed rows of
+ * format (GL_RGBA, GL_RGB, GL_LUMINANCE, GL_LUMINANCE_ALPHA or GL_ALPHA)
+ * unsigned bytes; buffers use bytes only.
+ */
+struct GpuData {
+    std::vector<uint8_t> bytes;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    GLenum format = GL_RGBA;
+
+    /**
+     * @return bytes per texel of one of the formats above
+     */
+    static uint32_t bytesPerPixel(GLenum format);
+};
+
+struct GpuTextureParams {
+    GLint minFilter = GL_LINEAR;
+    GLint magFilter = GL_LINEAR;
+    GLint wrap = GL_CLAMP_TO_EDGE;
+    bool mipmaps = false;
+};
+
+struct GpuBufferParams {
+    GLenum target = GL_ARRAY_BUFFER;
+    GLenum usage = GL_STATIC_DRAW;
+    // Storage to allocate when there is no source data, e.g. a buffer
+    // refilled every frame.
+    uint32_t size = 0;
+};
+
+/**
+ * Registry of every texture and buffer the renderer owns, with where each
+ * came from (an asset path and its upload parameters), so that all of
+ * them can be rebuilt after the EGL context goes away.
+ * After onContextLost() every resource that was on the GPU is queued;
+ * rehydrate() re-uploads from the queue, highest priority first, within a
+ * per-frame time budget, and get() uploads anything still queued the
+ * moment it is needed. Decoded data is kept in a CPU cache up to a byte
+ * budget, least recently used and lowest priority dropped first, so
+ * rehydrating cached resources skips the asset read and decode. Uncached
+ * resources are reloaded through their loader. Used from the GL thread
+ * only.
+ */
+class GpuResources {
+public:
+    /**
+     * Fill data from an asset; the default reads the asset's bytes,
+     * decoding .tga images (uncompressed, 8, 24 or 32 bits).
+     */
+    typedef std::function<bool(AAssetManager *assets, const std::string &asset,
+                                GpuData &data)> Loader;
+
+    struct Stats {
+        uint32_t resources;
+        uint32_t resident;
+        uint32_t pending;
+        size_t gpuBytes;
+        size_t cacheBytes;
+        // Since the last context loss.
+        uint32_t rehydrated;
+        uint32_t cacheHits;
+        uint32_t reloads;
+        int64_t rehydrateNs;
+        int64_t rehydrateWallNs;
+        size_t rehydrateBytes;
+    };
+
+    /**
+     * The default loader.
+     */
+    static bool loadAsset(AAssetManager *assets, const std::string &path, GpuData &data);
+
+private:
+    struct Resource {
+        bool texture;
+        std::string asset;
+        GpuTextureParams textureParams;
+        GpuBufferParams bufferParams;
+        int priority;
+        Loader loader;
+        GLuint name = 0;
+        // Uploaded at least once, so it is rebuilt after a context loss.
+        bool wanted = false;
+        bool queued = false;
+        size_t gpuBytes = 0;
+        GpuData cached;
+        uint64_t lastUse = 0;
+    };
+
+    SlotMap<Resource> resources;
+    std::vector<SlotHandle> queue;
+    AAssetManager *assets = nullptr;
+    size_t cacheBudget = 16u << 20;
+    size_t cacheBytes = 0;
+    uint64_t useCounter = 0;
+    bool contextReady = false;
+    Stats rehydration{};
+    int64_t contextReadyNs = 0;
+
+    bool upload(Resource &resource);
+
+    void trimCache();
+
+    void finishRehydration();
+
+public:
+    ~GpuResources() { clear(); }
+
+    void setAssetManager(AAssetManager *assetManager) { assets = assetManager; }
+
+    /**
+     * Bytes of decoded data kept for rehydration; 0 keeps none.
+     */
+    void setCacheBudget(size_t bytes);
+
+    /**
+     * @param priority higher is rehydrated first and cached longer
+     * @param loader nullptr for the default asset loader
+     */
+    SlotHandle addTexture(const std::string &asset, const GpuTextureParams &params,
+                          int priority = 0, Loader loader = nullptr);
+
+    /**
+     * @param asset empty, with no loader, for a buffer with no source data
+     */
+    SlotHandle addBuffer(const std::string &asset, const GpuBufferParams &params,
+                         int priority = 0, Loader loader = nullptr);
+
+    /**
+     * Delete the GL object, if there is one, and forget the resource.
+     */
+    void remove(SlotHandle handle);
+
+    void clear();
+
+    /**
+     * @return the GL name, uploading the resource first if needed; 0 when
+     * there is no context or the upload failed
+     */
+    GLuint get(SlotHandle handle);
+
+    /**
+     * The context is about to be destroyed, along with every GL object.
+     */
+    void onContextLost();
+
+    /**
+     * A new context is current; queued resources can be uploaded again.
+     */
+    void onContextReady();
+
+    /**
+     * Upload queued resources until budgetNs has been spent.
+     * @return true while some are still queued
+     */
+    bool rehydrate(int64_t budgetNs);
+
+    Stats getStats() const;
+};
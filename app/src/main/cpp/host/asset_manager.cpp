@@ -0,0 +1,72 @@
+#include "host_assets.h"
+
+#include <android/asset_manager.h>
+
+#include <cstdio>
+#include <vector>
+
+struct AAssetManager {
+    std::string root;
+};
+
+struct AAsset {
+    FILE *file;
+    off64_t length;
+    std::vector<char> buffer;
+};
+
+namespace HostAssets {
+    AAssetManager *open(const std::string &root) {
+        return new AAssetManager{root};
+    }
+
+    void close(AAssetManager *assets) {
+        delete assets;
+    }
+}
+
+AAsset *AAssetManager_open(AAssetManager *mgr, const char *filename, int) {
+    FILE *file = fopen((mgr->root + "/" + filename).c_str(), "rb");
+    if (!file) {
+        return nullptr;
+    }
+    fseeko(file, 0, SEEK_END);
+    off64_t length = ftello(file);
+    fseeko(file, 0, SEEK_SET);
+    return new AAsset{file, length, {}};
+}
+
+int AAsset_read(AAsset *asset, void *buf, size_t count) {
+    size_t n = fread(buf, 1, count, asset->file);
+    return n || !ferror(asset->file) ? (int) n : -1;
+}
+
+off_t AAsset_seek(AAsset *asset, off_t offset, int whence) {
+    return fseeko(asset->file, offset, whence) ? -1 : ftello(asset->file);
+}
+
+off_t AAsset_getLength(AAsset *asset) {
+    return (off_t) asset->length;
+}
+
+off64_t AAsset_getLength64(AAsset *asset) {
+    return asset->length;
+}
+
+const void *AAsset_getBuffer(AAsset *asset) {
+    if (asset->buffer.empty() && asset->length) {
+        asset->buffer.resize((size_t) asset->length);
+        if (fseeko(asset->file, 0, SEEK_SET) ||
+            fread(asset->buffer.data(), 1, asset->buffer.size(), asset->file) !=
+            asset->buffer.size()) {
+            asset->buffer.clear();
+            return nullptr;
+        }
+    }
+    return asset->buffer.data();
+}
+
+void AAsset_close(AAsset *asset) {
+    fclose(asset->file);
+    delete asset;
+}
@@ -0,0 +1,33 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+#include "animation_set.h"
+
+/*
+ * Tracks evaluated per millisecond: range(0) looping tracks, alternating
+ * two-key tweens and eight-key Hermite curves, advanced one 60 Hz frame
+ * per iteration.
+ */
+
+static void BM_AnimationUpdate(benchmark::State &state) {
+    const float times[] = {0, 0.25f, 0.5f, 0.75f, 1, 1.5f, 2, 3};
+    const float keys[] = {0, 1, 0.5f, 2, 1, 3, 2, 0};
+    const float tangents[] = {0, 1, -1, 2, 0, 1, -2, 0};
+    auto count = (uint32_t) state.range(0);
+    AnimationSet animations;
+    for (uint32_t i = 0; i < count; i++) {
+        auto id = i % 2 ? animations.addHermite(times, keys, tangents, 8, true)
+                        : animations.addTween(0, 1, 1 + (float) (i % 7), true);
+        animations.setTime(id, (float) i * 0.013f);
+    }
+    for (auto _: state) {
+        animations.update(1.0f / 60);
+        benchmark::DoNotOptimize(animations.value(count - 1));
+    }
+    // Thousands per second, i.e. tracks per millisecond.
+    state.counters["tracks_per_ms"] = benchmark::Counter(
+            (double) state.iterations() * count / 1000, benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_AnimationUpdate)->Arg(64)->Arg(4096)->Arg(1 << 18);
@@ -0,0 +1,47 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "audio_mixer.h"
+
+/*
+ * Voices mixed per millisecond at a 48 kHz output: each item is one voice
+ * rendering one 192-frame burst (4 ms of audio). range(0) is the source
+ * rate, range(1) the resampler, range(2) the number of channels.
+ */
+
+static void BM_MixVoices(benchmark::State &state) {
+    const uint32_t burst = 192, voices = 32;
+    auto rate = (uint32_t) state.range(0);
+    auto resampler = (Resampler) state.range(1);
+    auto channels = (uint16_t) state.range(2);
+    std::vector<int16_t> samples(rate * channels);
+    for (size_t i = 0; i < samples.size(); i++) {
+        samples[i] = (int16_t) (std::sin((float) i * 0.01f) * 20000);
+    }
+    AudioClip clip{samples.data(), rate, channels, SampleFormat::Int16, rate};
+    AudioMixer mixer(48000);
+    std::vector<AudioMixer::Voice> playing(voices);
+    for (uint32_t v = 0; v < voices; v++) {
+        mixer.start(playing[v], &clip, true, resampler);
+        AudioMixer::setGainPan(playing[v], 1.0f / voices, (float) v / voices * 2 - 1);
+        // Spread the voices over the clip.
+        playing[v].position = (uint64_t) (v * rate / voices) << 32;
+    }
+    std::vector<float> out(burst * 2);
+    for (auto _: state) {
+        std::fill(out.begin(), out.end(), 0.0f);
+        for (auto &voice: playing) {
+            mixer.mix(voice, out.data(), burst);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    // Thousands per second, i.e. voices per millisecond.
+    state.counters["voices_per_ms"] = benchmark::Counter(
+            (double) state.iterations() * voices / 1000, benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_MixVoices)
+        ->ArgsProduct({{48000, 44100}, {(int) Resampler::Linear, (int) Resampler::Sinc}, {1, 2}});
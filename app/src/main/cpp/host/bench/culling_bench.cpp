@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "culling.h"
+
+/*
+ * Objects culled per microsecond for each test, over range(0) objects
+ * scattered across twice the viewport in each direction, so about a
+ * quarter of them are visible.
+ */
+
+namespace {
+    struct Scatter {
+        std::vector<float> x, y, z, x1, y1, radius;
+        std::vector<uint32_t> out;
+
+        explicit Scatter(size_t n) : x(n), y(n), z(n), x1(n), y1(n), radius(n), out(n) {
+            std::mt19937 rng(1);
+            std::uniform_real_distribution<float> u(-0.5f, 1.5f), size(0, 16);
+            for (size_t i = 0; i < n; i++) {
+                x[i] = u(rng) * 1080;
+                y[i] = u(rng) * 1920;
+                z[i] = -u(rng) * 100 - 1;
+                x1[i] = x[i] + size(rng);
+                y1[i] = y[i] + size(rng);
+                radius[i] = size(rng) * 0.05f;
+            }
+        }
+    };
+
+    const Viewport2D view{0, 0, 1080, 1920};
+
+    void perMicrosecond(benchmark::State &state, size_t n) {
+        // Millionths per second, i.e. objects per microsecond.
+        state.counters["objects_per_us"] = benchmark::Counter(
+                (double) state.iterations() * (double) n / 1e6, benchmark::Counter::kIsRate);
+    }
+}
+
+static void BM_CullPoints2D(benchmark::State &state) {
+    auto n = (size_t) state.range(0);
+    Scatter s(n);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(Culling::points2D(s.x.data(), s.y.data(), n, 2, view,
+                                                   s.out.data()));
+    }
+    perMicrosecond(state, n);
+}
+
+BENCHMARK(BM_CullPoints2D)->Arg(16384)->Arg(1 << 20);
+
+static void BM_CullAabbs2D(benchmark::State &state) {
+    auto n = (size_t) state.range(0);
+    Scatter s(n);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(Culling::aabbs2D(s.x.data(), s.y.data(), s.x1.data(),
+                                                  s.y1.data(), n, view, s.out.data()));
+    }
+    perMicrosecond(state, n);
+}
+
+BENCHMARK(BM_CullAabbs2D)->Arg(16384)->Arg(1 << 20);
+
+static void BM_CullSpheres3D(benchmark::State &state) {
+    auto n = (size_t) state.range(0);
+    Scatter s(n);
+    // Orthographic view of the scatter's x/y range, near 1, far 101.
+    const float m[16] = {2.0f / 1080, 0, 0, 0,
+                         0, 2.0f / 1920, 0, 0,
+                         0, 0, -0.02f, 0,
+                         -1, -1, -1.02f, 1};
+    auto frustum = Frustum::fromMatrix(m);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(Culling::spheres3D(s.x.data(), s.y.data(), s.z.data(),
+                                                    s.radius.data(), n, frustum,
+                                                    s.out.data()));
+    }
+    perMicrosecond(state, n);
+}
+
+BENCHMARK(BM_CullSpheres3D)->Arg(16384)->Arg(1 << 20);
@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "entity_world.h"
+
+/*
+ * One frame of entity motion (integrate, spin, wrap to the window) at the
+ * app's population and at a million entities, against the same work on
+ * an array of structs.
+ */
+
+namespace {
+    const float width = 1080, height = 1920;
+
+    MotionDesc motionFor(uint32_t i) {
+        float heading = (float) i * 0.618034f;
+        return MotionDesc{(float) (i % 1024), (float) (i / 1024 % 1920), std::cos(heading) * 50,
+                          std::sin(heading) * 50, heading, 0.5f};
+    }
+
+    struct MovingObject {
+        float x, y, vx, vy, angle, spin;
+        uint32_t kind;
+        bool alive;
+    };
+}
+
+static void BM_EntityWorldUpdate(benchmark::State &state) {
+    EntityWorld world;
+    auto count = (size_t) state.range(0);
+    world.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        world.spawn(motionFor(i));
+    }
+    for (auto _: state) {
+        world.update(1.0f / 60);
+        world.wrap(width, height, 0, count);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_EntityWorldUpdate)->Arg(16 * 1024)->Arg(1 << 20);
+
+static void BM_ArrayOfStructsUpdate(benchmark::State &state) {
+    std::vector<MovingObject> objects;
+    for (uint32_t i = 0; i < state.range(0); i++) {
+        auto d = motionFor(i);
+        objects.push_back({d.x, d.y, d.vx, d.vy, d.angle, d.spin, 0, true});
+    }
+    const float dt = 1.0f / 60, twoPi = 6.28318531f;
+    for (auto _: state) {
+        for (auto &o: objects) {
+            o.x += o.vx * dt;
+            o.y += o.vy * dt;
+            float a = o.angle + o.spin * dt;
+            o.angle = a - twoPi * std::floor(a / twoPi);
+            o.x -= width * std::floor(o.x / width);
+            o.y -= height * std::floor(o.y / height);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ArrayOfStructsUpdate)->Arg(16 * 1024)->Arg(1 << 20);
@@ -0,0 +1,175 @@
+#include <benchmark/benchmark.h>
+
+#include <android/input.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+
+#include "gl_stub.h"
+#include "gpu_resources.h"
+#include "host_sensors.h"
+#include "job_system.h"
+#include "logging.h"
+#include "scene.h"
+#include "sensor_events.h"
+
+/*
+ * The engine's hot paths, as PerfCounters times them on the device
+ * (perf_counters.h), on the same Scene over the GL stubs: touch input,
+ * sensor draining, the animate step, state save and restore, draw command
+ * recording and logging. The window is 1080x1920 and the world holds the
+ * engine's 16k entities.
+ */
+
+namespace {
+    /**
+     * A scene the way Engine sets it up, with a second of frames behind it.
+     */
+    struct SceneRig {
+        GpuResources gpu;
+        JobSystem jobs;
+        Scene scene;
+
+        SceneRig() {
+            GlStub::reset();
+            jobs.start();
+            gpu.onContextReady();
+            scene.init(&gpu, &jobs);
+            scene.resize(1080, 1920);
+            scene.initGl();
+            for (uint32_t i = 0; i < 60; i++) {
+                scene.touch(AMOTION_EVENT_ACTION_MOVE, (float) (i * 17 % 1080),
+                            (float) (i * 31 % 1920), 2);
+                scene.update(1.0f / 60);
+                scene.draw();
+            }
+        }
+    };
+
+    /**
+     * Send stderr, where host builds log, to /dev/null while alive.
+     */
+    class QuietStderr {
+    private:
+        int saved;
+
+    public:
+        QuietStderr() {
+            fflush(stderr);
+            saved = dup(STDERR_FILENO);
+            int null = open("/dev/null", O_WRONLY);
+            dup2(null, STDERR_FILENO);
+            close(null);
+        }
+
+        ~QuietStderr() {
+            fflush(stderr);
+            dup2(saved, STDERR_FILENO);
+            close(saved);
+        }
+    };
+}
+
+// FrameLoop::touch() less the audio blip: picking, the flick and the sparks.
+static void BM_HotPath_Input(benchmark::State &state) {
+    SceneRig rig;
+    uint32_t i = 0;
+    for (auto _: state) {
+        float x = (float) (i * 37 % 1080), y = (float) (i * 91 % 1920);
+        rig.scene.touch(i % 8 ? AMOTION_EVENT_ACTION_MOVE : AMOTION_EVENT_ACTION_DOWN, x, y, 0);
+        if (++i % 1024 == 0) {
+            // Let the sparks die out so the pool never saturates.
+            state.PauseTiming();
+            rig.scene.update(2);
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_HotPath_Input);
+
+// range(0) accelerometer readings queued, then drained; posting is included.
+static void BM_HotPath_Sensors(benchmark::State &state) {
+    auto *queue = HostSensors::createQueue();
+    auto n = (uint32_t) state.range(0);
+    float sum = 0;
+    for (auto _: state) {
+        for (uint32_t i = 0; i < n; i++) {
+            HostSensors::post(queue, i, (float) i, 9.8f, 0.1f);
+        }
+        SensorEvents::drain(queue, [&sum](float x, float y, float z) { sum += x + y + z; });
+        benchmark::DoNotOptimize(sum);
+    }
+    HostSensors::destroyQueue(queue);
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK(BM_HotPath_Sensors)->Arg(1)->Arg(8)->Arg(64);
+
+// The update inside Engine::animate(), with the world spread over the job system.
+static void BM_HotPath_Animate(benchmark::State &state) {
+    SceneRig rig;
+    for (auto _: state) {
+        rig.scene.update(1.0f / 60);
+    }
+    state.SetItemsProcessed(state.iterations() * rig.scene.entityCount());
+}
+
+BENCHMARK(BM_HotPath_Animate)->UseRealTime();
+
+static void BM_HotPath_SaveState(benchmark::State &state) {
+    SceneRig rig;
+    size_t size = 0;
+    for (auto _: state) {
+        void *saved = rig.scene.saveState(&size);
+        benchmark::DoNotOptimize(saved);
+        free(saved);
+    }
+}
+
+BENCHMARK(BM_HotPath_SaveState);
+
+static void BM_HotPath_RestoreState(benchmark::State &state) {
+    SceneRig rig;
+    size_t size = 0;
+    void *saved = rig.scene.saveState(&size);
+    for (auto _: state) {
+        rig.scene.restoreState(saved, size);
+        benchmark::ClobberMemory();
+    }
+    free(saved);
+}
+
+BENCHMARK(BM_HotPath_RestoreState);
+
+// Scene::draw(): culling, vertex streaming and the GL calls, into the stubs.
+static void BM_HotPath_CommandRecording(benchmark::State &state) {
+    SceneRig rig;
+    auto before = GlStub::counts();
+    for (auto _: state) {
+        rig.scene.draw();
+    }
+    auto after = GlStub::counts();
+    state.counters["draws"] = benchmark::Counter(
+            (double) (after.drawCalls - before.drawCalls), benchmark::Counter::kAvgIterations);
+    state.counters["vertices"] = benchmark::Counter(
+            (double) (after.drawnVertices - before.drawnVertices),
+            benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_HotPath_CommandRecording);
+
+// FrameLoop::accelerometer()'s log line, formatted and written to /dev/null.
+static void BM_HotPath_Log(benchmark::State &state) {
+    QuietStderr quiet;
+    float x = 0.25f;
+    for (auto _: state) {
+        LOGI("accelerometer: x=%f y=%f z=%f", x, 9.8f, 0.1f);
+        x += 0.5f;
+    }
+}
+
+BENCHMARK(BM_HotPath_Log);
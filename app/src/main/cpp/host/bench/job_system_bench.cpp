@@ -0,0 +1,59 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+
+#include "entity_world.h"
+#include "job_system.h"
+
+/*
+ * Thread scaling: one frame of 1M-entity motion split into 16k-entity jobs,
+ * run by 1..N participants (the benchmark thread plus N-1 workers). N goes
+ * up to the core count, and at least to 4.
+ */
+
+static void BM_JobSystemScaling(benchmark::State &state) {
+    const uint32_t count = 1 << 20, grain = 16 * 1024;
+    EntityWorld world;
+    world.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        float heading = (float) i * 0.618034f;
+        world.spawn({(float) (i % 1024), (float) (i / 1024), std::cos(heading) * 50,
+                     std::sin(heading) * 50, heading, 0.5f});
+    }
+    JobSystem jobs;
+    jobs.start((uint32_t) state.range(0));
+    auto body = [&world](uint32_t begin, uint32_t end) {
+        world.update(1.0f / 60, begin, end);
+        world.wrap(1080, 1920, begin, end);
+    };
+    for (auto _: state) {
+        JobCounter done;
+        jobs.parallelFor(count, grain, body, &done);
+        jobs.wait(&done);
+    }
+    jobs.stop();
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(BM_JobSystemScaling)
+        ->DenseRange(1, std::max(4, (int) std::thread::hardware_concurrency()))
+        ->UseRealTime();
+
+// Dispatch overhead: empty jobs, so only submit, steal and wait are timed.
+static void BM_JobSystemEmptyJobs(benchmark::State &state) {
+    JobSystem jobs;
+    jobs.start((uint32_t) state.range(0));
+    auto body = [](uint32_t, uint32_t) {};
+    for (auto _: state) {
+        JobCounter done;
+        jobs.parallelFor(1024, 1, body, &done);
+        jobs.wait(&done);
+    }
+    jobs.stop();
+    state.SetItemsProcessed(state.iterations() * 1024);
+}
+
+BENCHMARK(BM_JobSystemEmptyJobs)->DenseRange(1, 4)->UseRealTime();
@@ -0,0 +1,40 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+#include "particle_system.h"
+
+/*
+ * Particles updated per millisecond for each instruction set this build
+ * supports, at the engine's pool size and at 1M. Lifetimes are long enough
+ * that nothing expires, so every iteration updates the whole pool.
+ */
+
+static void BM_ParticleUpdate(benchmark::State &state) {
+    auto isa = (ParticleIsa) state.range(0);
+    auto count = (size_t) state.range(1);
+    ParticleSystem particles(count);
+    while (particles.size() < count) {
+        particles.emit(count, 540, 960, 300, 1e9f);
+    }
+    for (auto _: state) {
+        particles.update(1.0f / 60, 0, 600, isa);
+        benchmark::ClobberMemory();
+    }
+    // Thousands per second, i.e. particles per millisecond.
+    state.counters["particles_per_ms"] = benchmark::Counter(
+            (double) state.iterations() * (double) count / 1000, benchmark::Counter::kIsRate);
+    state.SetLabel(isa == ParticleIsa::Scalar ? "scalar" : isa == ParticleIsa::Sse2 ? "sse2"
+                                                                                    : "neon");
+}
+
+// Only the instruction sets this build has a path for.
+static void particleArgs(benchmark::internal::Benchmark *b) {
+    for (auto isa: {ParticleIsa::Scalar, ParticleIsa::Sse2, ParticleIsa::Neon}) {
+        if (ParticleSystem::supports(isa)) {
+            b->Args({(int) isa, 16384})->Args({(int) isa, 1 << 20});
+        }
+    }
+}
+
+BENCHMARK(BM_ParticleUpdate)->Apply(particleArgs);
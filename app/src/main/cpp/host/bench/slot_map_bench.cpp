@@ -0,0 +1,220 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "slot_map.h"
+
+/*
+ * SlotMap against the two containers it replaces: an unordered_map keyed
+ * by id, and a vector of individually allocated objects. Each benchmark
+ * takes the element count as its argument.
+ */
+
+namespace {
+    struct Body {
+        float x, y, vx, vy;
+    };
+
+    Body bodyFor(uint32_t i) {
+        return Body{(float) i, (float) (i * 3), 1, -1};
+    }
+
+    /**
+     * Lookup order shared by all containers: every element once, shuffled.
+     */
+    std::vector<uint32_t> shuffledOrder(size_t n) {
+        std::vector<uint32_t> order(n);
+        for (uint32_t i = 0; i < n; i++) {
+            order[i] = i;
+        }
+        std::shuffle(order.begin(), order.end(), std::mt19937(42));
+        return order;
+    }
+
+    /**
+     * Individually allocated bodies, linked in a shuffled order as they
+     * end up after objects come and go.
+     */
+    struct PointerVector {
+        std::vector<std::unique_ptr<Body>> storage;
+        std::vector<Body *> items;
+
+        explicit PointerVector(size_t n) {
+            for (uint32_t i = 0; i < n; i++) {
+                storage.push_back(std::make_unique<Body>(bodyFor(i)));
+            }
+            for (uint32_t i: shuffledOrder(n)) {
+                items.push_back(storage[i].get());
+            }
+        }
+    };
+}
+
+static void BM_SlotMapIterate(benchmark::State &state) {
+    SlotMap<Body> map;
+    for (uint32_t i = 0; i < state.range(0); i++) {
+        map.insert(bodyFor(i));
+    }
+    for (auto _: state) {
+        for (auto &b: map) {
+            b.x += b.vx;
+            b.y += b.vy;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_SlotMapIterate)->Range(1 << 10, 1 << 18);
+
+static void BM_UnorderedMapIterate(benchmark::State &state) {
+    std::unordered_map<uint32_t, Body> map;
+    for (uint32_t i = 0; i < state.range(0); i++) {
+        map.emplace(i, bodyFor(i));
+    }
+    for (auto _: state) {
+        for (auto &entry: map) {
+            entry.second.x += entry.second.vx;
+            entry.second.y += entry.second.vy;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_UnorderedMapIterate)->Range(1 << 10, 1 << 18);
+
+static void BM_PointerVectorIterate(benchmark::State &state) {
+    PointerVector bodies((size_t) state.range(0));
+    for (auto _: state) {
+        for (auto *b: bodies.items) {
+            b->x += b->vx;
+            b->y += b->vy;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_PointerVectorIterate)->Range(1 << 10, 1 << 18);
+
+static void BM_SlotMapLookup(benchmark::State &state) {
+    SlotMap<Body> map;
+    std::vector<SlotHandle> handles;
+    for (uint32_t i = 0; i < state.range(0); i++) {
+        handles.push_back(map.insert(bodyFor(i)));
+    }
+    auto order = shuffledOrder(handles.size());
+    for (auto _: state) {
+        float sum = 0;
+        for (uint32_t i: order) {
+            sum += map.get(handles[i])->x;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_SlotMapLookup)->Range(1 << 10, 1 << 18);
+
+static void BM_UnorderedMapLookup(benchmark::State &state) {
+    std::unordered_map<uint32_t, Body> map;
+    for (uint32_t i = 0; i < state.range(0); i++) {
+        map.emplace(i, bodyFor(i));
+    }
+    auto order = shuffledOrder(map.size());
+    for (auto _: state) {
+        float sum = 0;
+        for (uint32_t i: order) {
+            sum += map.find(i)->second.x;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_UnorderedMapLookup)->Range(1 << 10, 1 << 18);
+
+static void BM_PointerVectorLookup(benchmark::State &state) {
+    PointerVector bodies((size_t) state.range(0));
+    auto order = shuffledOrder(bodies.items.size());
+    for (auto _: state) {
+        float sum = 0;
+        for (uint32_t i: order) {
+            sum += bodies.items[i]->x;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_PointerVectorLookup)->Range(1 << 10, 1 << 18);
+
+// One erase and one insert per item, at a steady size.
+static void BM_SlotMapChurn(benchmark::State &state) {
+    SlotMap<Body> map;
+    std::vector<SlotHandle> handles;
+    for (uint32_t i = 0; i < state.range(0); i++) {
+        handles.push_back(map.insert(bodyFor(i)));
+    }
+    auto order = shuffledOrder(handles.size());
+    for (auto _: state) {
+        for (uint32_t i: order) {
+            map.erase(handles[i]);
+            handles[i] = map.insert(bodyFor(i));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_SlotMapChurn)->Range(1 << 10, 1 << 18);
+
+static void BM_UnorderedMapChurn(benchmark::State &state) {
+    std::unordered_map<uint32_t, Body> map;
+    uint32_t nextKey = 0;
+    std::vector<uint32_t> keys;
+    for (; nextKey < state.range(0); nextKey++) {
+        map.emplace(nextKey, bodyFor(nextKey));
+        keys.push_back(nextKey);
+    }
+    auto order = shuffledOrder(keys.size());
+    for (auto _: state) {
+        for (uint32_t i: order) {
+            map.erase(keys[i]);
+            keys[i] = nextKey++;
+            map.emplace(keys[i], bodyFor(i));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_UnorderedMapChurn)->Range(1 << 10, 1 << 18);
+
+static void BM_PointerVectorChurn(benchmark::State &state) {
+    std::vector<Body *> items;
+    for (uint32_t i = 0; i < state.range(0); i++) {
+        items.push_back(new Body(bodyFor(i)));
+    }
+    auto order = shuffledOrder(items.size());
+    for (auto _: state) {
+        for (uint32_t i: order) {
+            // Swap-and-pop, then append: every other reference to the
+            // moved pointer's position is now wrong, which handles avoid.
+            delete items[i];
+            items[i] = items.back();
+            items.pop_back();
+            items.push_back(new Body(bodyFor(i)));
+        }
+    }
+    for (auto *b: items) {
+        delete b;
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_PointerVectorChurn)->Range(1 << 10, 1 << 18);
@@ -0,0 +1,95 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "spatial_grid.h"
+
+/*
+ * One frame of the touch grid at scale: 100k points drifting at up to
+ * 60 px/s over a 1080x1920 window, re-filed as loose boxes, then 1k
+ * radius queries. Items are queries.
+ */
+
+namespace {
+    const uint32_t objects = 100000, queries = 1000;
+    const float width = 1080, height = 1920;
+
+    struct Points {
+        std::vector<float> x, y, vx, vy;
+
+        Points() : x(objects), y(objects), vx(objects), vy(objects) {
+            for (uint32_t i = 0; i < objects; i++) {
+                float a = (float) i * 0.618034f;
+                x[i] = std::fmod((float) i * 7.31f, width);
+                y[i] = std::fmod((float) i * 3.17f, height);
+                vx[i] = std::cos(a) * 60;
+                vy[i] = std::sin(a) * 60;
+            }
+        }
+
+        void step(float dt) {
+            for (uint32_t i = 0; i < objects; i++) {
+                x[i] += vx[i] * dt;
+                y[i] += vy[i] * dt;
+                x[i] = x[i] < 0 ? x[i] + width : x[i] >= width ? x[i] - width : x[i];
+                y[i] = y[i] < 0 ? y[i] + height : y[i] >= height ? y[i] - height : y[i];
+            }
+        }
+    };
+
+    size_t runQueries(SpatialGrid &grid, uint32_t frame, uint32_t *out) {
+        size_t hits = 0;
+        for (uint32_t q = 0; q < queries; q++) {
+            uint32_t k = frame * queries + q;
+            hits += grid.queryRadius((float) (k * 37 % 1080), (float) (k * 91 % 1920), 48, out, 64);
+        }
+        return hits;
+    }
+}
+
+static void BM_SpatialGridFrame(benchmark::State &state) {
+    Points points;
+    SpatialGrid grid;
+    grid.init(0, 0, width, height, 64);
+    grid.resize(objects);
+    grid.updatePoints(points.x.data(), points.y.data(), objects, 16);
+    grid.commit();
+    uint32_t out[64];
+    uint32_t frame = 0;
+    for (auto _: state) {
+        state.PauseTiming();
+        points.step(1.0f / 60);
+        state.ResumeTiming();
+        grid.updatePoints(points.x.data(), points.y.data(), objects, 16);
+        grid.commit();
+        benchmark::DoNotOptimize(runQueries(grid, frame++, out));
+    }
+    state.SetItemsProcessed(state.iterations() * queries);
+}
+
+BENCHMARK(BM_SpatialGridFrame)->Unit(benchmark::kMicrosecond);
+
+// The same frame with exact point boxes re-set every frame, as before.
+static void BM_SpatialGridFrameExact(benchmark::State &state) {
+    Points points;
+    SpatialGrid grid;
+    grid.init(0, 0, width, height, 64);
+    grid.resize(objects);
+    uint32_t out[64];
+    uint32_t frame = 0;
+    for (auto _: state) {
+        state.PauseTiming();
+        points.step(1.0f / 60);
+        state.ResumeTiming();
+        for (uint32_t i = 0; i < objects; i++) {
+            grid.setBounds(i, Aabb{points.x[i], points.y[i], points.x[i], points.y[i]});
+        }
+        grid.commit();
+        benchmark::DoNotOptimize(runQueries(grid, frame++, out));
+    }
+    state.SetItemsProcessed(state.iterations() * queries);
+}
+
+BENCHMARK(BM_SpatialGridFrameExact)->Unit(benchmark::kMicrosecond);
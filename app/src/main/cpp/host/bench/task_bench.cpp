@@ -0,0 +1,38 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+#include "task.h"
+
+/*
+ * Resume cost: range(0) tasks each suspended on nextFrame(); one tick
+ * resumes every one of them once, so items are resumptions.
+ */
+
+static Task frameLoop(Scheduler &scheduler, const bool &stop) {
+    while (!stop) {
+        co_await scheduler.nextFrame();
+    }
+}
+
+static void BM_TaskResume(benchmark::State &state) {
+    auto count = (uint32_t) state.range(0);
+    Scheduler scheduler;
+    scheduler.init(nullptr, count);
+    bool stop = false;
+    for (uint32_t i = 0; i < count; i++) {
+        scheduler.spawn(frameLoop(scheduler, stop));
+    }
+    int64_t now = 0;
+    scheduler.tick(now);
+    uint64_t before = scheduler.getResumes();
+    for (auto _: state) {
+        now += 16666667;
+        scheduler.tick(now);
+    }
+    state.SetItemsProcessed((int64_t) (scheduler.getResumes() - before));
+    stop = true;
+    scheduler.tick(now);
+}
+
+BENCHMARK(BM_TaskResume)->Arg(1)->Arg(16)->Arg(256);
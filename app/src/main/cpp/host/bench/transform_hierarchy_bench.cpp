@@ -0,0 +1,40 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "transform_hierarchy.h"
+
+/*
+ * update() over 100k nodes in a forest of 1k four-level trees, with
+ * range(0) percent of the nodes given a new local transform each frame.
+ * Items are nodes in the hierarchy.
+ */
+
+static void BM_TransformUpdate(benchmark::State &state) {
+    const uint32_t nodes = 100000;
+    TransformHierarchy tree;
+    std::vector<TransformHierarchy::NodeId> ids;
+    ids.reserve(nodes);
+    for (uint32_t i = 0; i < nodes; i++) {
+        // Node i hangs under i / 4 within its tree of 100, so depth stays small.
+        uint32_t inTree = i % 100;
+        auto parent = inTree ? ids[i - inTree + (inTree - 1) / 4] : TransformHierarchy::none;
+        ids.push_back(tree.create(parent));
+        tree.setLocal(ids.back(), (float) inTree, 1, 0.01f * (float) i, 1);
+    }
+    tree.update();
+    auto stride = (uint32_t) (100 / state.range(0));
+    uint32_t frame = 0;
+    for (auto _: state) {
+        frame++;
+        for (uint32_t i = frame % stride; i < nodes; i += stride) {
+            tree.setLocal(ids[i], (float) frame, 1, 0.01f * (float) frame, 1);
+        }
+        tree.update();
+        benchmark::DoNotOptimize(tree.worldOf(ids[nodes - 1]));
+    }
+    state.SetItemsProcessed(state.iterations() * nodes);
+}
+
+BENCHMARK(BM_TransformUpdate)->Arg(1)->Arg(10)->Arg(100)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,161 @@
+/*
+ * Null EGL and counting GLES1 for host builds: enough for modules that
+ * look extensions up at run time, which then take their no-extension
+ * paths, and for the GPU resource managers' and Scene's tests and
+ * benchmarks.
+ */
+
+#include "gl_stub.h"
+
+#include <EGL/egl.h>
+#include <GLES/gl.h>
+
+#include <unordered_map>
+#include <vector>
+
+#include "gpu_resources.h"
+
+namespace {
+    // Live objects by name; textures with the bytes of each level.
+    typedef std::unordered_map<GLuint, std::vector<size_t>> Objects;
+
+    GlStub::Counts tally{};
+    Objects textures, buffers;
+    GLuint nextName = 1;
+    GLuint boundTexture = 0;
+
+    void gen(Objects &live, GLsizei n, GLuint *names) {
+        for (GLsizei i = 0; i < n; i++) {
+            names[i] = nextName++;
+            live[names[i]];
+        }
+    }
+
+    void remove(Objects &live, GLsizei n, const GLuint *names) {
+        for (GLsizei i = 0; i < n; i++) {
+            // Like GL, 0 is ignored.
+            if (names[i] && !live.erase(names[i])) {
+                tally.badDeletes++;
+            }
+            if (names[i] == boundTexture && &live == &textures) {
+                boundTexture = 0;
+            }
+        }
+    }
+}
+
+GlStub::Counts GlStub::counts() {
+    auto c = tally;
+    c.liveTextures = (uint32_t) textures.size();
+    c.liveBuffers = (uint32_t) buffers.size();
+    c.liveTextureBytes = 0;
+    for (auto &texture: textures) {
+        for (auto bytes: texture.second) {
+            c.liveTextureBytes += bytes;
+        }
+    }
+    return c;
+}
+
+void GlStub::reset() {
+    tally = Counts{};
+    textures.clear();
+    buffers.clear();
+    boundTexture = 0;
+}
+
+extern "C" __eglMustCastToProperFunctionPointerType eglGetProcAddress(const char *) {
+    return nullptr;
+}
+
+extern "C" {
+
+void glGenTextures(GLsizei n, GLuint *names) {
+    tally.genTextures += (uint32_t) n;
+    gen(textures, n, names);
+}
+
+void glDeleteTextures(GLsizei n, const GLuint *names) {
+    tally.deleteTextures += (uint32_t) n;
+    remove(textures, n, names);
+}
+
+void glBindTexture(GLenum, GLuint name) {
+    boundTexture = name;
+}
+
+void glTexParameteri(GLenum, GLenum, GLint) {}
+
+void glPixelStorei(GLenum, GLint) {}
+
+void glTexImage2D(GLenum, GLint level, GLint, GLsizei width, GLsizei height, GLint,
+                  GLenum format, GLenum, const void *) {
+    tally.texImages++;
+    auto texture = textures.find(boundTexture);
+    if (texture == textures.end()) {
+        return;
+    }
+    auto &levels = texture->second;
+    if (levels.size() <= (size_t) level) {
+        levels.resize((size_t) level + 1);
+    }
+    levels[level] = (size_t) width * height * GpuData::bytesPerPixel(format);
+}
+
+void glGenBuffers(GLsizei n, GLuint *names) {
+    tally.genBuffers += (uint32_t) n;
+    gen(buffers, n, names);
+}
+
+void glDeleteBuffers(GLsizei n, const GLuint *names) {
+    tally.deleteBuffers += (uint32_t) n;
+    remove(buffers, n, names);
+}
+
+void glBindBuffer(GLenum, GLuint) {}
+
+void glBufferData(GLenum, GLsizeiptr size, const void *, GLenum) {
+    tally.bufferUploads++;
+    tally.bufferBytes += (size_t) size;
+}
+
+void glBufferSubData(GLenum, GLintptr, GLsizeiptr, const void *) {
+    tally.bufferUploads++;
+}
+
+void glEnableClientState(GLenum) {}
+
+void glDisableClientState(GLenum) {}
+
+void glVertexPointer(GLint, GLenum, GLsizei, const void *) {}
+
+void glColorPointer(GLint, GLenum, GLsizei, const void *) {}
+
+void glDrawArrays(GLenum, GLint, GLsizei count) {
+    tally.drawCalls++;
+    tally.drawnVertices += (size_t) count;
+}
+
+void glClearColor(GLfloat, GLfloat, GLfloat, GLfloat) {}
+
+void glClear(GLbitfield) {}
+
+void glHint(GLenum, GLenum) {}
+
+void glEnable(GLenum) {}
+
+void glDisable(GLenum) {}
+
+void glShadeModel(GLenum) {}
+
+void glMatrixMode(GLenum) {}
+
+void glLoadMatrixf(const GLfloat *) {}
+
+void glLoadIdentity() {}
+
+void glBlendFunc(GLenum, GLenum) {}
+
+void glPointSize(GLfloat) {}
+
+}
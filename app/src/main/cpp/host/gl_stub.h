@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Counting GLES1 stubs for host tests and benchmarks, which have no
+ * context. Object names are handed out and tracked so tests can check
+ * for leaks and double deletes; uploads are counted, not stored, along
+ * with the size of each texture level, and so are draws. Fixed-function
+ * state calls are accepted and ignored.
+ * eglGetProcAddress() finds no extensions.
+ */
+namespace GlStub {
+    struct Counts {
+        uint32_t genTextures;
+        uint32_t deleteTextures;
+        uint32_t texImages;
+        uint32_t genBuffers;
+        uint32_t deleteBuffers;
+        uint32_t bufferUploads;
+        size_t bufferBytes;
+        uint32_t drawCalls;
+        size_t drawnVertices;
+        // Deletes of names that were not live.
+        uint32_t badDeletes;
+        uint32_t liveTextures;
+        uint32_t liveBuffers;
+        // Every level of every live texture, at GpuData::bytesPerPixel().
+        size_t liveTextureBytes;
+    };
+
+    Counts counts();
+
+    /**
+     * A fresh context: every object is gone and the counters restart.
+     */
+    void reset();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+/*
+ * Host stand-in for the NDK's <android/asset_manager.h>: the subset of the
+ * AAsset API the engine uses, backed by files under a directory (see
+ * host_assets.h).
+ */
+
+#include <sys/types.h>
+
+#include <cstddef>
+
+struct AAssetManager;
+struct AAsset;
+
+enum {
+    AASSET_MODE_UNKNOWN = 0,
+    AASSET_MODE_RANDOM = 1,
+    AASSET_MODE_STREAMING = 2,
+    AASSET_MODE_BUFFER = 3,
+};
+
+extern "C" {
+
+AAsset *AAssetManager_open(AAssetManager *mgr, const char *filename, int mode);
+
+int AAsset_read(AAsset *asset, void *buf, size_t count);
+
+off_t AAsset_seek(AAsset *asset, off_t offset, int whence);
+
+off_t AAsset_getLength(AAsset *asset);
+
+off64_t AAsset_getLength64(AAsset *asset);
+
+/**
+ * @return the whole asset, or nullptr if it cannot be read
+ */
+const void *AAsset_getBuffer(AAsset *asset);
+
+void AAsset_close(AAsset *asset);
+
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+/*
+ * Host stand-in for the NDK's <android/input.h>: the motion event actions
+ * scenarios are written in.
+ */
+
+enum {
+    AMOTION_EVENT_ACTION_MASK = 0xff,
+    AMOTION_EVENT_ACTION_DOWN = 0,
+    AMOTION_EVENT_ACTION_UP = 1,
+    AMOTION_EVENT_ACTION_MOVE = 2,
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+/*
+ * Host stand-in for the NDK's <android/sensor.h>: the event layout and the
+ * queue read, over in-memory queues (see host_sensors.h).
+ */
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+
+struct ASensorEventQueue;
+
+enum {
+    ASENSOR_TYPE_ACCELEROMETER = 1,
+};
+
+typedef struct ASensorVector {
+    float x;
+    float y;
+    float z;
+    int8_t status;
+    uint8_t reserved[3];
+} ASensorVector;
+
+typedef struct ASensorEvent {
+    int32_t version;
+    int32_t sensor;
+    int32_t type;
+    int32_t reserved0;
+    int64_t timestamp;
+    union {
+        float data[16];
+        ASensorVector acceleration;
+    };
+    uint32_t flags;
+    int32_t reserved1[3];
+} ASensorEvent;
+
+extern "C" {
+
+ssize_t ASensorEventQueue_getEvents(ASensorEventQueue *queue, ASensorEvent *events,
+                                    size_t count);
+
+}
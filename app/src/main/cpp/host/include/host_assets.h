@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+
+struct AAssetManager;
+
+/**
+ * Asset managers for host builds: asset names resolve to files under a
+ * directory, standing in for the APK's assets/ folder.
+ */
+namespace HostAssets {
+
+    AAssetManager *open(const std::string &root);
+
+    void close(AAssetManager *assets);
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+struct ASensorEventQueue;
+
+/**
+ * Sensor event queues for host builds: readings posted here come back out
+ * of ASensorEventQueue_getEvents() in order.
+ */
+namespace HostSensors {
+
+    ASensorEventQueue *createQueue();
+
+    void destroyQueue(ASensorEventQueue *queue);
+
+    /**
+     * Queue an accelerometer reading.
+     */
+    void post(ASensorEventQueue *queue, int64_t timestampNs, float x, float y, float z);
+
+}
@@ -0,0 +1,254 @@
+/*
+ * Headless replay runner: plays perf scenarios (see session_replay.h)
+ * through the engine's own frame loop (frame_loop.h) on Linux: the events
+ * due each frame, thermal sampling, tasks, the Scene update, rehydration,
+ * drawing, the "swap" and texture streaming, timed with PerfCounters as on
+ * a device. Touch blips go to the host audio sink, which discards them.
+ *
+ *     engine_replay [--fast] [--size <w>x<h>] <scenario>...
+ *
+ * engine_replay_mesa renders into a pbuffer on Mesa's surfaceless EGL
+ * platform, and waits for the GPU in place of the swap; engine_replay
+ * draws into the GL stubs and measures the CPU side only. Scenarios run
+ * one after another, each on a fresh Scene, and each logs a replay-record
+ * line and a perf-record labelled with its name, as the engine does, so
+ * tools/perf_compare.py --label <scenario> reads the output.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <string>
+
+#if ENGINE_REPLAY_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#else
+#include "gl_stub.h"
+#endif
+
+#include "audio_engine.h"
+#include "engine_clock.h"
+#include "frame_loop.h"
+#include "gpu_resources.h"
+#include "host_assets.h"
+#include "job_system.h"
+#include "logging.h"
+#include "perf_counters.h"
+#include "scene.h"
+#include "session_replay.h"
+#include "task.h"
+#include "texture_residency.h"
+#include "thermal_governor.h"
+
+namespace {
+#if ENGINE_REPLAY_EGL
+
+    /**
+     * An offscreen GLES1 context on Mesa; surfaceless, so no display server
+     * or GPU device is needed.
+     */
+    class Surface {
+    private:
+        EGLDisplay display = EGL_NO_DISPLAY;
+        EGLSurface surface = EGL_NO_SURFACE;
+        EGLContext context = EGL_NO_CONTEXT;
+
+    public:
+        ~Surface() { close(); }
+
+        bool open(int32_t width, int32_t height) {
+            auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress(
+                    "eglGetPlatformDisplayEXT");
+            if (getPlatformDisplay) {
+                display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY,
+                                             nullptr);
+            }
+            if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+                LOGW("replay: no surfaceless EGL display");
+                return false;
+            }
+            const EGLint configAttr[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+                                         EGL_RENDERABLE_TYPE, EGL_OPENGL_ES_BIT,
+                                         EGL_BLUE_SIZE, 8,
+                                         EGL_GREEN_SIZE, 8,
+                                         EGL_RED_SIZE, 8,
+                                         EGL_NONE};
+            EGLConfig config = nullptr;
+            EGLint numConfigs = 0;
+            if (!eglChooseConfig(display, configAttr, &config, 1, &numConfigs) || !numConfigs) {
+                LOGW("replay: no GLES1 pbuffer config");
+                return false;
+            }
+            const EGLint surfaceAttr[] = {EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE};
+            const EGLint contextAttr[] = {EGL_CONTEXT_CLIENT_VERSION, 1, EGL_NONE};
+            eglBindAPI(EGL_OPENGL_ES_API);
+            surface = eglCreatePbufferSurface(display, config, surfaceAttr);
+            context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttr);
+            if (surface == EGL_NO_SURFACE || context == EGL_NO_CONTEXT ||
+                !eglMakeCurrent(display, surface, surface, context)) {
+                LOGW("replay: unable to make a GLES1 context current");
+                return false;
+            }
+            LOGI("replay: rendering with %s", (const char *) glGetString(GL_RENDERER));
+            return true;
+        }
+
+        /**
+         * A pbuffer has nothing to present: wait for the frame to render.
+         */
+        void swap() {
+            eglSwapBuffers(display, surface);
+            glFinish();
+        }
+
+        void close() {
+            if (display == EGL_NO_DISPLAY) {
+                return;
+            }
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            if (context != EGL_NO_CONTEXT) {
+                eglDestroyContext(display, context);
+            }
+            if (surface != EGL_NO_SURFACE) {
+                eglDestroySurface(display, surface);
+            }
+            eglTerminate(display);
+            display = EGL_NO_DISPLAY;
+        }
+    };
+
+#else
+
+    /**
+     * The GL stubs: draw calls are counted, nothing is rendered.
+     */
+    class Surface {
+    public:
+        bool open(int32_t, int32_t) {
+            GlStub::reset();
+            LOGI("replay: rendering with the GL stubs");
+            return true;
+        }
+
+        void swap() {}
+    };
+
+#endif
+
+    void sleepUntil(int64_t ns) {
+        timespec t{(time_t) (ns / 1000000000), (long) (ns % 1000000000)};
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, nullptr)) {}
+    }
+
+    /**
+     * What outlives a scenario, in the engine's declaration order: the
+     * governor is sampled by jobs and the frame loop's blips are played by
+     * the output, so both are declared before those.
+     */
+    class Runner {
+    private:
+        Surface &surface;
+        int32_t width, height;
+        ThermalGovernor thermal;
+        FrameLoop frame;
+        AudioEngine audio;
+        JobSystem jobs;
+
+    public:
+        Runner(Surface &target, int32_t targetWidth, int32_t targetHeight)
+                : surface(target), width(targetWidth), height(targetHeight) {
+            jobs.start();
+            audio.open();
+            audio.start();
+            frame.present = [this]() {
+                PerfScope perf(HotPath::Swap);
+                surface.swap();
+            };
+        }
+
+        /**
+         * Engine::animate() for one scenario, from start to end.
+         */
+        bool play(AAssetManager *assets, const std::string &path,
+                  SessionReplay::Pacing pacing) {
+            SessionReplay replay;
+            if (!replay.load(assets, path)) {
+                return false;
+            }
+            GpuResources gpu;
+            TextureResidency textures;
+            Scheduler scheduler;
+            auto scene = std::make_unique<Scene>();
+            gpu.onContextReady();
+            textures.onContextReady();
+            scheduler.init(&jobs);
+            scene->init(&gpu, &jobs);
+            scene->resize(width, height);
+            scene->initGl();
+            frame.init({scene.get(), &gpu, &textures, &thermal, &scheduler, &jobs, &replay,
+                        &audio});
+            frame.audioOutputChanged();
+            frame.setDrawable(true);
+
+            LOGI("replay: playing %s (%s)", replay.getName().c_str(),
+                 pacing == SessionReplay::Pacing::Fast ? "fast" : "recorded timing");
+            replay.start(pacing, monotonicNs());
+            PerfCounters::reset();
+            while (!replay.finished()) {
+                int64_t frameStartNs = monotonicNs();
+                frame.step(frameStartNs);
+                if (pacing == SessionReplay::Pacing::Recorded) {
+                    // Stands in for vsync at 60 Hz.
+                    sleepUntil(frameStartNs + SessionReplay::fastFrameNs);
+                }
+            }
+            replay.report(monotonicNs());
+            PerfCounters::emit(replay.getName().c_str());
+            frame.setDrawable(false);
+            textures.onContextLost();
+            gpu.onContextLost();
+            return true;
+        }
+    };
+}
+
+int main(int argc, char **argv) {
+    auto pacing = SessionReplay::Pacing::Recorded;
+    int32_t width = 1080, height = 1920;
+    int first = 1;
+    for (; first < argc && argv[first][0] == '-'; first++) {
+        if (!strcmp(argv[first], "--fast")) {
+            pacing = SessionReplay::Pacing::Fast;
+        } else if (!strcmp(argv[first], "--size") && first + 1 < argc &&
+                   sscanf(argv[first + 1], "%dx%d", &width, &height) == 2 && width > 0 &&
+                   height > 0) {
+            first++;
+        } else {
+            break;
+        }
+    }
+    if (first == argc || argv[first][0] == '-') {
+        fprintf(stderr, "usage: %s [--fast] [--size <w>x<h>] <scenario>...\n", argv[0]);
+        return 2;
+    }
+#ifdef NDEBUG
+    LOGW("replay: release build; allocation counts need a debug build");
+#endif
+
+    Surface surface;
+    if (!surface.open(width, height)) {
+        return 1;
+    }
+    Runner runner(surface, width, height);
+    // Relative paths are read the way the engine reads assets.
+    auto *assets = HostAssets::open(".");
+    int failed = 0;
+    for (int i = first; i < argc; i++) {
+        failed += runner.play(assets, argv[i], pacing) ? 0 : 1;
+    }
+    HostAssets::close(assets);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,46 @@
+#include "host_sensors.h"
+
+#include <android/sensor.h>
+
+#include <algorithm>
+#include <vector>
+
+struct ASensorEventQueue {
+    std::vector<ASensorEvent> events;
+    // Next event to read; the vector is emptied once it has all been read.
+    size_t head;
+};
+
+namespace HostSensors {
+    ASensorEventQueue *createQueue() {
+        return new ASensorEventQueue{{}, 0};
+    }
+
+    void destroyQueue(ASensorEventQueue *queue) {
+        delete queue;
+    }
+
+    void post(ASensorEventQueue *queue, int64_t timestampNs, float x, float y, float z) {
+        ASensorEvent event{};
+        event.version = sizeof(ASensorEvent);
+        event.type = ASENSOR_TYPE_ACCELEROMETER;
+        event.timestamp = timestampNs;
+        event.acceleration.x = x;
+        event.acceleration.y = y;
+        event.acceleration.z = z;
+        queue->events.push_back(event);
+    }
+}
+
+ssize_t ASensorEventQueue_getEvents(ASensorEventQueue *queue, ASensorEvent *events,
+                                    size_t count) {
+    auto n = std::min(count, queue->events.size() - queue->head);
+    std::copy_n(queue->events.begin() + (ptrdiff_t) queue->head, n, events);
+    queue->head += n;
+    if (queue->head == queue->events.size()) {
+        // Keeps the capacity, so steady posting does not allocate.
+        queue->events.clear();
+        queue->head = 0;
+    }
+    return (ssize_t) n;
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "alloc_guard.h"
+#include "test_util.h"
+
+#ifndef NDEBUG
+
+namespace {
+    struct alignas(64) CacheLine {
+        float values[16];
+    };
+
+    bool aligned(const void *p, size_t align) {
+        return (reinterpret_cast<uintptr_t>(p) & (align - 1)) == 0;
+    }
+}
+
+TEST(AllocGuard, CountsAllocationsInsideFrame) {
+    AllocGuard::beginFrame();
+    delete escape(new int(1));
+    std::vector<int> values(100);
+    escape(values.data());
+    EXPECT_EQ(2u, AllocGuard::endFrame());
+}
+
+TEST(AllocGuard, IgnoresAllocationsOutsideFrame) {
+    delete escape(new int(1));
+    AllocGuard::beginFrame();
+    EXPECT_EQ(0u, AllocGuard::endFrame());
+}
+
+TEST(AllocGuard, CountsOverAlignedAllocations) {
+    AllocGuard::beginFrame();
+    auto *line = escape(new CacheLine);
+    auto *lines = escape(new CacheLine[3]);
+    auto *quiet = escape(new(std::nothrow) CacheLine);
+    auto *aligned4k = escape(static_cast<char *>(operator new(100, std::align_val_t(4096))));
+    EXPECT_EQ(4u, AllocGuard::endFrame());
+    EXPECT_TRUE(aligned(line, 64));
+    EXPECT_TRUE(aligned(lines, 64));
+    EXPECT_TRUE(aligned(quiet, 64));
+    EXPECT_TRUE(aligned(aligned4k, 4096));
+    // Writing the whole block must not trample the header of another.
+    for (auto &value: lines[2].values) {
+        value = 1;
+    }
+    delete line;
+    delete[] lines;
+    operator delete(quiet, std::align_val_t(64), std::nothrow);
+    operator delete(aligned4k, 100, std::align_val_t(4096));
+}
+
+TEST(AllocGuard, OnlyCountsTheFrameThread) {
+    AllocGuard::beginFrame();
+    std::thread([]() { delete escape(new int(2)); }).join();
+    // The std::thread state itself is allocated by this thread.
+    EXPECT_EQ(1u, AllocGuard::endFrame());
+}
+
+TEST(AllocGuardDeathTest, FailFastAbortsOnFrameAllocation) {
+    EXPECT_DEATH({
+        AllocGuard::setFailFast(true);
+        AllocGuard::beginFrame();
+        delete escape(new int(3));
+        AllocGuard::endFrame();
+    }, "");
+}
+
+#endif
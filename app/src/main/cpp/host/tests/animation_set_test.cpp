@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "animation_set.h"
+
+TEST(AnimationSet, TweenRampsAndLoops) {
+    AnimationSet animations;
+    auto track = animations.addTween(0, 1, 2, true);
+    animations.update(0.5f);
+    EXPECT_NEAR(0.25f, animations.value(track), 1e-5f);
+    animations.update(3);
+    EXPECT_NEAR(0.75f, animations.value(track), 1e-5f);
+}
+
+TEST(AnimationSet, ZeroLengthTweenIsAStep) {
+    for (float seconds: {0.0f, -1.0f, NAN}) {
+        for (bool looping: {false, true}) {
+            AnimationSet animations;
+            auto track = animations.addTween(3, 7, seconds, looping);
+            for (int frame = 0; frame < 3; frame++) {
+                animations.update(1.0f / 60);
+                EXPECT_EQ(7.0f, animations.value(track))
+                                    << "seconds " << seconds << " looping " << looping;
+            }
+        }
+    }
+}
+
+TEST(AnimationSet, ZeroLengthKeysStayFinite) {
+    // A repeated key time is a jump: no segment may produce NaN.
+    const float times[] = {0, 1, 1, 2};
+    const float keys[] = {0, 1, 5, 6};
+    const float tangents[] = {1, 1, 1, 1};
+    const float controls[] = {0, 1, 1, 5, 5, 6};
+    AnimationSet animations;
+    auto hermite = animations.addHermite(times, keys, tangents, 4, true);
+    auto bezier = animations.addBezier(times, keys, controls, 4, true);
+    for (int frame = 0; frame < 300; frame++) {
+        animations.update(1.0f / 60);
+        ASSERT_TRUE(std::isfinite(animations.value(hermite))) << "frame " << frame;
+        ASSERT_TRUE(std::isfinite(animations.value(bezier))) << "frame " << frame;
+    }
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "audio_engine.h"
+
+namespace {
+    uint32_t le32(const uint8_t *p) {
+        return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t) p[3] << 24;
+    }
+
+    uint16_t le16(const uint8_t *p) {
+        return (uint16_t) (p[0] | p[1] << 8);
+    }
+
+    std::vector<uint8_t> readFile(const std::string &path) {
+        std::vector<uint8_t> bytes;
+        FILE *f = fopen(path.c_str(), "rb");
+        if (!f) {
+            return bytes;
+        }
+        uint8_t buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+            bytes.insert(bytes.end(), buf, buf + n);
+        }
+        fclose(f);
+        return bytes;
+    }
+
+    struct Tone {
+        std::vector<float> samples = std::vector<float>(4800);
+        AudioClip clip{};
+
+        explicit Tone(uint32_t rate) {
+            for (size_t i = 0; i < samples.size(); i++) {
+                samples[i] = std::sin((float) i * 0.1f);
+            }
+            clip = AudioClip{samples.data(), (uint32_t) samples.size(), 1, SampleFormat::Float,
+                             rate};
+        }
+    };
+}
+
+TEST(AudioEngine, RenderMixesQueuedVoices) {
+    AudioEngine audio;
+    Tone tone(48000);
+    std::vector<float> out(256 * AudioEngine::channelCount, 1);
+    audio.render(out.data(), 256);
+    for (float f: out) {
+        ASSERT_EQ(0.0f, f);
+    }
+    ASSERT_NE(0u, audio.play(&tone.clip, 1, -1));
+    audio.render(out.data(), 256);
+    float left = 0, right = 0;
+    for (size_t i = 0; i < out.size(); i += 2) {
+        left += std::fabs(out[i]);
+        right += std::fabs(out[i + 1]);
+    }
+    EXPECT_GT(left, 10.0f);
+    EXPECT_NEAR(0.0f, right, 1e-3f);
+    EXPECT_EQ(1u, audio.getStats().activeVoices);
+}
+
+TEST(AudioEngine, HostSinkWritesAFloatWav) {
+    auto path = testing::TempDir() + "audio_engine_test.wav";
+    Tone tone(48000);
+    {
+        AudioEngine audio;
+        ASSERT_TRUE(audio.open(path.c_str()));
+        EXPECT_FALSE(audio.maintain());
+        audio.play(&tone.clip, 0.5f);
+        audio.start();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (audio.getStats().callbacks < 10 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        audio.close();
+        EXPECT_GE(audio.getStats().callbacks, 10u);
+    }
+    auto wav = readFile(path);
+    remove(path.c_str());
+    ASSERT_GE(wav.size(), 44u);
+    EXPECT_EQ(0, memcmp(wav.data(), "RIFF", 4));
+    EXPECT_EQ(0, memcmp(wav.data() + 8, "WAVEfmt ", 8));
+    EXPECT_EQ(3, le16(wav.data() + 20));
+    EXPECT_EQ(+AudioEngine::channelCount, le16(wav.data() + 22));
+    EXPECT_EQ(48000u, le32(wav.data() + 24));
+    EXPECT_EQ(32, le16(wav.data() + 34));
+    uint32_t dataBytes = le32(wav.data() + 40);
+    EXPECT_EQ(wav.size() - 44, dataBytes);
+    EXPECT_EQ(wav.size() - 8, le32(wav.data() + 4));
+    EXPECT_GT(dataBytes, 0u);
+    // The tone made it into the file.
+    float peak = 0;
+    for (size_t i = 44; i + 4 <= wav.size(); i += 4) {
+        float f;
+        memcpy(&f, wav.data() + i, 4);
+        peak = std::fmax(peak, std::fabs(f));
+    }
+    EXPECT_GT(peak, 0.1f);
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "audio_mixer.h"
+
+namespace {
+    struct Clip {
+        std::vector<float> samples;
+        AudioClip clip{};
+
+        Clip(uint32_t frames, uint32_t rate) : samples(frames) {
+            for (uint32_t i = 0; i < frames; i++) {
+                samples[i] = std::sin((float) i * 0.05f);
+            }
+            clip = AudioClip{samples.data(), frames, 1, SampleFormat::Float, rate};
+        }
+    };
+
+    double framesAdvanced(uint64_t before, uint64_t after) {
+        return (double) (after - before) / 4294967296.0;
+    }
+}
+
+TEST(AudioMixer, LiveVoicesFollowOutputRateChanges) {
+    Clip clip(48000, 44100);
+    AudioMixer mixer(48000);
+    AudioMixer::Voice voice{};
+    mixer.start(voice, &clip.clip, true, Resampler::Linear);
+    AudioMixer::setGainPan(voice, 1, 0);
+    std::vector<float> out(AudioMixer::blockFrames * 2);
+
+    uint64_t before = voice.position;
+    mixer.mix(voice, out.data(), AudioMixer::blockFrames);
+    EXPECT_NEAR(AudioMixer::blockFrames * 44100.0 / 48000, framesAdvanced(before, voice.position),
+                1e-3);
+
+    // As after the device came back at another rate.
+    mixer.setOutputRate(96000);
+    before = voice.position;
+    mixer.mix(voice, out.data(), AudioMixer::blockFrames);
+    EXPECT_NEAR(AudioMixer::blockFrames * 44100.0 / 96000, framesAdvanced(before, voice.position),
+                1e-3);
+}
+
+TEST(AudioMixer, ClipAtOutputRateIsCopiedThrough) {
+    Clip clip(1024, 48000);
+    AudioMixer mixer(48000);
+    AudioMixer::Voice voice{};
+    mixer.start(voice, &clip.clip, false, Resampler::Sinc);
+    AudioMixer::setGainPan(voice, 1, 1);
+    std::vector<float> out(AudioMixer::blockFrames * 2, 0);
+    ASSERT_TRUE(mixer.mix(voice, out.data(), AudioMixer::blockFrames));
+    for (uint32_t i = 0; i < AudioMixer::blockFrames; i++) {
+        ASSERT_NEAR(clip.samples[i], out[i * 2 + 1], 1e-5f) << "frame " << i;
+    }
+}
+
+TEST(AudioMixer, NonLoopingVoicesEnd) {
+    Clip clip(300, 48000);
+    AudioMixer mixer(48000);
+    AudioMixer::Voice voice{};
+    mixer.start(voice, &clip.clip, false, Resampler::Linear);
+    std::vector<float> out(AudioMixer::blockFrames * 2, 0);
+    EXPECT_TRUE(mixer.mix(voice, out.data(), AudioMixer::blockFrames));
+    EXPECT_FALSE(mixer.mix(voice, out.data(), AudioMixer::blockFrames));
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "audio_stream.h"
+
+namespace {
+    void put32(std::vector<uint8_t> &v, uint32_t x) {
+        for (int i = 0; i < 4; i++) {
+            v.push_back((uint8_t) (x >> (i * 8)));
+        }
+    }
+
+    void put16(std::vector<uint8_t> &v, uint16_t x) {
+        v.push_back((uint8_t) x);
+        v.push_back((uint8_t) (x >> 8));
+    }
+
+    /**
+     * Write a 16-bit stereo WAV of frames samples, each channel a ramp.
+     */
+    std::string writeWav(const char *name, uint32_t rate, uint32_t frames) {
+        std::vector<uint8_t> v;
+        v.insert(v.end(), {'R', 'I', 'F', 'F'});
+        put32(v, 36 + frames * 4);
+        v.insert(v.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+        put32(v, 16);
+        put16(v, 1);
+        put16(v, 2);
+        put32(v, rate);
+        put32(v, rate * 4);
+        put16(v, 4);
+        put16(v, 16);
+        v.insert(v.end(), {'d', 'a', 't', 'a'});
+        put32(v, frames * 4);
+        for (uint32_t i = 0; i < frames; i++) {
+            put16(v, (uint16_t) (int16_t) (i % 1000));
+            put16(v, (uint16_t) (int16_t) -(int) (i % 1000));
+        }
+        auto path = testing::TempDir() + name;
+        FILE *f = fopen(path.c_str(), "wb");
+        fwrite(v.data(), 1, v.size(), f);
+        fclose(f);
+        return path;
+    }
+
+    template<typename F>
+    bool waitFor(F done) {
+        for (int i = 0; i < 2000 && !done(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return done();
+    }
+}
+
+TEST(AudioStream, ReadsBeforeTheFirstFillAreNotUnderruns) {
+    auto path = writeWav("audio_stream_prime.wav", 48000, 48000);
+    AudioStream stream(48000, 0.1f);
+    ASSERT_TRUE(stream.open(nullptr, path.c_str(), false));
+    float out[256 * 2];
+    EXPECT_EQ(0u, stream.read(out, 256));
+    EXPECT_EQ(0u, stream.getStats().underruns);
+
+    EXPECT_TRUE(stream.pump());
+    auto buffered = stream.getStats().bufferedFrames;
+    ASSERT_GT(buffered, 256u);
+    ASSERT_EQ(256u, stream.read(out, 256));
+    EXPECT_EQ(-1 / 32768.0f, out[3]);
+    // Drain the ring without refilling: that one is an underrun.
+    std::vector<float> rest(buffered * 2);
+    EXPECT_EQ(buffered - 256, stream.read(rest.data(), buffered));
+    EXPECT_EQ(1u, stream.getStats().underruns);
+}
+
+TEST(AudioStream, NextFillResamplesToANewOutputRate) {
+    auto path = writeWav("audio_stream_rate.wav", 48000, 4000);
+    AudioStream stream(48000, 0.01f);
+    ASSERT_TRUE(stream.open(nullptr, path.c_str(), false));
+    ASSERT_TRUE(stream.pump());
+    auto buffered = stream.getStats().bufferedFrames;
+    std::vector<float> out(buffered * 2);
+    ASSERT_EQ(buffered, stream.read(out.data(), buffered));
+    // Same rate: one source frame per output frame.
+    EXPECT_FLOAT_EQ(1 / 32768.0f, out[2] - out[0]);
+
+    // The device came back at half the rate: two source frames per output frame.
+    stream.setOutputRate(24000);
+    ASSERT_TRUE(stream.pump());
+    float next[10 * 2];
+    ASSERT_EQ(10u, stream.read(next, 10));
+    for (int i = 1; i < 10; i++) {
+        EXPECT_FLOAT_EQ(2 / 32768.0f, next[i * 2] - next[(i - 1) * 2]) << "frame " << i;
+    }
+}
+
+TEST(AudioStreamer, FillsOnTheIoThread) {
+    auto path = writeWav("audio_stream_thread.wav", 44100, 44100);
+    AudioStream stream(48000, 0.1f);
+    ASSERT_TRUE(stream.open(nullptr, path.c_str(), true));
+    // Hold the I/O thread until add() has returned.
+    std::atomic<bool> release{false};
+    AudioStreamer streamer;
+    streamer.onThreadStart = [&release]() {
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    };
+    streamer.start();
+    streamer.add(&stream);
+    EXPECT_EQ(0u, stream.getStats().bufferedFrames);
+    release = true;
+    EXPECT_TRUE(waitFor([&]() { return stream.getStats().bufferedFrames > 1000; }));
+
+    // Keep reading while the I/O thread refills, then detach mid-stream.
+    std::vector<float> out(480 * 2);
+    for (int i = 0; i < 20; i++) {
+        stream.read(out.data(), 480);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    streamer.remove(&stream);
+    auto before = stream.getStats().bufferedFrames;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(before, stream.getStats().bufferedFrames);
+    EXPECT_GT(stream.getStats().memoryBytes, 0u);
+    streamer.stop();
+}
@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "culling.h"
+
+// The SIMD paths against the obvious loop, including the tail past a
+// multiple of four.
+TEST(Culling, PointsMatchScalar) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> u(-100, 1200);
+    for (size_t n: {0, 1, 3, 4, 5, 1023}) {
+        std::vector<float> x(n), y(n);
+        for (size_t i = 0; i < n; i++) {
+            x[i] = u(rng);
+            y[i] = u(rng);
+        }
+        Viewport2D view{0, 0, 1000, 800};
+        std::vector<uint32_t> out(n), expected;
+        for (uint32_t i = 0; i < n; i++) {
+            if (x[i] + 2 >= 0 && x[i] - 2 <= 1000 && y[i] + 2 >= 0 && y[i] - 2 <= 800) {
+                expected.push_back(i);
+            }
+        }
+        auto count = Culling::points2D(x.data(), y.data(), n, 2, view, out.data());
+        out.resize(count);
+        EXPECT_EQ(expected, out) << "n " << n;
+    }
+}
+
+TEST(Culling, AabbsOverlappingTheViewAreVisible) {
+    const float minX[] = {-10, 50, 200, -30, 90};
+    const float minY[] = {-10, 50, 10, 10, 110};
+    const float maxX[] = {-1, 60, 210, 5, 95};
+    const float maxY[] = {-1, 60, 20, 20, 120};
+    uint32_t out[5];
+    auto count = Culling::aabbs2D(minX, minY, maxX, maxY, 5, Viewport2D{0, 0, 100, 100}, out);
+    ASSERT_EQ(2u, count);
+    EXPECT_EQ(1u, out[0]);
+    EXPECT_EQ(3u, out[1]);
+}
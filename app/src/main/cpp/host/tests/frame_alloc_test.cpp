@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <android/input.h>
+
+#include <cstdint>
+
+#include "alloc_guard.h"
+#include "gl_stub.h"
+#include "gpu_resources.h"
+#include "job_system.h"
+#include "scene.h"
+
+#ifndef NDEBUG
+
+namespace {
+    const int32_t width = 1080, height = 1920;
+
+    /**
+     * The per-frame work of Engine::animate() and drawFrame(), minus the
+     * platform: the engine's Scene over the GL stubs, touched every 10th
+     * frame, then the update and the draw.
+     */
+    class FrameHarness {
+    private:
+        GpuResources gpu;
+        Scene scene;
+        uint32_t frame = 0;
+
+    public:
+        explicit FrameHarness(JobSystem *jobs) {
+            GlStub::reset();
+            gpu.onContextReady();
+            scene.init(&gpu, jobs);
+            scene.resize(width, height);
+            scene.initGl();
+        }
+
+        void step(float dt) {
+            if (frame++ % 10 == 0) {
+                float x = (float) (frame * 37 % width), y = (float) (frame * 91 % height);
+                scene.touch(frame % 20 == 1 ? AMOTION_EVENT_ACTION_DOWN
+                                            : AMOTION_EVENT_ACTION_MOVE, x, y, 2);
+            }
+            scene.update(dt);
+            scene.draw();
+        }
+    };
+
+    void expectSteadyStateFramesDoNotAllocate(JobSystem *jobs) {
+        FrameHarness harness(jobs);
+        // Grids, particle pools, buffers and animation scratch size themselves up front.
+        for (int i = 0; i < 120; i++) {
+            harness.step(1.0f / 60);
+        }
+        for (int i = 0; i < 600; i++) {
+            AllocGuard::beginFrame();
+            harness.step(1.0f / 60);
+            ASSERT_EQ(0u, AllocGuard::endFrame()) << "frame " << i;
+        }
+    }
+}
+
+TEST(FrameAllocations, SteadyStateFramesDoNotAllocate) {
+    expectSteadyStateFramesDoNotAllocate(nullptr);
+}
+
+TEST(FrameAllocations, SteadyStateFramesDoNotAllocateWithJobs) {
+    JobSystem jobs;
+    jobs.start();
+    expectSteadyStateFramesDoNotAllocate(&jobs);
+}
+
+#endif
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "gl_stub.h"
+#include "gpu_resources.h"
+#include "host_assets.h"
+#include "mem_tracker.h"
+
+namespace {
+    /**
+     * Loader for a size x size RGBA texture; records the order of loads.
+     */
+    GpuResources::Loader solid(uint32_t size, std::vector<std::string> *loads) {
+        return [size, loads](AAssetManager *, const std::string &asset, GpuData &data) {
+            if (loads) {
+                loads->push_back(asset);
+            }
+            data.width = data.height = size;
+            data.format = GL_RGBA;
+            data.bytes.assign((size_t) size * size * 4, 0x80);
+            return true;
+        };
+    }
+
+    class GpuResourcesTest : public testing::Test {
+    protected:
+        GpuResources gpu;
+
+        void SetUp() override {
+            GlStub::reset();
+            gpu.onContextReady();
+        }
+
+        void loseContext() {
+            gpu.onContextLost();
+            GlStub::reset();
+            gpu.onContextReady();
+        }
+    };
+}
+
+TEST_F(GpuResourcesTest, GetUploadsOnceAndCachesTheDecodedData) {
+    std::vector<std::string> loads;
+    auto handle = gpu.addTexture("a", GpuTextureParams(), 0, solid(16, &loads));
+    GLuint name = gpu.get(handle);
+    EXPECT_NE(0u, name);
+    EXPECT_EQ(name, gpu.get(handle));
+    EXPECT_EQ(1u, loads.size());
+    EXPECT_EQ(1u, GlStub::counts().texImages);
+    auto stats = gpu.getStats();
+    EXPECT_EQ(1u, stats.resident);
+    EXPECT_EQ(16u * 16 * 4, stats.gpuBytes);
+    EXPECT_EQ(16u * 16 * 4, stats.cacheBytes);
+
+    gpu.remove(handle);
+    EXPECT_EQ(0u, GlStub::counts().liveTextures);
+    EXPECT_EQ(0u, gpu.getStats().cacheBytes);
+}
+
+TEST_F(GpuResourcesTest, ContextLossRehydratesFromTheCache) {
+    std::vector<std::string> loads;
+    auto texture = gpu.addTexture("t", GpuTextureParams(), 0, solid(8, &loads));
+    GpuBufferParams dynamic;
+    dynamic.size = 4096;
+    auto buffer = gpu.addBuffer("", dynamic);
+    auto unused = gpu.addTexture("unused", GpuTextureParams(), 0, solid(8, &loads));
+    gpu.get(texture);
+    gpu.get(buffer);
+    loads.clear();
+
+    loseContext();
+    EXPECT_EQ(2u, gpu.getStats().pending);
+    EXPECT_FALSE(gpu.rehydrate(1000000000));
+    EXPECT_TRUE(loads.empty());
+    auto stats = gpu.getStats();
+    EXPECT_EQ(2u, stats.rehydrated);
+    EXPECT_EQ(1u, stats.cacheHits);
+    EXPECT_EQ(0u, stats.reloads);
+    auto gl = GlStub::counts();
+    EXPECT_EQ(1u, gl.liveTextures);
+    EXPECT_EQ(1u, gl.liveBuffers);
+    EXPECT_EQ(4096u, gl.bufferBytes);
+    // Never uploaded, so not rebuilt either.
+    EXPECT_EQ(0u, gpu.getStats().pending);
+    EXPECT_NE(0u, gpu.get(unused));
+}
+
+TEST_F(GpuResourcesTest, UncachedResourcesReloadHighestPriorityFirst) {
+    gpu.setCacheBudget(0);
+    std::vector<std::string> loads;
+    SlotHandle handles[] = {
+            gpu.addTexture("low", GpuTextureParams(), 0, solid(4, &loads)),
+            gpu.addTexture("high", GpuTextureParams(), 2, solid(4, &loads)),
+            gpu.addTexture("mid", GpuTextureParams(), 1, solid(4, &loads)),
+    };
+    for (auto handle: handles) {
+        gpu.get(handle);
+    }
+    loads.clear();
+
+    loseContext();
+    gpu.rehydrate(1000000000);
+    EXPECT_EQ((std::vector<std::string>{"high", "mid", "low"}), loads);
+    EXPECT_EQ(3u, gpu.getStats().reloads);
+    EXPECT_EQ(3u, GlStub::counts().liveTextures);
+}
+
+TEST_F(GpuResourcesTest, GetPullsAQueuedResourceForward) {
+    gpu.setCacheBudget(0);
+    std::vector<std::string> loads;
+    auto first = gpu.addTexture("first", GpuTextureParams(), 1, solid(4, &loads));
+    auto second = gpu.addTexture("second", GpuTextureParams(), 0, solid(4, &loads));
+    gpu.get(first);
+    gpu.get(second);
+    loads.clear();
+
+    loseContext();
+    EXPECT_NE(0u, gpu.get(second));
+    gpu.rehydrate(1000000000);
+    EXPECT_EQ((std::vector<std::string>{"second", "first"}), loads);
+    EXPECT_EQ(0u, GlStub::counts().badDeletes);
+}
+
+#ifndef NDEBUG
+
+TEST_F(GpuResourcesTest, CachedDataIsChargedToAssets) {
+    auto before = MemTracker::stats(MemTag::Assets);
+    auto handle = gpu.addTexture("a", GpuTextureParams(), 0, solid(64, nullptr));
+    gpu.get(handle);
+    EXPECT_GE(MemTracker::stats(MemTag::Assets).live, before.live + 64 * 64 * 4);
+    gpu.clear();
+    EXPECT_EQ(before.live, MemTracker::stats(MemTag::Assets).live);
+}
+
+#endif
+
+TEST(GpuResources, DefaultLoaderDecodesTga) {
+    auto root = testing::TempDir();
+    // 2x1, 24 bits, bottom-up: blue then red, stored BGR.
+    const uint8_t tga[] = {0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 1, 0, 24, 0,
+                           255, 0, 0, 0, 0, 255};
+    FILE *f = fopen((root + "/gpu_resources_test.tga").c_str(), "wb");
+    ASSERT_NE(nullptr, f);
+    fwrite(tga, 1, sizeof(tga), f);
+    fclose(f);
+    auto *assets = HostAssets::open(root);
+    GpuData data;
+    ASSERT_TRUE(GpuResources::loadAsset(assets, "gpu_resources_test.tga", data));
+    HostAssets::close(assets);
+    EXPECT_EQ(2u, data.width);
+    EXPECT_EQ(1u, data.height);
+    EXPECT_EQ((GLenum) GL_RGB, data.format);
+    EXPECT_EQ((std::vector<uint8_t>{0, 0, 255, 255, 0, 0}), data.bytes);
+}
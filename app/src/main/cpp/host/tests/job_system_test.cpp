@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "job_system.h"
+
+namespace {
+    struct Marks {
+        std::vector<std::atomic<uint32_t>> hits;
+
+        explicit Marks(size_t n) : hits(n) {}
+
+        void operator()(uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                hits[i].fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        bool eachOnce() const {
+            for (auto &h: hits) {
+                if (h.load() != 1) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+}
+
+TEST(JobSystem, ParallelForRunsEveryChunkOnce) {
+    JobSystem jobs;
+    jobs.start(4);
+    Marks marks(100000);
+    JobCounter done;
+    jobs.parallelFor(100000, 64, marks, &done);
+    jobs.wait(&done);
+    EXPECT_TRUE(marks.eachOnce());
+}
+
+TEST(JobSystem, MoreJobsThanDequeSlots) {
+    // Several times the deque capacity in flight, so slots are reused while
+    // earlier jobs still run on other threads, and pushes overflow inline.
+    JobSystem jobs;
+    jobs.start(4);
+    for (int round = 0; round < 20; round++) {
+        Marks marks(8192);
+        JobCounter done;
+        jobs.parallelFor(8192, 1, marks, &done, round % 2 == 0);
+        jobs.wait(&done);
+        ASSERT_TRUE(marks.eachOnce()) << "round " << round;
+    }
+}
+
+TEST(JobSystem, WorkersSubmitNestedJobs) {
+    JobSystem jobs;
+    jobs.start(3);
+    Marks marks(64 * 64);
+    JobCounter inner;
+    struct Outer {
+        JobSystem *jobs;
+        Marks *marks;
+        JobCounter *inner;
+
+        void operator()(uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                jobs->submit([](void *data, uint32_t b, uint32_t e) {
+                    (*static_cast<Marks *>(data))(b, e);
+                }, marks, i * 64, i * 64 + 64, inner);
+            }
+        }
+    } outer{&jobs, &marks, &inner};
+    JobCounter done;
+    jobs.parallelFor(64, 4, outer, &done);
+    jobs.wait(&done);
+    jobs.wait(&inner);
+    EXPECT_TRUE(marks.eachOnce());
+}
+
+TEST(JobSystem, NonParticipantsRunInline) {
+    JobSystem jobs;
+    jobs.start(2);
+    std::thread([&jobs]() {
+        Marks marks(100);
+        JobCounter done;
+        jobs.parallelFor(100, 10, marks, &done);
+        EXPECT_TRUE(done.done());
+        EXPECT_TRUE(marks.eachOnce());
+    }).join();
+}
+
+TEST(JobSystem, WorkersOfAnotherSystemRunInline) {
+    JobSystem first, second;
+    first.start(2);
+    second.start(2);
+    struct Submit {
+        JobSystem *other;
+        Marks marks{100};
+        bool ranInline = false;
+        std::atomic<bool> finished{false};
+    } submit{&second};
+    // Background jobs only run on workers: here, the first system's one,
+    // which owns no deque in the second.
+    first.submitBackground([](void *data, uint32_t, uint32_t) {
+        auto &s = *static_cast<Submit *>(data);
+        JobCounter done;
+        s.other->parallelFor(100, 10, s.marks, &done);
+        s.ranInline = done.done();
+        s.other->wait(&done);
+        s.finished = true;
+    }, &submit);
+    while (!submit.finished) {
+        std::this_thread::yield();
+    }
+    EXPECT_TRUE(submit.ranInline);
+    EXPECT_TRUE(submit.marks.eachOnce());
+}
+
+TEST(JobSystem, StartRunsWorkerHooks) {
+    JobSystem jobs;
+    std::atomic<uint32_t> started{0}, exited{0};
+    jobs.onWorkerStart = [&started](uint32_t) { started++; };
+    jobs.onWorkerExit = [&exited](uint32_t) { exited++; };
+    jobs.start(4);
+    EXPECT_EQ(3u, started.load());
+    jobs.stop();
+    EXPECT_EQ(3u, exited.load());
+}
+
+TEST(JobSystem, WaitLeavesBackgroundJobsToWorkers) {
+    // Three participants: one worker may steal the spinning job below, the
+    // other is still free for the background job.
+    JobSystem jobs;
+    jobs.start(3);
+    struct Blocking {
+        std::atomic<bool> ran{false};
+        std::thread::id thread;
+    } blocking;
+    // The only normal job spins until the background job has run, so the
+    // waiting thread has nothing else to do but steal it if it could.
+    JobCounter done;
+    jobs.submitBackground([](void *data, uint32_t, uint32_t) {
+        auto *b = static_cast<Blocking *>(data);
+        b->thread = std::this_thread::get_id();
+        b->ran.store(true);
+    }, &blocking);
+    jobs.submit([](void *data, uint32_t, uint32_t) {
+        while (!static_cast<Blocking *>(data)->ran.load()) {
+            std::this_thread::yield();
+        }
+    }, &blocking, 0, 1, &done);
+    jobs.wait(&done);
+    EXPECT_NE(std::this_thread::get_id(), blocking.thread);
+}
+
+TEST(JobSystem, BackgroundJobsRunInlineWithoutWorkers) {
+    JobSystem jobs;
+    jobs.start(1);
+    bool ran = false;
+    jobs.submitBackground([](void *data, uint32_t, uint32_t) {
+        *static_cast<bool *>(data) = true;
+    }, &ran);
+    EXPECT_TRUE(ran);
+}
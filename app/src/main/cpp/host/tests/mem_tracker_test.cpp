@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "mem_tracker.h"
+#include "test_util.h"
+
+#ifndef NDEBUG
+
+namespace {
+    struct alignas(64) CacheLine {
+        float values[16];
+    };
+}
+
+TEST(MemTracker, ChargesTheScopeTag) {
+    auto before = MemTracker::stats(MemTag::Audio);
+    std::unique_ptr<char[]> block;
+    {
+        MemTagScope tag(MemTag::Audio);
+        block.reset(escape(new char[1000]));
+    }
+    auto during = MemTracker::stats(MemTag::Audio);
+    EXPECT_EQ(before.live + 1000, during.live);
+    EXPECT_EQ(before.blocks + 1, during.blocks);
+    EXPECT_GE(during.peak, during.live);
+    block.reset();
+    auto after = MemTracker::stats(MemTag::Audio);
+    EXPECT_EQ(before.live, after.live);
+    EXPECT_EQ(before.blocks, after.blocks);
+}
+
+TEST(MemTracker, ScopesNestAndRestore) {
+    EXPECT_EQ(MemTag::General, MemTracker::currentTag());
+    {
+        MemTagScope outer(MemTag::Renderer);
+        {
+            MemTagScope inner(MemTag::Assets);
+            EXPECT_EQ(MemTag::Assets, MemTracker::currentTag());
+        }
+        EXPECT_EQ(MemTag::Renderer, MemTracker::currentTag());
+    }
+    EXPECT_EQ(MemTag::General, MemTracker::currentTag());
+}
+
+TEST(MemTracker, CreditsFreesToTheAllocatingTag) {
+    auto before = MemTracker::stats(MemTag::Sensors);
+    CacheLine *line;
+    {
+        MemTagScope tag(MemTag::Sensors);
+        line = escape(new CacheLine);
+    }
+    EXPECT_EQ(before.live + sizeof(CacheLine), MemTracker::stats(MemTag::Sensors).live);
+    // Freed on another thread, under another tag.
+    std::thread([line]() {
+        MemTagScope tag(MemTag::Input);
+        delete line;
+    }).join();
+    EXPECT_EQ(before.live, MemTracker::stats(MemTag::Sensors).live);
+    EXPECT_EQ(before.blocks, MemTracker::stats(MemTag::Sensors).blocks);
+}
+
+TEST(MemTracker, BudgetIsReported) {
+    MemTracker::setBudget(MemTag::Input, 4096);
+    EXPECT_EQ(4096u, MemTracker::stats(MemTag::Input).budget);
+    {
+        MemTagScope tag(MemTag::Input);
+        // Logs one over-budget warning.
+        std::vector<char> big(8192);
+        escape(big.data());
+    }
+    MemTracker::setBudget(MemTag::Input, 0);
+}
+
+#endif
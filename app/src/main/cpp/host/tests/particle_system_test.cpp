@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "particle_system.h"
+
+namespace {
+    void fill(ParticleSystem &particles) {
+        for (int burst = 0; burst < 64; burst++) {
+            particles.emit(61, (float) burst * 10, 500, 300, 1.5f);
+        }
+    }
+}
+
+TEST(ParticleSystem, EveryIsaMatchesScalar) {
+    for (auto isa: {ParticleIsa::Sse2, ParticleIsa::Neon}) {
+        if (!ParticleSystem::supports(isa)) {
+            continue;
+        }
+        ParticleSystem scalar(4096), simd(4096);
+        fill(scalar);
+        fill(simd);
+        for (int frame = 0; frame < 120; frame++) {
+            scalar.update(1.0f / 60, 3, 600, ParticleIsa::Scalar);
+            simd.update(1.0f / 60, 3, 600, isa);
+            ASSERT_EQ(scalar.size(), simd.size()) << "frame " << frame;
+            for (size_t i = 0; i < scalar.size(); i++) {
+                ASSERT_FLOAT_EQ(scalar.positionsX()[i], simd.positionsX()[i]);
+                ASSERT_FLOAT_EQ(scalar.positionsY()[i], simd.positionsY()[i]);
+            }
+        }
+    }
+}
+
+TEST(ParticleSystem, ExpiredParticlesAreCompactedAway) {
+    ParticleSystem particles(1000);
+    EXPECT_EQ(1000u, particles.emit(5000, 0, 0, 100, 1));
+    particles.update(0.4f, 0, 0, ParticleIsa::Scalar);
+    // Lifetimes are spread over [0.5, 1] times the requested one.
+    EXPECT_EQ(1000u, particles.size());
+    particles.update(0.4f, 0, 0, ParticleIsa::Scalar);
+    EXPECT_LT(particles.size(), 1000u);
+    EXPECT_GT(particles.size(), 0u);
+    particles.update(0.4f, 0, 0, ParticleIsa::Scalar);
+    EXPECT_EQ(0u, particles.size());
+}
+
+TEST(ParticleSystem, UnsupportedIsaFallsBackToScalar) {
+    EXPECT_TRUE(ParticleSystem::supports(ParticleIsa::Scalar));
+    EXPECT_TRUE(ParticleSystem::supports(ParticleSystem::nativeIsa()));
+    auto other = ParticleSystem::nativeIsa() == ParticleIsa::Neon ? ParticleIsa::Sse2
+                                                                  : ParticleIsa::Neon;
+    EXPECT_FALSE(ParticleSystem::supports(other));
+    ParticleSystem scalar(64), fallback(64);
+    scalar.emit(64, 0, 0, 100, 10);
+    fallback.emit(64, 0, 0, 100, 10);
+    scalar.update(0.1f, 0, 10, ParticleIsa::Scalar);
+    fallback.update(0.1f, 0, 10, other);
+    for (size_t i = 0; i < 64; i++) {
+        EXPECT_EQ(scalar.positionsY()[i], fallback.positionsY()[i]);
+    }
+}
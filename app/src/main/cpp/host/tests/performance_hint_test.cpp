@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include "performance_hint.h"
+
+namespace {
+    const int64_t frame60 = 1000000000LL / 60;
+}
+
+TEST(PerformanceHint, ReportsReachTheSession) {
+    PerformanceHint hint;
+    ASSERT_TRUE(hint.open({101, 102}, frame60));
+    ASSERT_TRUE(hint.isActive());
+    auto *log = hint.getStandInLog();
+    ASSERT_NE(nullptr, log);
+    EXPECT_EQ((std::vector<int32_t>{101, 102}), log->threads);
+    EXPECT_EQ(frame60, log->targetNs);
+
+    hint.reportWork(frame60 / 2);
+    hint.reportWork(frame60 + 1);
+    // Nothing to report: dropped before it reaches the platform.
+    hint.reportWork(0);
+    EXPECT_EQ(2u, hint.getReports());
+    EXPECT_EQ(1u, hint.getOverruns());
+    EXPECT_EQ(2u, log->reports);
+    EXPECT_EQ(1u, log->overruns);
+    EXPECT_EQ(frame60 + 1, log->lastActualNs);
+    EXPECT_EQ(0u, log->rejected);
+}
+
+TEST(PerformanceHint, TargetChangesAreForwardedOnce) {
+    PerformanceHint hint;
+    ASSERT_TRUE(hint.open({101}, frame60));
+    hint.setTargetDuration(2 * frame60);
+    hint.setTargetDuration(2 * frame60);
+    auto *log = hint.getStandInLog();
+    EXPECT_EQ(2 * frame60, log->targetNs);
+    EXPECT_EQ(1u, log->targetUpdates);
+    EXPECT_EQ(2 * frame60, hint.getTargetDuration());
+    // Overruns are judged against the new target.
+    hint.reportWork(frame60 + 1);
+    EXPECT_EQ(0u, log->overruns);
+
+    hint.setTargetDuration(0);
+    EXPECT_EQ(1u, log->rejected);
+    EXPECT_EQ(2 * frame60, log->targetNs);
+}
+
+TEST(PerformanceHint, ThreadSetCanBeReplaced) {
+    PerformanceHint hint;
+    ASSERT_TRUE(hint.open({101}, frame60));
+    hint.setThreads({201, 202, 203});
+    EXPECT_EQ((std::vector<int32_t>{201, 202, 203}), hint.getStandInLog()->threads);
+    hint.setThreads({});
+    EXPECT_EQ(1u, hint.getStandInLog()->rejected);
+    EXPECT_EQ(3u, hint.getStandInLog()->threads.size());
+}
+
+TEST(PerformanceHint, SessionNeedsThreadsAndTarget) {
+    PerformanceHint hint;
+    EXPECT_FALSE(hint.open({}, frame60));
+    EXPECT_FALSE(hint.isActive());
+    EXPECT_FALSE(hint.open({101}, 0));
+    // Without a session, frames are still counted locally.
+    hint.reportWork(frame60 * 2);
+    EXPECT_EQ(1u, hint.getReports());
+    EXPECT_EQ(nullptr, hint.getStandInLog());
+}
+
+TEST(PerformanceHint, CloseEndsTheSession) {
+    PerformanceHint hint;
+    ASSERT_TRUE(hint.open({101}, frame60));
+    hint.close();
+    EXPECT_FALSE(hint.isActive());
+    EXPECT_EQ(nullptr, hint.getStandInLog());
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <android/input.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+
+#include "gl_stub.h"
+#include "gpu_resources.h"
+#include "scene.h"
+
+namespace {
+    class SceneTest : public testing::Test {
+    protected:
+        GpuResources gpu;
+        Scene scene;
+
+        void SetUp() override {
+            GlStub::reset();
+            gpu.onContextReady();
+            scene.init(&gpu, nullptr);
+            scene.resize(1080, 1920);
+        }
+    };
+}
+
+TEST_F(SceneTest, DrawStreamsTheVisibleEntitiesAndTheCursor) {
+    // Scattered inside the window, so every entity is on screen.
+    ASSERT_EQ(16u * 1024, scene.entityCount());
+    scene.draw();
+    auto gl = GlStub::counts();
+    // No sparks yet: entities and the nine cursor nodes.
+    EXPECT_EQ(2u, gl.drawCalls);
+    EXPECT_EQ(scene.entityCount() + 9, gl.drawnVertices);
+    EXPECT_EQ(0u, gl.badDeletes);
+}
+
+TEST_F(SceneTest, TouchesThrowSparksByEffectQuality) {
+    scene.touch(AMOTION_EVENT_ACTION_DOWN, 100, 200, 0);
+    EXPECT_EQ(8u, scene.particleCount());
+    scene.touch(AMOTION_EVENT_ACTION_MOVE, 110, 210, 2);
+    EXPECT_EQ(40u, scene.particleCount());
+    EXPECT_EQ(110, scene.state().x);
+    EXPECT_EQ(210, scene.state().y);
+
+    scene.draw();
+    EXPECT_EQ(3u, GlStub::counts().drawCalls);
+}
+
+TEST_F(SceneTest, SavedStateRestoresIntoAnotherScene) {
+    scene.touch(AMOTION_EVENT_ACTION_DOWN, 300, 400, 0);
+    scene.update(0.5f);
+    size_t size = 0;
+    void *saved = scene.saveState(&size);
+    ASSERT_EQ(sizeof(Scene::SavedState), size);
+
+    GpuResources otherGpu;
+    Scene other;
+    other.init(&otherGpu, nullptr);
+    other.restoreState(saved, size - 1);
+    EXPECT_EQ(0, other.state().x);
+    other.restoreState(saved, size);
+    free(saved);
+    EXPECT_EQ(300, other.state().x);
+    EXPECT_EQ(400, other.state().y);
+    EXPECT_FLOAT_EQ(scene.state().angle, other.state().angle);
+
+    // The ramp carries on from the restored angle.
+    scene.update(0.1f);
+    other.update(0.1f);
+    EXPECT_FLOAT_EQ(scene.state().angle, other.state().angle);
+}
+
+TEST_F(SceneTest, TouchPicksTheTrueNearestEntity) {
+    // Files the world in the touch grid.
+    scene.update(1.0f / 60);
+    auto &world = scene.entities();
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> x(0, 1080), y(0, 1920);
+    for (int i = 0; i < 1000; i++) {
+        float tx = x(rng), ty = y(rng);
+        scene.touch(AMOTION_EVENT_ACTION_MOVE, tx, ty, 0);
+        // Brute force over the world, with the same reach.
+        float nearest = 48 * 48;
+        SlotHandle expected;
+        for (size_t e = 0; e < world.size(); e++) {
+            float dx = world.positionsX()[e] - tx, dy = world.positionsY()[e] - ty;
+            if (dx * dx + dy * dy <= nearest) {
+                nearest = dx * dx + dy * dy;
+                expected = world.handleAt(e);
+            }
+        }
+        ASSERT_EQ(expected, scene.touchedEntity()) << "touch " << i << " at " << tx << "," << ty;
+    }
+}
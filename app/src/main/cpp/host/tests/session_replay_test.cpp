@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <android/input.h>
+
+#include <cstdio>
+#include <string>
+
+#include "host_assets.h"
+#include "session_replay.h"
+
+namespace {
+    const char *const scenario = "# native-activity scenario 1\n"
+                                 "0.000 touch down 120.0 640.0\n"
+                                 "10.000 accel 0.12 9.79 0.33\n"
+                                 "not an event\n"
+                                 "40.000 touch up 130.0 610.0\n"
+                                 "100.000 end\n";
+
+    std::string writeScenario(const char *name) {
+        auto root = testing::TempDir();
+        FILE *f = fopen((root + "/" + name).c_str(), "w");
+        fputs(scenario, f);
+        fclose(f);
+        return root;
+    }
+}
+
+TEST(SessionReplay, LoadsAnAssetAndSkipsBadLines) {
+    auto root = writeScenario("session_replay_test.txt");
+    auto *assets = HostAssets::open(root);
+    SessionReplay replay;
+    ASSERT_TRUE(replay.load(assets, "session_replay_test.txt"));
+    HostAssets::close(assets);
+    EXPECT_EQ("session_replay_test.txt", replay.getName());
+
+    replay.start(SessionReplay::Pacing::Fast, 0);
+    replay.beginFrame(0);
+    auto *down = replay.next();
+    ASSERT_NE(nullptr, down);
+    EXPECT_EQ(SessionEvent::Type::Touch, down->type);
+    EXPECT_EQ(AMOTION_EVENT_ACTION_DOWN, down->action);
+    EXPECT_FLOAT_EQ(640, down->y);
+    EXPECT_EQ(nullptr, replay.next());
+    replay.endFrame(0, 0);
+}
+
+TEST(SessionReplay, FastPacingStepsOneFrameAtATime) {
+    auto root = writeScenario("session_replay_fast.txt");
+    SessionReplay replay;
+    ASSERT_TRUE(replay.load(nullptr, root + "/session_replay_fast.txt"));
+    replay.start(SessionReplay::Pacing::Fast, 0);
+    uint32_t frames = 0, events = 0;
+    while (!replay.finished()) {
+        // Wall time stands still; fast pacing moves on regardless.
+        float dt = replay.beginFrame(0);
+        EXPECT_NEAR(1.0f / 60, dt, 1e-6f);
+        while (replay.next()) {
+            events++;
+        }
+        replay.endFrame(0, 0);
+        ASSERT_LT(++frames, 100u);
+    }
+    EXPECT_EQ(3u, events);
+    // 100 ms at 60 Hz: six whole frames fall just short, so frames 0 to 7.
+    EXPECT_EQ(8u, frames);
+}
+
+TEST(SessionReplay, ReportEscapesTheScenarioName) {
+    auto root = writeScenario("say \"hi\"\\now.txt");
+    auto *assets = HostAssets::open(root);
+    SessionReplay replay;
+    ASSERT_TRUE(replay.load(assets, "say \"hi\"\\now.txt"));
+    HostAssets::close(assets);
+    replay.start(SessionReplay::Pacing::Fast, 0);
+    testing::internal::CaptureStderr();
+    replay.report(1000000000);
+    auto log = testing::internal::GetCapturedStderr();
+    EXPECT_NE(std::string::npos, log.find("{\"scenario\":\"say \\\"hi\\\"\\\\now.txt\",")) << log;
+    // build_type says whether allocations were counted.
+    EXPECT_NE(std::string::npos, log.find("\"build_type\":\"")) << log;
+    EXPECT_EQ(std::string::npos, log.find("allocations_counted")) << log;
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "spatial_grid.h"
+
+namespace {
+    std::vector<uint32_t> sorted(const uint32_t *ids, size_t count) {
+        std::vector<uint32_t> v(ids, ids + count);
+        std::sort(v.begin(), v.end());
+        return v;
+    }
+
+    std::vector<uint32_t> bruteAabb(const std::vector<Aabb> &boxes, const std::vector<bool> &live,
+                                    const Aabb &q) {
+        std::vector<uint32_t> v;
+        for (uint32_t i = 0; i < boxes.size(); i++) {
+            auto &b = boxes[i];
+            if (live[i] && b.minX <= q.maxX && q.minX <= b.maxX && b.minY <= q.maxY &&
+                q.minY <= b.maxY) {
+                v.push_back(i);
+            }
+        }
+        return v;
+    }
+}
+
+TEST(SpatialGrid, IncrementalCommitsMatchBruteForce) {
+    const uint32_t count = 2000;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> pos(-50, 1100), size(0, 120);
+    SpatialGrid grid;
+    grid.init(0, 0, 1024, 1024, 64);
+    grid.resize(count);
+    std::vector<Aabb> boxes(count);
+    std::vector<bool> live(count, false);
+    std::vector<uint32_t> out(count);
+    for (int round = 0; round < 50; round++) {
+        // Move, add and remove a random tenth each round.
+        for (uint32_t n = 0; n < count / 10 || round == 0; n++) {
+            uint32_t i = round == 0 ? n : rng() % count;
+            if (round == 0 && n == count) {
+                break;
+            }
+            if (rng() % 8 == 0) {
+                grid.remove(i);
+                live[i] = false;
+                continue;
+            }
+            float x = pos(rng), y = pos(rng);
+            boxes[i] = Aabb{x, y, x + size(rng), y + size(rng)};
+            grid.setBounds(i, boxes[i]);
+            live[i] = true;
+        }
+        grid.commit();
+        EXPECT_EQ(0u, grid.pendingMoves());
+        for (int q = 0; q < 20; q++) {
+            float x = pos(rng), y = pos(rng);
+            Aabb region{x, y, x + size(rng) * 2, y + size(rng) * 2};
+            auto found = grid.queryAabb(region, out.data(), out.size());
+            ASSERT_EQ(bruteAabb(boxes, live, region), sorted(out.data(), found))
+                                        << "round " << round << " query " << q;
+        }
+    }
+}
+
+TEST(SpatialGrid, ShrinkingDropsTrailingIds) {
+    SpatialGrid grid;
+    grid.init(0, 0, 256, 256, 32);
+    grid.resize(10);
+    for (uint32_t i = 0; i < 10; i++) {
+        grid.setBounds(i, Aabb{(float) i * 20, 10, (float) i * 20 + 5, 15});
+    }
+    grid.commit();
+    grid.setBounds(9, Aabb{0, 0, 1, 1});
+    grid.resize(5);
+    grid.commit();
+    uint32_t out[16];
+    auto found = grid.queryAabb(Aabb{0, 0, 256, 256}, out, 16);
+    EXPECT_EQ((std::vector<uint32_t>{0, 1, 2, 3, 4}), sorted(out, found));
+}
+
+TEST(SpatialGrid, LoosePointsOnlyRefileWhenTheyLeaveTheirBox) {
+    SpatialGrid grid;
+    grid.init(0, 0, 1024, 1024, 64);
+    grid.resize(3);
+    float x[3] = {100, 500, 900}, y[3] = {100, 500, 900};
+    grid.updatePoints(x, y, 3, 16);
+    EXPECT_EQ(3u, grid.pendingMoves());
+    grid.commit();
+    // Still inside its box; out of its box and into another cell.
+    x[0] += 10;
+    x[1] += 100;
+    grid.updatePoints(x, y, 3, 16);
+    EXPECT_EQ(1u, grid.pendingMoves());
+    grid.commit();
+    uint32_t out[4];
+    ASSERT_EQ(1u, grid.queryRadius(600, 500, 4, out, 4));
+    EXPECT_EQ(1u, out[0]);
+    ASSERT_EQ(1u, grid.queryRadius(110, 100, 4, out, 4));
+    EXPECT_EQ(0u, out[0]);
+}
+
+TEST(SpatialGrid, NearestConsidersEveryCandidate) {
+    SpatialGrid grid;
+    grid.init(0, 0, 1024, 1024, 64);
+    // A dense cluster, far more than any fixed candidate buffer, nearest last.
+    std::vector<float> x, y;
+    for (int i = 0; i < 400; i++) {
+        x.push_back(500 + (float) (i % 20) * 2);
+        y.push_back(500 + (float) (i / 20) * 2);
+    }
+    x.push_back(519.5f);
+    y.push_back(519.5f);
+    grid.resize(x.size());
+    grid.updatePoints(x.data(), y.data(), x.size(), 16);
+    grid.commit();
+    uint32_t nearest = 0;
+    ASSERT_TRUE(grid.queryNearest(519.4f, 519.4f, 48, x.data(), y.data(), &nearest));
+    EXPECT_EQ(400u, nearest);
+    // Boxes in reach, points not.
+    EXPECT_FALSE(grid.queryNearest(460, 500, 30, x.data(), y.data(), &nearest));
+}
+
+TEST(SpatialGrid, ReinitRefilesEverything) {
+    SpatialGrid grid;
+    grid.init(0, 0, 100, 100, 10);
+    grid.resize(2);
+    grid.setBounds(0, Aabb{50, 50, 55, 55});
+    grid.setBounds(1, Aabb{500, 500, 505, 505});
+    grid.commit();
+    grid.init(0, 0, 1000, 1000, 100);
+    grid.commit();
+    uint32_t out[2];
+    ASSERT_EQ(1u, grid.queryPoint(502, 502, out, 2));
+    EXPECT_EQ(1u, out[0]);
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include "job_system.h"
+#include "startup_graph.h"
+
+namespace {
+    /**
+     * The window and display handling of the engine's startup graph, with
+     * EGL replaced by flags. The perf-hint and session steps finish when the
+     * script says so, through gates.
+     */
+    struct ScriptedEngine {
+        JobSystem jobs;
+        StartupGraph startup;
+        StartupGraph::NodeId windowGate = 0, hintDone = 0, sessionDone = 0;
+        bool window = false;
+        bool display = false;
+        bool hintApplied = false;
+        int displayInits = 0;
+        // initDisplay() calls made before the hint session was ready.
+        int earlyInits = 0;
+        int frames = 0;
+
+        ScriptedEngine() {
+            hintDone = startup.addGate("hint-done");
+            sessionDone = startup.addGate("session-done");
+            auto perfHint = startup.add("perf-hint", [this]() { hintApplied = true; },
+                                        {hintDone});
+            windowGate = startup.addGate("window");
+            auto displayNode = startup.add("display", [this]() {
+                if (window && !display) {
+                    initDisplay();
+                }
+            }, {windowGate, perfHint}, StartupGraph::Thread::Main);
+            startup.add("first-frame", [this]() {
+                if (window && !display) {
+                    initDisplay();
+                }
+                drawFrame();
+            }, {displayNode, sessionDone}, StartupGraph::Thread::Main);
+            startup.start(&jobs);
+            startup.runMainReady();
+        }
+
+        void initDisplay() {
+            earlyInits += hintApplied ? 0 : 1;
+            displayInits++;
+            display = true;
+        }
+
+        void drawFrame() {
+            frames += display ? 1 : 0;
+        }
+
+        // Engine::onInitWindow().
+        void onInitWindow() {
+            window = true;
+            if (startup.signal(windowGate)) {
+                startup.runMainReady();
+                return;
+            }
+            if (!startup.done()) {
+                return;
+            }
+            if (!display) {
+                initDisplay();
+            }
+            drawFrame();
+        }
+
+        // Engine::onTermWindow().
+        void onTermWindow() {
+            window = false;
+            display = false;
+        }
+
+        void finish(StartupGraph::NodeId gate) {
+            startup.signal(gate);
+            startup.runMainReady();
+        }
+    };
+}
+
+TEST(StartupGraph, WindowBackBeforeDependenciesWaitsForTheDisplayNode) {
+    ScriptedEngine engine;
+    engine.onInitWindow();
+    engine.onTermWindow();
+    engine.onInitWindow();
+    EXPECT_EQ(0, engine.displayInits);
+
+    engine.finish(engine.hintDone);
+    engine.finish(engine.sessionDone);
+    EXPECT_TRUE(engine.startup.done());
+    EXPECT_EQ(1, engine.displayInits);
+    EXPECT_EQ(0, engine.earlyInits);
+    EXPECT_EQ(1, engine.frames);
+}
+
+TEST(StartupGraph, WindowBackAfterTheDisplayNodeIsInitByTheFirstFrame) {
+    ScriptedEngine engine;
+    engine.finish(engine.hintDone);
+    engine.onInitWindow();
+    EXPECT_EQ(1, engine.displayInits);
+    engine.onTermWindow();
+    engine.onInitWindow();
+    EXPECT_FALSE(engine.display);
+
+    engine.finish(engine.sessionDone);
+    EXPECT_TRUE(engine.startup.done());
+    EXPECT_TRUE(engine.display);
+    EXPECT_EQ(2, engine.displayInits);
+    EXPECT_EQ(1, engine.frames);
+}
+
+TEST(StartupGraph, WindowWithoutDisplayAtFirstFrameDrawsNothing) {
+    ScriptedEngine engine;
+    engine.finish(engine.hintDone);
+    engine.onInitWindow();
+    engine.onTermWindow();
+    engine.finish(engine.sessionDone);
+    EXPECT_TRUE(engine.startup.done());
+    EXPECT_EQ(0, engine.frames);
+
+    // Startup is over: the window brings the display up itself.
+    engine.onInitWindow();
+    EXPECT_EQ(2, engine.displayInits);
+    EXPECT_EQ(0, engine.earlyInits);
+    EXPECT_EQ(1, engine.frames);
+}
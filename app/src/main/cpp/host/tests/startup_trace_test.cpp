@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <map>
+#include <string>
+
+#include "startup_trace.h"
+
+namespace {
+    const char *const launchMilestones[] = {
+            "androidMain", "engineInit", "initWindow", "eglInitialize", "eglConfig",
+            "eglContext", "firstSwap",
+    };
+
+    /**
+     * One startup-record line, parsed the way tools/startup_report.py reads
+     * it: a flat JSON object after the "startup-record " prefix. Numbers and
+     * null are kept as their text, strings without their quotes.
+     */
+    std::map<std::string, std::string> parseRecord(const std::string &log) {
+        std::map<std::string, std::string> fields;
+        auto start = log.find("startup-record {");
+        auto end = log.find('}', start);
+        if (start == std::string::npos || end == std::string::npos ||
+            log.find("startup-record", start + 1) != std::string::npos) {
+            ADD_FAILURE() << "expected one startup-record line in: " << log;
+            return fields;
+        }
+        std::string body = log.substr(start + 16, end - start - 16);
+        size_t i = 0;
+        while (i < body.size()) {
+            auto keyEnd = body.find("\":", i + 1);
+            if (body[i] != '"' || keyEnd == std::string::npos) {
+                ADD_FAILURE() << "malformed record: {" << body << "}";
+                return fields;
+            }
+            std::string key = body.substr(i + 1, keyEnd - i - 1);
+            auto valueEnd = body.find(',', keyEnd + 2);
+            if (valueEnd == std::string::npos) {
+                valueEnd = body.size();
+            }
+            std::string value = body.substr(keyEnd + 2, valueEnd - keyEnd - 2);
+            if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+                value = value.substr(1, value.size() - 2);
+            }
+            EXPECT_TRUE(fields.emplace(key, value).second) << "duplicate " << key;
+            i = valueEnd + 1;
+        }
+        return fields;
+    }
+
+    /**
+     * Emit, twice: only the first call of a launch logs.
+     * @return the record logged
+     */
+    std::map<std::string, std::string> emitRecord() {
+        testing::internal::CaptureStderr();
+        StartupTrace::emit();
+        StartupTrace::emit();
+        return parseRecord(testing::internal::GetCapturedStderr());
+    }
+
+    /**
+     * Pass every milestone from android_main to the first swap, then emit.
+     */
+    std::map<std::string, std::string> launch() {
+        for (auto m = (size_t) Milestone::AndroidMain; m < (size_t) Milestone::Count; m++) {
+            StartupTrace::mark((Milestone) m);
+        }
+        return emitRecord();
+    }
+
+    double ms(const std::map<std::string, std::string> &record, const char *name) {
+        auto it = record.find(name);
+        if (it == record.end() || it->second == "null") {
+            ADD_FAILURE() << name << " missing";
+            return -1;
+        }
+        return strtod(it->second.c_str(), nullptr);
+    }
+}
+
+// First in this file: a launch earlier in the process would make it warm.
+TEST(StartupTrace, FirstLaunchIsColdAndMeasuredFromProcessStart) {
+    ASSERT_EQ(0, StartupTrace::at(Milestone::AndroidMain));
+    // Set by the library's static initializers.
+    EXPECT_GT(StartupTrace::at(Milestone::ProcessStart), 0);
+    EXPECT_GE(StartupTrace::at(Milestone::LibraryLoad),
+              StartupTrace::at(Milestone::ProcessStart));
+
+    StartupTrace::setVariant("test");
+    auto record = launch();
+    EXPECT_EQ("1", record["v"]);
+    EXPECT_EQ("cold", record["launch"]);
+    EXPECT_EQ("test", record["variant"]);
+    EXPECT_EQ(0.0, ms(record, "processStart"));
+    EXPECT_GE(ms(record, "libraryLoad"), 0.0);
+}
+
+TEST(StartupTrace, MilestonesAreInLaunchOrderAndMarkedOnce) {
+    for (auto m = (size_t) Milestone::AndroidMain; m < (size_t) Milestone::Count; m++) {
+        StartupTrace::mark((Milestone) m);
+    }
+    // Only the first mark of a launch counts.
+    int64_t config = StartupTrace::at(Milestone::EglConfig);
+    StartupTrace::mark(Milestone::EglConfig);
+    EXPECT_EQ(config, StartupTrace::at(Milestone::EglConfig));
+
+    auto record = emitRecord();
+    double previous = 0;
+    for (auto *name: launchMilestones) {
+        double at = ms(record, name);
+        EXPECT_GE(at, previous) << name;
+        previous = at;
+    }
+}
+
+TEST(StartupTrace, RelaunchInTheSameProcessIsWarm) {
+    launch();
+    // android_main again: every later milestone starts over.
+    StartupTrace::mark(Milestone::AndroidMain);
+    EXPECT_EQ(0, StartupTrace::at(Milestone::EngineInit));
+    EXPECT_EQ(0, StartupTrace::at(Milestone::FirstSwap));
+
+    StartupTrace::mark(Milestone::EngineInit);
+    auto partial = emitRecord();
+    EXPECT_EQ("warm", partial["launch"]);
+    // The process and library milestones are stale and left out.
+    EXPECT_EQ(0u, partial.count("processStart"));
+    EXPECT_EQ(0u, partial.count("libraryLoad"));
+    EXPECT_EQ(0.0, ms(partial, "androidMain"));
+    EXPECT_GE(ms(partial, "engineInit"), 0.0);
+    EXPECT_EQ("null", partial["firstSwap"]);
+}
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "job_system.h"
+#include "task.h"
+
+namespace {
+    Task readOffThread(Scheduler &scheduler, std::thread::id &ranOn, bool &finished) {
+        co_await scheduler.runAsync([&ranOn]() { ranOn = std::this_thread::get_id(); });
+        finished = true;
+    }
+
+    Task countFrames(Scheduler &scheduler, uint32_t frames, uint32_t &counted) {
+        for (uint32_t i = 0; i < frames; i++) {
+            co_await scheduler.nextFrame();
+            counted++;
+        }
+    }
+}
+
+TEST(Task, RunAsyncRunsOnAWorkerAndResumesInTick) {
+    JobSystem jobs;
+    jobs.start(2);
+    Scheduler scheduler;
+    scheduler.init(&jobs);
+    std::thread::id ranOn;
+    bool finished = false;
+    scheduler.spawn(readOffThread(scheduler, ranOn, finished));
+    int64_t now = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (scheduler.pending() && std::chrono::steady_clock::now() < deadline) {
+        scheduler.tick(now += 1000000);
+        std::this_thread::yield();
+    }
+    EXPECT_TRUE(finished);
+    EXPECT_NE(std::this_thread::get_id(), ranOn);
+}
+
+TEST(Task, FramesComeFromThePool) {
+    Scheduler scheduler;
+    scheduler.init(nullptr);
+    uint32_t fallbacks = CoroFramePool::heapFallbacks();
+    uint32_t counted = 0;
+    for (int round = 0; round < 4; round++) {
+        for (int i = 0; i < 64; i++) {
+            scheduler.spawn(countFrames(scheduler, 3, counted));
+        }
+        for (int64_t frame = 0; scheduler.pending(); frame++) {
+            scheduler.tick(frame);
+        }
+    }
+    EXPECT_EQ(4u * 64 * 3, counted);
+    EXPECT_EQ(fallbacks, CoroFramePool::heapFallbacks());
+}
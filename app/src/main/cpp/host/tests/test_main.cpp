@@ -0,0 +1,21 @@
+#include <gtest/gtest.h>
+
+#include "logging.h"
+#include "mem_tracker.h"
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    int result = RUN_ALL_TESTS();
+    // Every test has torn its subsystems down by now, so anything still
+    // charged to a subsystem tag leaked. General also holds the test
+    // framework's own allocations and is only reported.
+    MemTracker::dumpReport("exit");
+    for (size_t i = (size_t) MemTag::General + 1; i < (size_t) MemTag::Count; i++) {
+        auto s = MemTracker::stats((MemTag) i);
+        if (s.blocks) {
+            LOGW("memory: tag %zu leaked %zu bytes in %zu blocks", i, s.live, s.blocks);
+            result = 1;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+/**
+ * Keeps the compiler from eliding a new/delete pair, which it may do even
+ * with replaced allocation functions.
+ */
+template<typename T>
+T *escape(T *p) {
+    asm volatile("" : : "g"(p) : "memory");
+    return p;
+}
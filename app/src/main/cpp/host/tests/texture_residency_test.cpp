@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+
+#include "gl_stub.h"
+#include "mem_tracker.h"
+#include "texture_residency.h"
+
+namespace {
+    const uint32_t size = 256;
+    // Levels 2 (64x64) to 8 stay resident; all nine levels at full size.
+    const size_t floorBytes = (64 * 64 + 32 * 32 + 16 * 16 + 8 * 8 + 4 * 4 + 2 * 2 + 1) * 4;
+    const size_t fullBytes = (256 * 256 + 128 * 128) * 4 + floorBytes;
+
+    class TextureResidencyTest : public testing::Test {
+    protected:
+        // One texture at full size and a little more than two on their low mips.
+        TextureResidency residency{fullBytes + 2 * floorBytes + floorBytes / 2, 64};
+        uint32_t loads = 0;
+        bool failLoads = false;
+
+        void SetUp() override {
+            GlStub::reset();
+            residency.onContextReady();
+        }
+
+        SlotHandle add(const char *name, int priority = 0) {
+            auto handle = residency.add(name, GpuTextureParams(), priority,
+                                        [this](AAssetManager *, const std::string &,
+                                               GpuData &data) {
+                                            loads++;
+                                            if (failLoads) {
+                                                return false;
+                                            }
+                                            data.width = data.height = size;
+                                            data.format = GL_RGBA;
+                                            data.bytes.assign((size_t) size * size * 4, 0x40);
+                                            return true;
+                                        });
+            residency.get(handle);
+            return handle;
+        }
+
+        // One frame drawing each listed texture at full size.
+        void frame(std::initializer_list<SlotHandle> used) {
+            for (auto handle: used) {
+                residency.reportUsage(handle, size, size);
+            }
+            residency.update(1000000000);
+        }
+
+        void expectGpuMatchesStats() {
+            auto gl = GlStub::counts();
+            EXPECT_EQ(residency.getStats().residentBytes, gl.liveTextureBytes);
+            EXPECT_EQ(residency.getStats().resident, gl.liveTextures);
+            EXPECT_EQ(0u, gl.badDeletes);
+        }
+    };
+}
+
+TEST_F(TextureResidencyTest, AddUploadsOnlyTheLowMips) {
+    add("a");
+    auto stats = residency.getStats();
+    EXPECT_EQ(1u, stats.resident);
+    EXPECT_EQ(floorBytes, stats.residentBytes);
+    EXPECT_EQ(floorBytes, stats.floorBytes);
+    EXPECT_EQ(7u, GlStub::counts().texImages);
+    expectGpuMatchesStats();
+}
+
+TEST_F(TextureResidencyTest, UsagePromotesToTheMipItNeeds) {
+    auto a = add("a");
+    // Drawn at half size: level 1 is enough.
+    residency.reportUsage(a, size / 2, size / 2);
+    residency.update(1000000000);
+    auto stats = residency.getStats();
+    EXPECT_EQ(1u, stats.promotions);
+    EXPECT_EQ(1u, stats.raised);
+    EXPECT_EQ(0u, stats.fullResolution);
+    EXPECT_EQ(fullBytes - size * size * 4, stats.residentBytes);
+    expectGpuMatchesStats();
+
+    frame({a});
+    stats = residency.getStats();
+    EXPECT_EQ(2u, stats.promotions);
+    EXPECT_EQ(1u, stats.fullResolution);
+    EXPECT_EQ(fullBytes, stats.residentBytes);
+    expectGpuMatchesStats();
+}
+
+TEST_F(TextureResidencyTest, OverBudgetEvictsTexturesUnusedThisFrame) {
+    auto a = add("a", 1);
+    auto b = add("b");
+    auto c = add("c");
+    frame({a});
+    frame({b});
+    // a was not drawn this frame; it went back to its low mips for b.
+    auto stats = residency.getStats();
+    EXPECT_EQ(1u, stats.evictions);
+    EXPECT_EQ(fullBytes - floorBytes, stats.evictedBytes);
+    EXPECT_EQ(1u, stats.fullResolution);
+    EXPECT_LE(stats.residentBytes, stats.budgetBytes);
+    expectGpuMatchesStats();
+
+    // Both drawn: nothing can go, so c waits for its high mips.
+    frame({b, c});
+    stats = residency.getStats();
+    EXPECT_EQ(1u, stats.evictions);
+    EXPECT_EQ(1u, stats.starved);
+    expectGpuMatchesStats();
+}
+
+TEST_F(TextureResidencyTest, EvictsLowestPriorityFirst) {
+    auto high = add("high", 5);
+    auto low = add("low");
+    auto other = add("other");
+    residency.setBudget(2 * fullBytes + floorBytes);
+    frame({high, low});
+    EXPECT_EQ(2u, residency.getStats().fullResolution);
+
+    frame({other});
+    EXPECT_EQ(1u, residency.getStats().evictions);
+    EXPECT_EQ(2u, residency.getStats().fullResolution);
+    // high kept its mips, so drawing it again loads nothing.
+    auto promotions = residency.getStats().promotions;
+    frame({high});
+    EXPECT_EQ(promotions, residency.getStats().promotions);
+    expectGpuMatchesStats();
+}
+
+TEST_F(TextureResidencyTest, ContextLossKeepsLowMipsInMemory) {
+    auto a = add("a");
+    frame({a});
+    auto loadsBefore = loads;
+
+    residency.onContextLost();
+    GlStub::reset();
+    EXPECT_EQ(0u, residency.getStats().resident);
+    residency.onContextReady();
+    EXPECT_NE(0u, residency.get(a));
+    // Back on its low mips without touching the source.
+    EXPECT_EQ(loadsBefore, loads);
+    EXPECT_EQ(floorBytes, residency.getStats().residentBytes);
+    expectGpuMatchesStats();
+
+    frame({a});
+    EXPECT_EQ(loadsBefore + 1, loads);
+    EXPECT_EQ(fullBytes, residency.getStats().residentBytes);
+    expectGpuMatchesStats();
+}
+
+TEST_F(TextureResidencyTest, FailedPromotionIsNotRetriedEveryFrame) {
+    auto a = add("a");
+    failLoads = true;
+    auto loadsBefore = loads;
+    frame({a});
+    EXPECT_EQ(loadsBefore + 1, loads);
+    residency.update(1000000000);
+    residency.update(1000000000);
+    EXPECT_EQ(loadsBefore + 1, loads);
+    EXPECT_EQ(floorBytes, residency.getStats().residentBytes);
+    expectGpuMatchesStats();
+}
+
+#ifndef NDEBUG
+
+TEST_F(TextureResidencyTest, LowMipsAreChargedToAssets) {
+    auto before = MemTracker::stats(MemTag::Assets);
+    auto handle = add("a");
+    EXPECT_GE(MemTracker::stats(MemTag::Assets).live, before.live + floorBytes);
+    residency.remove(handle);
+    EXPECT_EQ(before.live, MemTracker::stats(MemTag::Assets).live);
+}
+
+#endif
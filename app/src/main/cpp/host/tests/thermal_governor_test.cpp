@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+#include "thermal_governor.h"
+
+namespace {
+    const int64_t second = 1000000000LL;
+
+    /**
+     * A governor reading the file stand-in, polled once a second.
+     */
+    class ThermalGovernorTest : public testing::Test {
+    protected:
+        std::string path = testing::TempDir() + "/thermal_governor_test";
+        ThermalGovernor thermal;
+        int64_t nowNs = 0;
+
+        void SetUp() override {
+            std::remove(path.c_str());
+            thermal.open(path);
+        }
+
+        void TearDown() override {
+            std::remove(path.c_str());
+        }
+
+        bool pollAt(float headroom) {
+            FILE *f = fopen(path.c_str(), "w");
+            fprintf(f, "%f\n", headroom);
+            fclose(f);
+            nowNs += second;
+            return thermal.poll(nowNs);
+        }
+    };
+}
+
+TEST_F(ThermalGovernorTest, StepsDownThroughEachLevel) {
+    EXPECT_FALSE(pollAt(0.5f));
+    EXPECT_EQ(0, thermal.getLevel());
+    EXPECT_TRUE(pollAt(0.8f));
+    EXPECT_EQ(1, thermal.getLevel());
+    EXPECT_TRUE(pollAt(0.9f));
+    EXPECT_EQ(2, thermal.getLevel());
+    EXPECT_TRUE(pollAt(0.97f));
+    EXPECT_EQ(3, thermal.getLevel());
+    EXPECT_FLOAT_EQ(0.97f, thermal.getLastHeadroom());
+    // Each level sheds more.
+    EXPECT_EQ(2, thermal.quality().swapInterval);
+    EXPECT_EQ(0, thermal.quality().effectQuality);
+}
+
+TEST_F(ThermalGovernorTest, JumpsStraightToTheLevelHeadroomCallsFor) {
+    EXPECT_TRUE(pollAt(0.96f));
+    EXPECT_EQ(3, thermal.getLevel());
+}
+
+TEST_F(ThermalGovernorTest, StepsUpAfterFivePollsWellBelowTheLevel) {
+    pollAt(0.9f);
+    ASSERT_EQ(2, thermal.getLevel());
+    // Below level 2's entry point, but not by the hysteresis margin.
+    for (int i = 0; i < 10; i++) {
+        EXPECT_FALSE(pollAt(0.8f));
+    }
+    EXPECT_EQ(2, thermal.getLevel());
+    for (int i = 0; i < 4; i++) {
+        EXPECT_FALSE(pollAt(0.7f));
+    }
+    EXPECT_TRUE(pollAt(0.7f));
+    EXPECT_EQ(1, thermal.getLevel());
+}
+
+TEST_F(ThermalGovernorTest, SpikeRestartsRecovery) {
+    pollAt(0.9f);
+    for (int i = 0; i < 4; i++) {
+        pollAt(0.6f);
+    }
+    // Not enough to step down again, but it ends the run of cool polls.
+    EXPECT_FALSE(pollAt(0.8f));
+    for (int i = 0; i < 4; i++) {
+        EXPECT_FALSE(pollAt(0.6f));
+    }
+    EXPECT_EQ(2, thermal.getLevel());
+    EXPECT_TRUE(pollAt(0.6f));
+    EXPECT_EQ(1, thermal.getLevel());
+}
+
+TEST_F(ThermalGovernorTest, PollsAtMostOnceASecond) {
+    pollAt(0.5f);
+    FILE *f = fopen(path.c_str(), "w");
+    fprintf(f, "0.97\n");
+    fclose(f);
+    EXPECT_FALSE(thermal.poll(nowNs + second / 2));
+    EXPECT_EQ(0, thermal.getLevel());
+    EXPECT_TRUE(thermal.poll(nowNs + second));
+}
+
+TEST_F(ThermalGovernorTest, BackgroundSampleIsTakenByUpdate) {
+    pollAt(0.5f);
+    FILE *f = fopen(path.c_str(), "w");
+    fprintf(f, "0.9\n");
+    fclose(f);
+    nowNs += second;
+    ASSERT_TRUE(thermal.sampleDue(nowNs));
+    // Still running: no second sample is started.
+    EXPECT_FALSE(thermal.sampleDue(nowNs + 2 * second));
+    EXPECT_FALSE(thermal.update());
+    thermal.sample();
+    EXPECT_TRUE(thermal.update());
+    EXPECT_EQ(2, thermal.getLevel());
+    EXPECT_FALSE(thermal.update());
+}
+
+TEST_F(ThermalGovernorTest, UnreadableHeadroomChangesNothing) {
+    pollAt(0.9f);
+    std::remove(path.c_str());
+    for (int i = 0; i < 10; i++) {
+        nowNs += second;
+        EXPECT_FALSE(thermal.poll(nowNs));
+    }
+    EXPECT_EQ(2, thermal.getLevel());
+}
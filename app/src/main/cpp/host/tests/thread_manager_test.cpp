@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cerrno>
+#include <thread>
+
+#include "thread_manager.h"
+
+namespace {
+    int64_t threadCpuNs() {
+        timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    }
+
+    /**
+     * A registered worker that burns CPU on request and stays alive until released.
+     */
+    class BusyWorker {
+    private:
+        std::atomic<int64_t> burnNs{0};
+        std::atomic<bool> idle{false};
+        std::atomic<bool> release{false};
+        std::thread thread;
+
+    public:
+        explicit BusyWorker(ThreadManager &threads, int64_t cpuNs) : burnNs(cpuNs) {
+            thread = std::thread([this, &threads]() {
+                threads.registerCurrentThread(ThreadRole::Worker, "test-worker");
+                auto start = threadCpuNs();
+                while (threadCpuNs() - start < burnNs.load()) {
+                }
+                idle = true;
+                while (!release.load()) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                threads.unregisterCurrentThread();
+            });
+            while (!idle.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        ~BusyWorker() {
+            release = true;
+            thread.join();
+        }
+    };
+}
+
+TEST(ThreadManager, ChargesThreadCpuTimeToItsRole) {
+    ThreadManager threads;
+    threads.init();
+    {
+        BusyWorker worker(threads, 30000000);
+        threads.sampleFrame(0);
+        auto &s = threads.getStats(ThreadRole::Worker);
+        EXPECT_EQ(1u, s.threads);
+        EXPECT_EQ(0u, s.unmeasured);
+        EXPECT_GE(s.frameCpuNs, 30000000);
+        // Waiting on the sampler's side costs the worker next to nothing.
+        threads.sampleFrame(0);
+        EXPECT_LT(threads.getStats(ThreadRole::Worker).frameCpuNs, 10000000);
+        EXPECT_EQ(0, threads.getStats(ThreadRole::Io).frameCpuNs);
+    }
+    threads.sampleFrame(0);
+    EXPECT_EQ(0u, threads.getStats(ThreadRole::Worker).threads);
+}
+
+TEST(ThreadManager, ThreadsWithoutCpuClockAreUnmeasured) {
+    ThreadManager threads;
+    threads.init();
+    threads.cpuClockOf = [](pthread_t, clockid_t *) { return ENOENT; };
+    {
+        BusyWorker worker(threads, 20000000);
+        threads.sampleFrame(0);
+        auto &s = threads.getStats(ThreadRole::Worker);
+        EXPECT_EQ(0u, s.threads);
+        EXPECT_EQ(1u, s.unmeasured);
+        // Not the sampling thread's own time, which it used to fall back to.
+        EXPECT_EQ(0, s.frameCpuNs);
+        EXPECT_EQ(1u, threads.threadIds(ThreadRole::Worker).size());
+    }
+    EXPECT_TRUE(threads.threadIds(ThreadRole::Worker).empty());
+}
@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include "transform_hierarchy.h"
+
+TEST(TransformHierarchy, ChildrenFollowTheirParent) {
+    TransformHierarchy tree;
+    auto root = tree.create();
+    auto child = tree.create(root);
+    auto grandchild = tree.create(child);
+    tree.setLocal(root, 100, 50, 0, 2);
+    tree.setLocal(child, 10, 0, 0, 1);
+    tree.setLocal(grandchild, 0, 5, 0, 1);
+    tree.update();
+    EXPECT_FLOAT_EQ(120, tree.worldOf(grandchild).tx);
+    EXPECT_FLOAT_EQ(60, tree.worldOf(grandchild).ty);
+    tree.setLocal(root, 0, 0, 0, 1);
+    tree.update();
+    EXPECT_FLOAT_EQ(10, tree.worldOf(grandchild).tx);
+    EXPECT_FLOAT_EQ(5, tree.worldOf(grandchild).ty);
+}
+
+TEST(TransformHierarchy, SetParentRejectsCycles) {
+    TransformHierarchy tree;
+    auto a = tree.create();
+    auto b = tree.create(a);
+    auto c = tree.create(b);
+    auto other = tree.create();
+    EXPECT_FALSE(tree.setParent(a, a));
+    EXPECT_FALSE(tree.setParent(a, b));
+    EXPECT_FALSE(tree.setParent(a, c));
+    EXPECT_TRUE(tree.setParent(c, other));
+    EXPECT_TRUE(tree.setParent(a, c));
+    // Sorting terminates and a now hangs under other via c.
+    tree.setLocal(other, 7, 0, 0, 1);
+    tree.update();
+    EXPECT_FLOAT_EQ(7, tree.worldOf(a).tx);
+    EXPECT_FLOAT_EQ(7, tree.worldOf(b).tx);
+}
+
+TEST(TransformHierarchy, DestroyRemovesTheSubtree) {
+    TransformHierarchy tree;
+    auto root = tree.create();
+    auto child = tree.create(root);
+    tree.create(child);
+    auto keep = tree.create();
+    tree.setLocal(keep, 3, 4, 0, 1);
+    tree.destroy(child);
+    tree.update();
+    EXPECT_EQ(2u, tree.size());
+    EXPECT_FLOAT_EQ(3, tree.worldOf(keep).tx);
+}
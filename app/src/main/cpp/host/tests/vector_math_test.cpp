@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+
+#include "vector_math.h"
+
+/*
+ * The SIMD paths (whichever this build compiles in) against plain scalar
+ * references, over random inputs. Also built with -mavx as
+ * vector_math_avx_tests when the host can run it.
+ */
+
+namespace {
+    // Summation order differs between paths, so compare relative to the
+    // magnitude of the terms.
+    const float tolerance = 1e-5f;
+
+    struct Random {
+        std::mt19937 rng{11};
+        std::uniform_real_distribution<float> u{-10, 10};
+
+        float operator()() { return u(rng); }
+
+        Vec4 vec4() { return Vec4{u(rng), u(rng), u(rng), u(rng)}; }
+
+        Mat4 mat4() {
+            Mat4 m;
+            for (float &f: m.m) {
+                f = u(rng);
+            }
+            return m;
+        }
+
+        Quat quat() {
+            return Quat::fromAxisAngle(Vec3{u(rng), u(rng), u(rng) + 20}, u(rng));
+        }
+    };
+
+    Vec4 refMul(const Mat4 &a, const Vec4 &v) {
+        const float in[4] = {v.x, v.y, v.z, v.w};
+        float out[4];
+        for (int row = 0; row < 4; row++) {
+            out[row] = 0;
+            for (int k = 0; k < 4; k++) {
+                out[row] += a.m[k * 4 + row] * in[k];
+            }
+        }
+        return Vec4{out[0], out[1], out[2], out[3]};
+    }
+
+    Mat4 refMul(const Mat4 &a, const Mat4 &b) {
+        Mat4 r;
+        for (int c = 0; c < 4; c++) {
+            for (int row = 0; row < 4; row++) {
+                r.m[c * 4 + row] = 0;
+                for (int k = 0; k < 4; k++) {
+                    r.m[c * 4 + row] += a.m[k * 4 + row] * b.m[c * 4 + k];
+                }
+            }
+        }
+        return r;
+    }
+
+    void expectNear(const float *expected, const float *actual, int n, float scale) {
+        for (int i = 0; i < n; i++) {
+            EXPECT_NEAR(expected[i], actual[i], tolerance * scale) << "element " << i;
+        }
+    }
+}
+
+// The scalar paths are what constant evaluation uses.
+static_assert(Mat4::identity() * Mat4::translation({1, 2, 3}) == Mat4::translation({1, 2, 3}));
+static_assert(Mat4::translation({1, 2, 3}) * Vec4{0, 0, 0, 1} == Vec4{1, 2, 3, 1});
+static_assert(dot(Vec4{1, 2, 3, 4}, Vec4{4, 3, 2, 1}) == 20);
+static_assert(Vec4{1, 2, 3, 4} - Vec4{1, 1, 1, 1} == Vec4{0, 1, 2, 3});
+static_assert(transpose(transpose(Mat4::translation({4, 5, 6}))) == Mat4::translation({4, 5, 6}));
+static_assert(rotate(Quat::identity(), Vec3{1, 2, 3}) == Vec3{1, 2, 3});
+
+TEST(VectorMath, Vec4OpsMatchScalar) {
+    Random random;
+    for (int i = 0; i < 10000; i++) {
+        Vec4 a = random.vec4(), b = random.vec4();
+        float s = random();
+        EXPECT_EQ((Vec4{a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w}), a + b);
+        EXPECT_EQ((Vec4{a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w}), a - b);
+        EXPECT_EQ((Vec4{a.x * s, a.y * s, a.z * s, a.w * s}), a * s);
+        EXPECT_NEAR(a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w, dot(a, b),
+                    tolerance * 400);
+    }
+}
+
+TEST(VectorMath, Mat4TimesVec4MatchesScalar) {
+    Random random;
+    for (int i = 0; i < 10000; i++) {
+        Mat4 m = random.mat4();
+        Vec4 v = random.vec4();
+        Vec4 expected = refMul(m, v), actual = m * v;
+        expectNear(&expected.x, &actual.x, 4, 400);
+    }
+}
+
+TEST(VectorMath, Mat4TimesMat4MatchesScalar) {
+    Random random;
+    for (int i = 0; i < 10000; i++) {
+        Mat4 a = random.mat4(), b = random.mat4();
+        Mat4 expected = refMul(a, b), actual = a * b;
+        expectNear(expected.m, actual.m, 16, 400);
+    }
+}
+
+TEST(VectorMath, QuaternionsMatchMatrices) {
+    Random random;
+    for (int i = 0; i < 10000; i++) {
+        Quat a = random.quat(), b = random.quat();
+        Vec3 v{random(), random(), random()};
+        Vec4 viaMatrix = toMat4(a * b) * Vec4{v.x, v.y, v.z, 1};
+        Vec3 viaQuat = rotate(a, rotate(b, v));
+        EXPECT_NEAR(viaMatrix.x, viaQuat.x, 1e-3f);
+        EXPECT_NEAR(viaMatrix.y, viaQuat.y, 1e-3f);
+        EXPECT_NEAR(viaMatrix.z, viaQuat.z, 1e-3f);
+        Quat half = slerp(a, b, 0.5f);
+        EXPECT_NEAR(1, dot(half, half), 1e-5f);
+    }
+}
@@ -0,0 +1,170 @@
+#include "jni_bridge.h"
+
+#include <android/native_activity.h>
+#include <pthread.h>
+
+#include "logging.h"
+
+namespace {
+    JavaVM *vm = nullptr;
+    jobject activityObject = nullptr;
+    jobject classLoader = nullptr;
+    jmethodID loadClassMethod = nullptr;
+    jmethodID getIntentMethod = nullptr;
+    jmethodID getStringExtraMethod = nullptr;
+    std::string package;
+
+    /**
+     * Per-thread attachment; detaches when the thread exits, which the VM
+     * requires of every thread it attached.
+     */
+    struct Attachment {
+        JNIEnv *env = nullptr;
+        bool attached = false;
+
+        ~Attachment() {
+            if (attached && vm) {
+                vm->DetachCurrentThread();
+            }
+        }
+    };
+
+    thread_local Attachment attachment;
+}
+
+bool Jni::init(ANativeActivity *activity) {
+    vm = activity->vm;
+    activityObject = activity->clazz;
+    JNIEnv *e = env();
+    if (!e) {
+        return false;
+    }
+    jclass activityClass = e->GetObjectClass(activityObject);
+    jmethodID getPackageName = e->GetMethodID(activityClass, "getPackageName",
+                                              "()Ljava/lang/String;");
+    jmethodID getClassLoader = e->GetMethodID(activityClass, "getClassLoader",
+                                              "()Ljava/lang/ClassLoader;");
+    getIntentMethod = e->GetMethodID(activityClass, "getIntent", "()Landroid/content/Intent;");
+    e->DeleteLocalRef(activityClass);
+    if (checkException(e) || !getPackageName || !getClassLoader) {
+        return false;
+    }
+    jclass intentClass = e->FindClass("android/content/Intent");
+    if (intentClass) {
+        getStringExtraMethod = e->GetMethodID(intentClass, "getStringExtra",
+                                              "(Ljava/lang/String;)Ljava/lang/String;");
+        e->DeleteLocalRef(intentClass);
+    }
+    checkException(e);
+    package = callString(activityObject, getPackageName);
+    jobject loader = callObject(activityObject, getClassLoader);
+    if (loader) {
+        classLoader = e->NewGlobalRef(loader);
+        jclass loaderClass = e->GetObjectClass(loader);
+        loadClassMethod = e->GetMethodID(loaderClass, "loadClass",
+                                         "(Ljava/lang/String;)Ljava/lang/Class;");
+        e->DeleteLocalRef(loaderClass);
+        e->DeleteLocalRef(loader);
+        checkException(e);
+    }
+    return true;
+}
+
+void Jni::shutdown() {
+    if (classLoader) {
+        env()->DeleteGlobalRef(classLoader);
+        classLoader = nullptr;
+    }
+    loadClassMethod = nullptr;
+    getIntentMethod = nullptr;
+    getStringExtraMethod = nullptr;
+    activityObject = nullptr;
+}
+
+JNIEnv *Jni::env() {
+    if (attachment.env || !vm) {
+        return attachment.env;
+    }
+    if (vm->GetEnv((void **) &attachment.env, JNI_VERSION_1_6) == JNI_EDETACHED) {
+        // Attach under the thread's own name so it reads well in traces.
+        char name[16] = "native";
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        JavaVMAttachArgs args{JNI_VERSION_1_6, name, nullptr};
+        if (vm->AttachCurrentThread(&attachment.env, &args) != JNI_OK) {
+            LOGW("jni: AttachCurrentThread failed");
+            attachment.env = nullptr;
+            return nullptr;
+        }
+        attachment.attached = true;
+    }
+    return attachment.env;
+}
+
+jobject Jni::activity() { return activityObject; }
+
+const std::string &Jni::packageName() { return package; }
+
+std::string Jni::intentExtra(const char *name) {
+    JNIEnv *e = env();
+    if (!e || !activityObject || !getIntentMethod || !getStringExtraMethod) {
+        return std::string();
+    }
+    jobject intent = callObject(activityObject, getIntentMethod);
+    if (!intent) {
+        return std::string();
+    }
+    jstring key = e->NewStringUTF(name);
+    std::string value = callString(intent, getStringExtraMethod, key);
+    e->DeleteLocalRef(key);
+    e->DeleteLocalRef(intent);
+    return value;
+}
+
+jclass Jni::findClass(const char *name) {
+    if (!classLoader) {
+        return nullptr;
+    }
+    JNIEnv *e = env();
+    jstring jname = e->NewStringUTF(name);
+    jobject cls = callObject(classLoader, loadClassMethod, jname);
+    e->DeleteLocalRef(jname);
+    if (!cls) {
+        return nullptr;
+    }
+    auto global = (jclass) e->NewGlobalRef(cls);
+    e->DeleteLocalRef(cls);
+    return global;
+}
+
+jmethodID Jni::method(jclass cls, const char *name, const char *signature) {
+    JNIEnv *e = env();
+    jmethodID m = e->GetMethodID(cls, name, signature);
+    if (checkException(e)) {
+        LOGW("jni: no method %s%s", name, signature);
+        return nullptr;
+    }
+    return m;
+}
+
+bool Jni::checkException(JNIEnv *e) {
+    if (!e->ExceptionCheck()) {
+        return false;
+    }
+    e->ExceptionDescribe();
+    e->ExceptionClear();
+    return true;
+}
+
+std::string Jni::toString(jobject str) {
+    if (!str) {
+        return std::string();
+    }
+    JNIEnv *e = env();
+    const char *chars = e->GetStringUTFChars((jstring) str, nullptr);
+    std::string result(chars ? chars : "");
+    if (chars) {
+        e->ReleaseStringUTFChars((jstring) str, chars);
+    }
+    e->DeleteLocalRef(str);
+    return result;
+}
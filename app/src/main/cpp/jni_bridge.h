@@ -0,0 +1,121 @@
+#pragma once
+
+#include <jni.h>
+
+#include <string>
+
+struct ANativeActivity;
+
+/**
+ * Java interop for native threads.
+ * Each thread is attached to the VM once, on its first env() call, and
+ * detached automatically when it exits. init() caches the activity's
+ * class, class loader and the method IDs used here as global references,
+ * along with constant results such as the package name, so later calls
+ * skip every lookup. Classes must come from findClass(): JNI FindClass on
+ * a native thread only sees system classes.
+ */
+namespace Jni {
+    /**
+     * Cache everything the bridge needs; call once from the glue thread.
+     */
+    bool init(ANativeActivity *activity);
+
+    /**
+     * Drop the global references; the activity is going away.
+     */
+    void shutdown();
+
+    /**
+     * @return the calling thread's JNIEnv, attaching it on first use
+     */
+    JNIEnv *env();
+
+    /**
+     * @return the activity object (a global reference owned by NativeActivity)
+     */
+    jobject activity();
+
+    const std::string &packageName();
+
+    /**
+     * @return a string extra of the intent that started the activity, or
+     * an empty string
+     */
+    std::string intentExtra(const char *name);
+
+    /**
+     * Load an app class through the activity's class loader.
+     * @param name binary name, e.g. "com.example.Foo"
+     * @return a global reference the caller owns, or nullptr
+     */
+    jclass findClass(const char *name);
+
+    jmethodID method(jclass cls, const char *name, const char *signature);
+
+    /**
+     * Log and clear a pending Java exception.
+     * @return true if there was one
+     */
+    bool checkException(JNIEnv *env);
+
+    /*
+     * Typed instance calls; a Java exception is logged, cleared and turns
+     * into a zero result.
+     */
+
+    template<typename... Args>
+    void callVoid(jobject obj, jmethodID m, Args... args) {
+        JNIEnv *e = env();
+        e->CallVoidMethod(obj, m, args...);
+        checkException(e);
+    }
+
+    template<typename... Args>
+    jboolean callBoolean(jobject obj, jmethodID m, Args... args) {
+        JNIEnv *e = env();
+        jboolean r = e->CallBooleanMethod(obj, m, args...);
+        return checkException(e) ? 0 : r;
+    }
+
+    template<typename... Args>
+    jint callInt(jobject obj, jmethodID m, Args... args) {
+        JNIEnv *e = env();
+        jint r = e->CallIntMethod(obj, m, args...);
+        return checkException(e) ? 0 : r;
+    }
+
+    template<typename... Args>
+    jlong callLong(jobject obj, jmethodID m, Args... args) {
+        JNIEnv *e = env();
+        jlong r = e->CallLongMethod(obj, m, args...);
+        return checkException(e) ? 0 : r;
+    }
+
+    template<typename... Args>
+    jfloat callFloat(jobject obj, jmethodID m, Args... args) {
+        JNIEnv *e = env();
+        jfloat r = e->CallFloatMethod(obj, m, args...);
+        return checkException(e) ? 0 : r;
+    }
+
+    /**
+     * @return a local reference, or nullptr
+     */
+    template<typename... Args>
+    jobject callObject(jobject obj, jmethodID m, Args... args) {
+        JNIEnv *e = env();
+        jobject r = e->CallObjectMethod(obj, m, args...);
+        return checkException(e) ? nullptr : r;
+    }
+
+    /**
+     * Convert a java.lang.String result, releasing its local reference.
+     */
+    std::string toString(jobject str);
+
+    template<typename... Args>
+    std::string callString(jobject obj, jmethodID m, Args... args) {
+        return toString(callObject(obj, m, args...));
+    }
+}
@@ -0,0 +1,287 @@
+#include "job_system.h"
+
+#include <algorithm>
+
+#include "logging.h"
+
+namespace {
+    // The job system the calling thread takes part in, and its participant
+    // index there; a thread owns deques in at most one system.
+    struct Participation {
+        const JobSystem *system;
+        int index;
+    };
+
+    thread_local Participation participation{nullptr, -1};
+
+    /**
+     * @return the calling thread's participant index in system, or -1 if it
+     * is not one of its participants
+     */
+    inline int participantIndex(const JobSystem *system, size_t participants) {
+        auto index = participation.system == system ? participation.index : -1;
+        return index >= 0 && index < (int) participants ? index : -1;
+    }
+
+    // Busy-poll this many times before a worker goes to sleep.
+    const int spinsBeforeSleep = 64;
+}
+
+void WorkStealingDeque::Cell::store(const Job &job) {
+    func.store(job.func, std::memory_order_relaxed);
+    data.store(job.data, std::memory_order_relaxed);
+    begin.store(job.begin, std::memory_order_relaxed);
+    end.store(job.end, std::memory_order_relaxed);
+    counter.store(job.counter, std::memory_order_relaxed);
+}
+
+Job WorkStealingDeque::Cell::load() const {
+    return Job{func.load(std::memory_order_relaxed), data.load(std::memory_order_relaxed),
+               begin.load(std::memory_order_relaxed), end.load(std::memory_order_relaxed),
+               counter.load(std::memory_order_relaxed)};
+}
+
+bool WorkStealingDeque::push(const Job &job) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    if (b - t >= capacity) {
+        return false;
+    }
+    cells[b & mask].store(job);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+    return true;
+}
+
+bool WorkStealingDeque::pop(Job &job) {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+    if (t > b) {
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return false;
+    }
+    job = cells[b & mask].load();
+    bool taken = true;
+    if (t == b) {
+        // Last item: race any thief for it.
+        taken = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                            std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return taken;
+}
+
+bool WorkStealingDeque::steal(Job &job) {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+        return false;
+    }
+    job = cells[t & mask].load();
+    return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed);
+}
+
+void JobSystem::start(uint32_t threadCount) {
+    topology.load();
+    auto &cores = topology.getCores();
+    if (threadCount == 0) {
+        threadCount = std::max<uint32_t>(1, (uint32_t) cores.size());
+    }
+    stopping = false;
+    started = 0;
+    participants.clear();
+    for (uint32_t i = 0; i < threadCount; i++) {
+        participants.emplace_back(new Participant());
+    }
+    participation = {this, 0};
+    // Core 0 of the sorted list (a big core) is left to the calling thread;
+    // workers take the following cores, wrapping if oversubscribed.
+    for (uint32_t i = 1; i < threadCount; i++) {
+        std::vector<int> cpus;
+        if (!cores.empty()) {
+            auto &core = cores[i % cores.size()];
+            participants[i]->big = topology.isBig(core);
+            cpus = topology.clusterOf(core);
+        }
+        threads.emplace_back(&JobSystem::workerMain, this, i, cpus);
+    }
+    {
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this, threadCount] { return started.load() == threadCount - 1; });
+    }
+    LOGI("job system: %u threads on %zu cores (%zu big)", threadCount, cores.size(),
+         topology.bigCores().size());
+}
+
+void JobSystem::stop() {
+    if (threads.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &t: threads) {
+        t.join();
+    }
+    threads.clear();
+    // Whoever queued background work is still waiting for it.
+    Job job;
+    while (takeBackground(job)) {
+        execute(job);
+    }
+}
+
+void JobSystem::workerMain(uint32_t index, std::vector<int> cpus) {
+    participation = {this, (int) index};
+    if (!cpus.empty() && !CpuTopology::pinCurrentThread(cpus)) {
+        LOGW("job system: unable to pin worker %u", index);
+    }
+    if (onWorkerStart) {
+        onWorkerStart(index);
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        started++;
+    }
+    // Wakes start(); idle workers woken with it go back to sleep.
+    wake.notify_all();
+    int spins = 0;
+    Job job;
+    while (!stopping.load(std::memory_order_relaxed)) {
+        if (findJob(index, job) || takeBackground(job)) {
+            execute(job);
+            spins = 0;
+            continue;
+        }
+        if (++spins < spinsBeforeSleep) {
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepers++;
+        // sleepers/queued are seq_cst so submit() cannot miss a sleeping worker.
+        wake.wait(lock, [this] {
+            return stopping.load(std::memory_order_relaxed) || queued.load() > 0;
+        });
+        sleepers--;
+        spins = 0;
+    }
+    if (onWorkerExit) {
+        onWorkerExit(index);
+    }
+}
+
+bool JobSystem::findJob(uint32_t self, Job &job) {
+    auto &own = *participants[self];
+    if (own.critical.pop(job) || own.normal.pop(job)) {
+        return true;
+    }
+    auto count = (uint32_t) participants.size();
+    for (uint32_t n = 1; n < count; n++) {
+        auto &victim = *participants[(self + n) % count];
+        if ((own.big && victim.critical.steal(job)) || victim.normal.steal(job)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JobSystem::takeBackground(Job &job) {
+    if (backgroundCount.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(backgroundMutex);
+    uint32_t count = backgroundCount.load(std::memory_order_relaxed);
+    if (count == 0) {
+        return false;
+    }
+    job = background[backgroundHead];
+    backgroundHead = (backgroundHead + 1) % backgroundCapacity;
+    backgroundCount.store(count - 1, std::memory_order_relaxed);
+    return true;
+}
+
+void JobSystem::execute(const Job &job) {
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    job.func(job.data, job.begin, job.end);
+    if (job.counter) {
+        job.counter->pending.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void JobSystem::submit(JobFunc func, void *data, uint32_t begin, uint32_t end,
+                       JobCounter *counter, bool latencyCritical) {
+    if (counter) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    int index = participantIndex(this, participants.size());
+    if (index < 0) {
+        // Not one of ours (or not started): just run it here.
+        func(data, begin, end);
+        if (counter) {
+            counter->pending.fetch_sub(1, std::memory_order_release);
+        }
+        return;
+    }
+    auto &own = *participants[index];
+    Job job{func, data, begin, end, counter};
+    queued.fetch_add(1);
+    auto &deque = latencyCritical ? own.critical : own.normal;
+    if (!deque.push(job)) {
+        execute(job);
+        return;
+    }
+    if (sleepers.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wake.notify_one();
+    }
+}
+
+void JobSystem::submitBackground(JobFunc func, void *data) {
+    Job job{func, data, 0, 1, nullptr};
+    bool pushed = false;
+    if (threads.size() > 0) {
+        std::lock_guard<std::mutex> lock(backgroundMutex);
+        uint32_t count = backgroundCount.load(std::memory_order_relaxed);
+        if (count < backgroundCapacity) {
+            background[(backgroundHead + count) % backgroundCapacity] = job;
+            backgroundCount.store(count + 1, std::memory_order_relaxed);
+            pushed = true;
+        }
+    }
+    if (!pushed) {
+        func(data, 0, 1);
+        return;
+    }
+    queued.fetch_add(1);
+    if (sleepers.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wake.notify_one();
+    }
+}
+
+void JobSystem::parallelFor(uint32_t count, uint32_t grain, JobFunc func, void *data,
+                            JobCounter *counter, bool latencyCritical) {
+    grain = std::max<uint32_t>(1, grain);
+    for (uint32_t begin = 0; begin < count; begin += grain) {
+        submit(func, data, begin, std::min(count, begin + grain), counter, latencyCritical);
+    }
+}
+
+void JobSystem::wait(JobCounter *counter) {
+    Job job;
+    int index = participantIndex(this, participants.size());
+    while (!counter->done()) {
+        if (index >= 0 && findJob((uint32_t) index, job)) {
+            execute(job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
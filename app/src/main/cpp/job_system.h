@@ -0,0 +1,173 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "cpu_topology.h"
+
+typedef void (*JobFunc)(void *data, uint32_t begin, uint32_t end);
+
+/**
+ * Completion counter; a group of jobs is done when it reaches zero.
+ */
+struct JobCounter {
+    std::atomic<uint32_t> pending{0};
+
+    inline bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+struct Job {
+    JobFunc func;
+    void *data;
+    uint32_t begin;
+    uint32_t end;
+    JobCounter *counter;
+};
+
+/**
+ * Chase-Lev work-stealing deque with a fixed capacity.
+ * The owning thread pushes and pops at the bottom; any thread may steal from
+ * the top. push() fails instead of growing, and the caller then runs the job
+ * inline, so the deque never allocates after construction.
+ * Jobs are copied in and out by value, so a slot is free again as soon as
+ * its job has been taken, however long that job runs.
+ */
+class WorkStealingDeque {
+private:
+    static const int64_t capacity = 1024;
+    static const int64_t mask = capacity - 1;
+
+    // A thief may copy a slot the owner is rewriting after the deque
+    // wrapped; it then loses the race on top and drops the copy. The
+    // fields are relaxed atomics so that torn copy is not a data race.
+    struct Cell {
+        std::atomic<JobFunc> func;
+        std::atomic<void *> data;
+        std::atomic<uint32_t> begin;
+        std::atomic<uint32_t> end;
+        std::atomic<JobCounter *> counter;
+
+        void store(const Job &job);
+
+        Job load() const;
+    };
+
+    std::atomic<int64_t> top{0};
+    std::atomic<int64_t> bottom{0};
+    Cell cells[capacity];
+
+public:
+    bool push(const Job &job);
+
+    bool pop(Job &job);
+
+    bool steal(Job &job);
+};
+
+/**
+ * Work-stealing job system with one deque pair per thread.
+ * The thread that calls start() becomes participant 0 and helps execute
+ * jobs while it waits; the remaining participants are worker threads,
+ * each pinned to the cluster of the core it was placed on (big cores
+ * first, per CpuTopology). Latency-critical jobs go to a separate deque
+ * that only big-core participants steal from, so they never get stuck
+ * behind a little core.
+ * Jobs submitted from any other thread, including the workers of another
+ * JobSystem, simply run inline.
+ * Background jobs (blocking I/O and the like) go to a shared queue that
+ * only worker threads drain; wait() never picks them up, so a frame that
+ * waits on its own jobs cannot end up stuck behind a file read.
+ */
+class JobSystem {
+private:
+    struct Participant {
+        WorkStealingDeque critical;
+        WorkStealingDeque normal;
+        bool big = true;
+    };
+
+    static const uint32_t backgroundCapacity = 256;
+
+    CpuTopology topology;
+    std::vector<std::unique_ptr<Participant>> participants;
+    std::mutex backgroundMutex;
+    Job background[backgroundCapacity];
+    uint32_t backgroundHead = 0;
+    std::atomic<uint32_t> backgroundCount{0};
+    std::vector<std::thread> threads;
+    std::atomic<bool> stopping{false};
+    std::atomic<uint32_t> queued{0};
+    std::atomic<uint32_t> sleepers{0};
+    std::atomic<uint32_t> started{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+
+    bool findJob(uint32_t self, Job &job);
+
+    bool takeBackground(Job &job);
+
+    void execute(const Job &job);
+
+    void workerMain(uint32_t index, std::vector<int> cpus);
+
+public:
+    // Run on each worker thread as it starts and right before it exits.
+    std::function<void(uint32_t index)> onWorkerStart;
+    std::function<void(uint32_t index)> onWorkerExit;
+
+    ~JobSystem() { stop(); }
+
+    /**
+     * Spawn workers and wait until each has run onWorkerStart. threadCount
+     * includes the calling thread; 0 means one participant per online core.
+     */
+    void start(uint32_t threadCount = 0);
+
+    void stop();
+
+    inline uint32_t threadCount() const { return (uint32_t) participants.size(); }
+
+    inline const CpuTopology &getTopology() const { return topology; }
+
+    /**
+     * Queue func(data, begin, end) on the calling participant's deque.
+     */
+    void submit(JobFunc func, void *data, uint32_t begin, uint32_t end, JobCounter *counter,
+                bool latencyCritical = false);
+
+    /**
+     * Queue func(data, 0, 1) for a worker thread, from any thread. Runs it
+     * inline when there are no workers or the queue is full.
+     */
+    void submitBackground(JobFunc func, void *data);
+
+    /**
+     * Split [0, count) into chunks of at most grain items and queue one job per chunk.
+     */
+    void parallelFor(uint32_t count, uint32_t grain, JobFunc func, void *data,
+                     JobCounter *counter, bool latencyCritical = false);
+
+    /**
+     * Functor variant of parallelFor(); body(begin, end) must outlive the counter.
+     */
+    template<typename F>
+    void parallelFor(uint32_t count, uint32_t grain, F &body, JobCounter *counter,
+                     bool latencyCritical = false) {
+        parallelFor(count, grain, [](void *data, uint32_t begin, uint32_t end) {
+            (*static_cast<F *>(data))(begin, end);
+        }, &body, counter, latencyCritical);
+    }
+
+    /**
+     * Run queued jobs on the calling thread until the counter reaches zero.
+     * Background jobs are left to the workers.
+     */
+    void wait(JobCounter *counter);
+};
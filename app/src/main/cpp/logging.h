@@ -0,0 +1,16 @@
+#pragma once
+
+#if defined(__ANDROID__)
+#include <android/log.h>
+
+#define LOGI(...) \
+  ((void)__android_log_print(ANDROID_LOG_INFO, "native-activity", __VA_ARGS__))
+#define LOGW(...) \
+  ((void)__android_log_print(ANDROID_LOG_WARN, "native-activity", __VA_ARGS__))
+#else
+// Host builds of the platform-independent modules log to stderr.
+#include <cstdio>
+
+#define LOGI(...) ((void)fprintf(stderr, __VA_ARGS__), (void)fputc('\n', stderr))
+#define LOGW(...) ((void)fprintf(stderr, __VA_ARGS__), (void)fputc('\n', stderr))
+#endif
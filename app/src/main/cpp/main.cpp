@@ -18,31 +18,51 @@
 #include <EGL/egl.h>
 #include <GLES/gl.h>
 #include <android/log.h>
+#include <android/native_window.h>
 #include <android/sensor.h>
 #include <android_native_app_glue.h>
 #include <jni.h>
 
 #include <cassert>
 #include <cerrno>
+#include <cstddef>
 #include <cstdlib>
 #include <cstring>
 #include <initializer_list>
 #include <memory>
-#include <dlfcn.h>
+#include <string>
+
+// 1 builds the pre-cache JNI lookups, to measure time to first frame against.
+#ifndef ENGINE_JNI_BASELINE
+#define ENGINE_JNI_BASELINE 0
+#endif
 
-#define LOGI(...) \
-  ((void)__android_log_print(ANDROID_LOG_INFO, "native-activity", __VA_ARGS__))
-#define LOGW(...) \
-  ((void)__android_log_print(ANDROID_LOG_WARN, "native-activity", __VA_ARGS__))
+#if ENGINE_JNI_BASELINE
+#include <dlfcn.h>
+#endif
+
+#include "audio_engine.h"
+#include "engine_clock.h"
+#include "frame_loop.h"
+#include "gpu_resources.h"
+#include "jni_bridge.h"
+#include "job_system.h"
+#include "logging.h"
+#include "mem_tracker.h"
+#include "perf_counters.h"
+#include "performance_hint.h"
+#include "scene.h"
+#include "sensor_events.h"
+#include "session_replay.h"
+#include "startup_graph.h"
+#include "startup_trace.h"
+#include "task.h"
+#include "thermal_governor.h"
+#include "texture_residency.h"
+#include "thread_manager.h"
 
 class Engine {
 private:
-    typedef struct SavedState_ {
-        float angle;
-        int32_t x;
-        int32_t y;
-    } SavedState;
-
     struct Context {
         struct android_app *app;
         ASensorManager *sensorManager;
@@ -54,30 +74,103 @@ private:
         EGLContext context;
         int32_t width;
         int32_t height;
-        SavedState state;
+        int32_t format;
     } ctx;
 
+    // Every GL object and where it came from, so all of them come back
+    // after the context is lost.
+    GpuResources gpu;
+    // Streamed textures; the renderer reports their on-screen size.
+    TextureResidency textures;
+
+    // What is simulated and drawn; the engine feeds it input and time.
+    Scene scene;
+
+    // Coroutines resumed from the frame loop; declared before the job system
+    // so workers are joined before any task frame is destroyed.
+    Scheduler scheduler;
+
+    // Sheds frame rate, resolution and sensor rate as the device heats up.
+    // Sampled by background jobs, so declared before the job system.
+    ThermalGovernor thermal;
+
+    ThreadManager threads;
+    JobSystem jobs;
+
+    // Tells the CPU governor how much work each frame takes.
+    PerformanceHint hint;
+    int64_t frameStartNs = 0;
+    bool firstFrameShown = false;
+
+    // The per-frame work, shared with the headless replay runner. It owns
+    // the touch blips, so it is declared before the output playing them.
+    FrameLoop frame;
+
+    // Background music decoded on the I/O thread. Declared before the
+    // streamer and the output so both stop reading it before it goes away.
+    std::unique_ptr<AudioStream> music;
+    AudioStreamer streamer;
+
+    // Low-latency output; the frame loop plays a short blip on touch.
+    AudioEngine audio;
+
+    // Input capture and playback for perf scenarios, driven by intent extras.
+    SessionRecorder recorder;
+    SessionReplay replay;
+    SessionReplay::Pacing replayPacing = SessionReplay::Pacing::Recorded;
+
+    // Launch-time initialization; declared last so that its destructor,
+    // which waits for nodes still running on workers, runs first.
+    StartupGraph startup;
+    StartupGraph::NodeId windowGate = 0;
+    bool focused = false;
+
 public:
     inline bool isAnimating() const { return ctx.animating; }
 
+    /**
+     * How long the looper may block: not at all while animating, briefly
+     * while tasks are pending, otherwise until the next event arrives.
+     */
+    inline int pollTimeoutMs() const {
+        return ctx.animating ? 0 : scheduler.pending() ? 4 : -1;
+    }
+
     void init(struct android_app *state) {
+        StartupTrace::mark(Milestone::EngineInit);
+        StartupTrace::setVariant(ENGINE_JNI_BASELINE ? "jni-uncached" : "jni-cached");
         memset(&ctx, 0, sizeof(ctx));
         ctx.app = state;
-        ctx.sensorManager = acquireASensorManagerInstance();
-        ctx.accelerometerSensor = ASensorManager_getDefaultSensor(ctx.sensorManager,
-                                                                  ASENSOR_TYPE_ACCELEROMETER);
-        ctx.sensorEventQueue = ASensorManager_createEventQueue(ctx.sensorManager, state->looper,
-                                                               LOOPER_ID_USER, nullptr, nullptr);
-        if (state->savedState != nullptr) {
-            // We are starting with a previous saved state; restore from it.
-            ctx.state = *(SavedState *) state->savedState;
-        }
+        threads.init();
+        threads.registerCurrentThread(ThreadRole::Main, "engine-main");
+        jobs.onWorkerStart = [this](uint32_t) {
+            threads.registerCurrentThread(ThreadRole::Worker, "engine-worker");
+        };
+        jobs.onWorkerExit = [this](uint32_t) { threads.unregisterCurrentThread(); };
+        jobs.start();
+        scheduler.init(&jobs);
+        MemTracker::setBudget(MemTag::Renderer, 16 * 1024 * 1024);
+        MemTracker::setBudget(MemTag::Assets, 32 * 1024 * 1024);
+        MemTracker::setBudget(MemTag::Audio, 8 * 1024 * 1024);
+        MemTracker::setBudget(MemTag::Input, 256 * 1024);
+        MemTracker::setBudget(MemTag::Sensors, 256 * 1024);
+        gpu.setAssetManager(state->activity->assetManager);
+        textures.setAssetManager(state->activity->assetManager);
+        scene.init(&gpu, &jobs);
+        frame.init({&scene, &gpu, &textures, &thermal, &scheduler, &jobs, &replay, &audio});
+        frame.present = [this]() { present(); };
+        frame.onQualityChange = [this]() { applyQuality(); };
+        buildStartupGraph(state);
+        startup.onMainReady = [state]() { ALooper_wake(state->looper); };
+        startup.start(&jobs);
+        startup.runMainReady();
     }
 
     /**
      * Initialize an EGL context for the current display.
      */
     int initDisplay() {
+        MemTagScope tag(MemTag::Renderer);
         /*
          * Here specify the attributes of the desired configuration.
          * Below, we select an EGLConfig with at least 8 bits per color
@@ -97,6 +190,7 @@ public:
         EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
 
         eglInitialize(display, nullptr, nullptr);
+        StartupTrace::mark(Milestone::EglInitialize);
 
         /* Here, the application chooses the configuration it desires.
          * find the best match if possible, otherwise use the very first one
@@ -128,12 +222,15 @@ public:
             LOGW("Unable to initialize EGLConfig");
             return -1;
         }
+        StartupTrace::mark(Milestone::EglConfig);
 
         /* EGL_NATIVE_VISUAL_ID is an attribute of the EGLConfig that is
          * guaranteed to be accepted by ANativeWindow_setBuffersGeometry().
          * As soon as we picked a EGLConfig, we can safely reconfigure the
          * ANativeWindow buffers to match, using EGL_NATIVE_VISUAL_ID. */
         eglGetConfigAttrib(display, config, EGL_NATIVE_VISUAL_ID, &format);
+        // Start from the window's own size; applyQuality() scales it down if needed.
+        ANativeWindow_setBuffersGeometry(ctx.app->window, 0, 0, format);
         surface = eglCreateWindowSurface(display, config, ctx.app->window, nullptr);
         context = eglCreateContext(display, config, nullptr, nullptr);
 
@@ -141,6 +238,8 @@ public:
             LOGW("Unable to eglMakeCurrent");
             return -1;
         }
+        StartupTrace::mark(Milestone::EglContext);
+        scheduler.setDisplay(display);
 
         eglQuerySurface(display, surface, EGL_WIDTH, &w);
         eglQuerySurface(display, surface, EGL_HEIGHT, &h);
@@ -150,7 +249,8 @@ public:
         ctx.surface = surface;
         ctx.width = w;
         ctx.height = h;
-        ctx.state.angle = 0;
+        ctx.format = format;
+        scene.resize(w, h);
 
         // Check openGL on the system
         auto opengl_info = {GL_VENDOR, GL_RENDERER, GL_VERSION, GL_EXTENSIONS};
@@ -160,10 +260,11 @@ public:
         }
 
         // Initialize GL state.
-        glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_FASTEST);
-        glEnable(GL_CULL_FACE);
-        glShadeModel(GL_SMOOTH);
-        glDisable(GL_DEPTH_TEST);
+        scene.initGl();
+        frame.setDrawable(true);
+        gpu.onContextReady();
+        textures.onContextReady();
+        applyQuality();
         return 0;
     }
 
@@ -171,7 +272,12 @@ public:
      * Tear down the EGL context currently associated with the display.
      */
     void termDisplay() {
+        frame.setDrawable(false);
+        scheduler.onDisplayLost();
         if (ctx.display != EGL_NO_DISPLAY) {
+            logGpuStats();
+            gpu.onContextLost();
+            textures.onContextLost();
             eglMakeCurrent(ctx.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
             if (ctx.context != EGL_NO_CONTEXT) {
                 eglDestroyContext(ctx.display, ctx.context);
@@ -185,50 +291,100 @@ public:
         ctx.display = EGL_NO_DISPLAY;
         ctx.context = EGL_NO_CONTEXT;
         ctx.surface = EGL_NO_SURFACE;
+        MemTracker::dumpReport("termDisplay");
+        recorder.flush();
+        PerfCounters::emit("termDisplay");
+        if (startup.done()) {
+            logAudioStats();
+        }
     }
 
     /**
      * Just the current frame in the display.
      */
-    void drawFrame() const {
-        if (ctx.display == nullptr) {
-            // No display.
-            return;
+    void drawFrame() {
+        frame.draw();
+    }
+
+    /**
+     * Show the frame the loop just recorded.
+     */
+    void present() {
+        if (frameStartNs) {
+            // Report before swapping: time blocked on vsync is not work.
+            hint.reportWork(monotonicNs() - frameStartNs);
+            frameStartNs = 0;
+        }
+        {
+            PerfScope perf(HotPath::Swap);
+            eglSwapBuffers(ctx.display, ctx.surface);
+        }
+        if (!firstFrameShown) {
+            firstFrameShown = true;
+            StartupTrace::mark(Milestone::FirstSwap);
+            StartupTrace::emit();
         }
-        // Just fill the screen with a color.
-        glClearColor(((float) ctx.state.x) / (float) ctx.width, ctx.state.angle,
-                     ((float) ctx.state.y) / (float) ctx.height, 1);
-        glClear(GL_COLOR_BUFFER_BIT);
-        eglSwapBuffers(ctx.display, ctx.surface);
     }
 
     int32_t onInputEvent(AInputEvent *event) {
+        MemTagScope tag(MemTag::Input);
+        if (!startup.done()) {
+            // The world and audio may still be coming up on other threads.
+            return 0;
+        }
         if (AInputEvent_getType(event) == AINPUT_EVENT_TYPE_MOTION) {
-            ctx.animating = true;
-            ctx.state.x = (int) AMotionEvent_getX(event, 0);
-            ctx.state.y = (int) AMotionEvent_getY(event, 0);
+            if (replay.isActive()) {
+                // Keep replays deterministic.
+                return 1;
+            }
+            auto action = AMotionEvent_getAction(event) & AMOTION_EVENT_ACTION_MASK;
+            float x = AMotionEvent_getX(event, 0), y = AMotionEvent_getY(event, 0);
+            recorder.touch(monotonicNs(), action, x, y);
+            onTouch(action, x, y);
             return 1;
         }
         return 0;
     }
 
+    /**
+     * A live touch.
+     * @param action AMOTION_EVENT_ACTION_* without the pointer index
+     */
+    void onTouch(int32_t action, float x, float y) {
+        ctx.animating = true;
+        frame.touch(action, x, y);
+    }
+
     /**
      * The system has asked us to save our current state.  Do so.
      */
     void onSaveState() const {
-        ctx.app->savedState = malloc(sizeof(SavedState));
-        *((SavedState *) ctx.app->savedState) = ctx.state;
-        ctx.app->savedStateSize = sizeof(SavedState);
+        PerfScope perf(HotPath::SaveState);
+        ctx.app->savedState = scene.saveState(&ctx.app->savedStateSize);
     }
 
     /**
      * The window is being shown, get it ready.
      */
     void onInitWindow() {
-        if (ctx.app->window != nullptr) {
+        if (ctx.app->window == nullptr) {
+            return;
+        }
+        StartupTrace::mark(Milestone::InitWindow);
+        if (startup.signal(windowGate)) {
+            // First window: the startup graph brings up the display.
+            startup.runMainReady();
+            return;
+        }
+        if (!startup.done()) {
+            // A window back before startup finished: the display node, or the
+            // first-frame node if that already ran, brings the display up.
+            return;
+        }
+        if (ctx.display == EGL_NO_DISPLAY) {
             this->initDisplay();
-            this->drawFrame();
         }
+        this->drawFrame();
     }
 
     /**
@@ -239,18 +395,76 @@ public:
     }
 
     /**
-     * System focus event
+     * System focus event; applied once startup has finished.
      */
     void onFocus(bool gained) {
-        if (gained) {
+        focused = gained;
+        if (startup.done()) {
+            applyFocus();
+        }
+    }
+
+    void processSensorEvents() {
+        MemTagScope tag(MemTag::Sensors);
+        PerfScope perf(HotPath::Sensors);
+        if (ctx.accelerometerSensor != nullptr) {
+            SensorEvents::drain(ctx.sensorEventQueue, [this](float x, float y, float z) {
+                if (replay.isActive()) {
+                    return;
+                }
+                recorder.accelerometer(monotonicNs(), x, y, z);
+                frame.accelerometer(x, y, z);
+            });
+        }
+    }
+
+    void animate() {
+        if (!startup.done()) {
+            // Woken by the graph: run whatever is ready for this thread.
+            startup.runMainReady();
+            return;
+        }
+        if (audio.maintain()) {
+            // The output came back, possibly at another rate.
+            frame.audioOutputChanged();
+            if (music) {
+                music->setOutputRate((uint32_t) audio.getSampleRate());
+            }
+        }
+        if (replay.isActive()) {
+            ctx.animating = true;
+        }
+        if (ctx.animating) {
+            frameStartNs = monotonicNs();
+            frame.step(frameStartNs);
+            threads.sampleFrame();
+            if (replay.isActive() && replay.finished()) {
+                finishReplay();
+            }
+        } else {
+            frame.pause();
+            if (scheduler.pending()) {
+                // Keep tasks moving while no frames are being drawn.
+                scheduler.tick(monotonicNs());
+            }
+        }
+    }
+
+    /**
+     * Start or stop focus-dependent work to match the current focus.
+     */
+    void applyFocus() {
+        if (focused) {
+            audio.start();
             // When our app gains focus, we start monitoring the accelerometer.
             if (ctx.accelerometerSensor != nullptr) {
                 ASensorEventQueue_enableSensor(ctx.sensorEventQueue,
                                                ctx.accelerometerSensor);
-                // We'd like to get 60 events per second (in us).
+                // We'd like to get 60 events per second (in us), or fewer
+                // when the thermal governor has stepped down.
                 ASensorEventQueue_setEventRate(ctx.sensorEventQueue,
                                                ctx.accelerometerSensor,
-                                               (1000L / 60) * 1000);
+                                               1000000L / thermal.quality().sensorRateHz);
             }
         } else {
             // When our app loses focus, we stop monitoring the accelerometer.
@@ -259,41 +473,181 @@ public:
                 ASensorEventQueue_disableSensor(ctx.sensorEventQueue,
                                                 ctx.accelerometerSensor);
             }
-            // Also stop animating.
+            // Also stop animating, and release the audio device.
             ctx.animating = false;
+            audio.stop();
             this->drawFrame();
         }
     }
 
-    void processSensorEvents() const {
+    /**
+     * Apply the thermal governor's current quality level.
+     */
+    void applyQuality() {
+        auto &q = thermal.quality();
+        hint.setTargetDuration(q.swapInterval * 1000000000LL / 60);
         if (ctx.accelerometerSensor != nullptr) {
-            ASensorEvent event;
-            while (ASensorEventQueue_getEvents(ctx.sensorEventQueue, &event, 1) > 0) {
-                LOGI("accelerometer: x=%f y=%f z=%f",
-                     event.acceleration.x,
-                     event.acceleration.y,
-                     event.acceleration.z);
-            }
+            ASensorEventQueue_setEventRate(ctx.sensorEventQueue, ctx.accelerometerSensor,
+                                           1000000L / q.sensorRateHz);
         }
+        if (ctx.display == EGL_NO_DISPLAY) {
+            return;
+        }
+        // Fast replays measure throughput, so they are not held to vsync.
+        bool unpaced = replay.isActive() && replay.getPacing() == SessionReplay::Pacing::Fast;
+        eglSwapInterval(ctx.display, unpaced ? 0 : q.swapInterval);
+        // ctx.width/height stay at window size since touch input arrives in
+        // window coordinates; only the buffers shrink and get scaled up.
+        ANativeWindow_setBuffersGeometry(ctx.app->window,
+                                         (int32_t) (ctx.width * q.resolutionScale),
+                                         (int32_t) (ctx.height * q.resolutionScale),
+                                         ctx.format);
     }
 
-    void animate() {
-        if (ctx.animating) {
-            // Done with events; draw next animation frame.
-            ctx.state.angle += .01f;
-            if (ctx.state.angle > 1) {
-                ctx.state.angle = 0;
+    /**
+     * Everything between init() and the first frame. Independent pieces run
+     * on the job system while the engine thread waits for the window; the
+     * display and the first frame are gated on it.
+     */
+    void buildStartupGraph(struct android_app *state) {
+        typedef StartupGraph::Thread Thread;
+        auto jni = startup.add("jni", [state]() { Jni::init(state->activity); }, {},
+                               Thread::Main);
+        auto sensors = startup.add("sensors", [this, state]() {
+            MemTagScope tag(MemTag::Sensors);
+            ctx.sensorManager = acquireASensorManagerInstance();
+            ctx.accelerometerSensor = ASensorManager_getDefaultSensor(
+                    ctx.sensorManager, ASENSOR_TYPE_ACCELEROMETER);
+            ctx.sensorEventQueue = ASensorManager_createEventQueue(
+                    ctx.sensorManager, state->looper, LOOPER_ID_USER, nullptr, nullptr);
+        }, {jni}, Thread::Main);
+        auto perfHint = startup.add("perf-hint", [this]() {
+            auto tids = threads.threadIds(ThreadRole::Main);
+            auto workers = threads.threadIds(ThreadRole::Worker);
+            tids.insert(tids.end(), workers.begin(), workers.end());
+            hint.open(tids, 1000000000LL / 60);
+        });
+        auto thermalInit = startup.add("thermal", [this, state]() {
+            thermal.open(std::string(state->activity->internalDataPath) + "/thermal_headroom");
+        });
+        auto audioInit = startup.add("audio", [this, state]() {
+            MemTagScope tag(MemTag::Audio);
+            if (audio.open()) {
+                frame.audioOutputChanged();
+                startMusic(state->activity->assetManager);
+            }
+        });
+        auto animation = startup.add("animations", [this, state]() {
+            if (state->savedState != nullptr) {
+                // We are starting with a previous saved state; restore from it.
+                PerfScope perf(HotPath::RestoreState);
+                scene.restoreState(state->savedState, state->savedStateSize);
+            }
+        }, {}, Thread::Main);
+        windowGate = startup.addGate("window");
+        // applyQuality() in initDisplay() needs the hint session and thermal state.
+        auto display = startup.add("display", [this]() {
+            if (ctx.app->window != nullptr && ctx.display == EGL_NO_DISPLAY) {
+                initDisplay();
+            }
+        }, {windowGate, perfHint, thermalInit}, Thread::Main);
+        // am start ... -e replay <scenario> [-e replay_pacing fast] plays a
+        // scenario back (an absolute path or an asset); -e record <file>
+        // captures one (relative to internal storage).
+        auto session = startup.add("session", [this, state]() {
+            auto scenario = Jni::intentExtra("replay");
+            if (!scenario.empty() && replay.load(state->activity->assetManager, scenario)) {
+                replayPacing = Jni::intentExtra("replay_pacing") == "fast"
+                               ? SessionReplay::Pacing::Fast : SessionReplay::Pacing::Recorded;
+            }
+            auto path = Jni::intentExtra("record");
+            if (!path.empty()) {
+                if (path[0] != '/') {
+                    path = std::string(state->activity->internalDataPath) + "/" + path;
+                }
+                recorder.open(path, monotonicNs());
+            }
+        }, {jni}, Thread::Main);
+        startup.add("first-frame", [this]() {
+            // The window may have gone and come back since the display node ran.
+            if (ctx.app->window != nullptr && ctx.display == EGL_NO_DISPLAY) {
+                initDisplay();
+            }
+            if (focused) {
+                applyFocus();
             }
-            // Drawing is throttled to the screen update rate, so there
-            // is no need to do timing here.
             drawFrame();
+            if (replay.isLoaded()) {
+                startReplay();
+            }
+        }, {display, sensors, audioInit, animation, session}, Thread::Main);
+    }
+
+    void startReplay() {
+        LOGI("replay: playing %s (%s)", replay.getName().c_str(),
+             replayPacing == SessionReplay::Pacing::Fast ? "fast" : "recorded timing");
+        replay.start(replayPacing, monotonicNs());
+        // The perf record emitted at the end covers the replay alone.
+        PerfCounters::reset();
+        applyQuality();
+    }
+
+    /**
+     * Log the run's throughput, phase latencies and allocations, then
+     * finish the activity so scripted runs can launch the next scenario.
+     */
+    void finishReplay() {
+        replay.report(monotonicNs());
+        PerfCounters::emit(replay.getName().c_str());
+        applyQuality();
+        ANativeActivity_finish(ctx.app->activity);
+    }
+
+    void logGpuStats() const {
+        auto g = gpu.getStats();
+        LOGI("gpu: %u resources, %u resident (%zu KiB), %zu KiB cached", g.resources,
+             g.resident, g.gpuBytes / 1024, g.cacheBytes / 1024);
+        auto t = textures.getStats();
+        LOGI("textures: %u resident (%u raised, %u full, %u starved), %zu of %zu KiB, "
+             "%u loads, %u promotions, %u evictions (%zu KiB)", t.resident, t.raised,
+             t.fullResolution, t.starved, t.residentBytes / 1024, t.budgetBytes / 1024, t.loads,
+             t.promotions, t.evictions, t.evictedBytes / 1024);
+    }
+
+    void logAudioStats() const {
+        auto a = audio.getStats();
+        LOGI("audio: %llu callbacks, avg %.3fms max %.3fms of %.3fms, %d xruns, "
+             "%u dropped commands", (unsigned long long) a.callbacks, a.avgCallbackNs / 1e6,
+             a.maxCallbackNs / 1e6, a.budgetNs / 1e6, a.xruns, a.droppedCommands);
+        if (music && music->isOpen()) {
+            auto m = music->getStats();
+            LOGI("audio: music %u underruns, %u frames buffered, %zu KiB",
+                 m.underruns, m.bufferedFrames, m.memoryBytes / 1024);
         }
     }
 
-private:
     /**
-     * Workaround ASensorManager_getInstance() deprecation false alarm
-     * for Android-N and before, when compiling with NDK-r15
+     * Loop assets/music.ogg, if the app ships one, through the I/O thread.
+     */
+    void startMusic(AAssetManager *assets) {
+        music = std::make_unique<AudioStream>((uint32_t) audio.getSampleRate());
+        if (!music->open(assets, "music.ogg", true)) {
+            return;
+        }
+        streamer.onThreadStart = [this]() {
+            threads.registerCurrentThread(ThreadRole::Io, "engine-io");
+        };
+        streamer.onThreadExit = [this]() { threads.unregisterCurrentThread(); };
+        streamer.start();
+        streamer.add(music.get());
+        audio.playStream(music.get(), 0.6f);
+    }
+
+#if ENGINE_JNI_BASELINE
+
+    /**
+     * The original lookup, kept as the time-to-first-frame baseline: dlopen,
+     * attach, method lookup and a Java call on every use, less the detach.
      * @return a sensor manager instance
      */
     ASensorManager *acquireASensorManagerInstance() const {
@@ -314,7 +668,9 @@ private:
                     env->GetStringUTFChars(packageName, nullptr);
             ASensorManager *mgr = getInstanceForPackageFunc(nativePackageName);
             env->ReleaseStringUTFChars(packageName, nativePackageName);
-            ctx.app->activity->vm->DetachCurrentThread();
+            // The original detached here. Jni has this thread attached and
+            // caches its JNIEnv, and later startup nodes call Java on it, so
+            // the baseline leaves the attachment alone.
             if (mgr) {
                 dlclose(androidHandle);
                 return mgr;
@@ -328,6 +684,19 @@ private:
         dlclose(androidHandle);
         return getInstanceFunc();
     }
+
+#else
+
+    /**
+     * The package-scoped sensor manager (API 26, the app's minimum); the package
+     * name comes from the Jni::init() cache instead of a JNI round trip here.
+     * @return a sensor manager instance
+     */
+    ASensorManager *acquireASensorManagerInstance() const {
+        return ASensorManager_getInstanceForPackage(Jni::packageName().c_str());
+    }
+
+#endif
 };
 
 /**
@@ -336,6 +705,7 @@ private:
  * event loop for receiving input events and doing other things.
  */
 __attribute__((unused)) void android_main(struct android_app *state) {
+    StartupTrace::mark(Milestone::AndroidMain);
     Engine engine{};
     state->userData = &engine;
     state->onAppCmd = [](struct android_app *app, int32_t cmd) {
@@ -372,10 +742,10 @@ __attribute__((unused)) void android_main(struct android_app *state) {
         int events;
         struct android_poll_source *source;
 
-        // If not animating, we will block forever waiting for events.
-        // If animating, we loop until all events are read, then continue
-        // to draw the next frame of animation.
-        while ((ident = ALooper_pollAll(engine.isAnimating() ? 0 : -1, nullptr, &events,
+        // If not animating, we will block waiting for events (or briefly,
+        // while tasks are pending). If animating, we loop until all events
+        // are read, then continue to draw the next frame of animation.
+        while ((ident = ALooper_pollAll(engine.pollTimeoutMs(), nullptr, &events,
                                         (void **) &source)) >= 0) {
             // Process this event.
             if (source != nullptr) {
@@ -390,6 +760,7 @@ __attribute__((unused)) void android_main(struct android_app *state) {
             // Check if we are exiting.
             if (state->destroyRequested != 0) {
                 engine.termDisplay();
+                Jni::shutdown();
                 return;
             }
         }
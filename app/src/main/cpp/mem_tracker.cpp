@@ -0,0 +1,85 @@
+#include "mem_tracker.h"
+
+#ifndef NDEBUG
+
+#include <atomic>
+
+#include "logging.h"
+
+namespace {
+    const char *const tagNames[] = {"general", "renderer", "assets", "audio", "input", "sensors"};
+    static_assert(sizeof(tagNames) / sizeof(tagNames[0]) == (size_t) MemTag::Count,
+                  "tagNames must cover every MemTag");
+
+    struct TagStats {
+        std::atomic<size_t> live;
+        std::atomic<size_t> peak;
+        std::atomic<size_t> blocks;
+        std::atomic<size_t> budget;
+        std::atomic<bool> overBudget;
+    };
+
+    // Zero-initialized before any dynamic initialization, so it is safe to use
+    // from operator new during static construction.
+    TagStats tagStats[(size_t) MemTag::Count];
+    thread_local MemTag tagOfThread = MemTag::General;
+}
+
+namespace MemTracker {
+    MemTag currentTag() {
+        return tagOfThread;
+    }
+
+    void setCurrentTag(MemTag tag) {
+        tagOfThread = tag;
+    }
+
+    void setBudget(MemTag tag, size_t bytes) {
+        tagStats[(size_t) tag].budget.store(bytes, std::memory_order_relaxed);
+    }
+
+    void onAlloc(MemTag tag, size_t size) {
+        auto &s = tagStats[(size_t) tag];
+        auto live = s.live.fetch_add(size, std::memory_order_relaxed) + size;
+        s.blocks.fetch_add(1, std::memory_order_relaxed);
+        auto peak = s.peak.load(std::memory_order_relaxed);
+        while (live > peak &&
+               !s.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+        }
+        auto budget = s.budget.load(std::memory_order_relaxed);
+        if (budget && live > budget && !s.overBudget.exchange(true, std::memory_order_relaxed)) {
+            LOGW("memory: %s over budget (%zu > %zu bytes)", tagNames[(size_t) tag], live,
+                 budget);
+        }
+    }
+
+    void onFree(MemTag tag, size_t size) {
+        auto &s = tagStats[(size_t) tag];
+        auto live = s.live.fetch_sub(size, std::memory_order_relaxed) - size;
+        s.blocks.fetch_sub(1, std::memory_order_relaxed);
+        if (live <= s.budget.load(std::memory_order_relaxed)) {
+            s.overBudget.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    MemTagStats stats(MemTag tag) {
+        auto &s = tagStats[(size_t) tag];
+        return {s.live.load(std::memory_order_relaxed), s.peak.load(std::memory_order_relaxed),
+                s.blocks.load(std::memory_order_relaxed),
+                s.budget.load(std::memory_order_relaxed)};
+    }
+
+    void dumpReport(const char *reason) {
+        LOGI("memory report (%s)", reason);
+        for (size_t i = 0; i < (size_t) MemTag::Count; i++) {
+            auto &s = tagStats[i];
+            LOGI("  %-8s live=%zu bytes in %zu blocks, peak=%zu, budget=%zu", tagNames[i],
+                 s.live.load(std::memory_order_relaxed),
+                 s.blocks.load(std::memory_order_relaxed),
+                 s.peak.load(std::memory_order_relaxed),
+                 s.budget.load(std::memory_order_relaxed));
+        }
+    }
+}
+
+#endif
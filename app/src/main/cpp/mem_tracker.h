@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Subsystems native memory is attributed to.
+ */
+enum class MemTag : uint8_t {
+    General,
+    Renderer,
+    Assets,
+    Audio,
+    Input,
+    Sensors,
+    Count
+};
+
+/**
+ * One tag's current accounting.
+ */
+struct MemTagStats {
+    size_t live;
+    size_t peak;
+    size_t blocks;
+    size_t budget;
+};
+
+/**
+ * Per-tag heap accounting for debug builds.
+ * Every operator new made while a MemTagScope is active on the calling thread
+ * is charged to that scope's tag; the tag is stored in the block header so the
+ * matching delete is credited back even if it runs elsewhere. Exceeding a
+ * budget logs a warning once per crossing.
+ * Release builds (NDEBUG) compile all of this down to nothing.
+ */
+namespace MemTracker {
+#ifndef NDEBUG
+
+    MemTag currentTag();
+
+    void setCurrentTag(MemTag tag);
+
+    void setBudget(MemTag tag, size_t bytes);
+
+    void onAlloc(MemTag tag, size_t size);
+
+    void onFree(MemTag tag, size_t size);
+
+    MemTagStats stats(MemTag tag);
+
+    /**
+     * Log live bytes/blocks (leaks, if the subsystem should be empty by now),
+     * high-water mark and budget per tag.
+     */
+    void dumpReport(const char *reason);
+
+#else
+
+    inline MemTag currentTag() { return MemTag::General; }
+
+    inline void setCurrentTag(MemTag) {}
+
+    inline void setBudget(MemTag, size_t) {}
+
+    inline MemTagStats stats(MemTag) { return {}; }
+
+    inline void dumpReport(const char *) {}
+
+#endif
+}
+
+/**
+ * Charge allocations made by this thread to a tag until the scope ends.
+ */
+class MemTagScope {
+private:
+    MemTag previous;
+
+public:
+    explicit MemTagScope(MemTag tag) : previous(MemTracker::currentTag()) {
+        MemTracker::setCurrentTag(tag);
+    }
+
+    ~MemTagScope() { MemTracker::setCurrentTag(previous); }
+
+    MemTagScope(const MemTagScope &) = delete;
+
+    MemTagScope &operator=(const MemTagScope &) = delete;
+};
@@ -0,0 +1,141 @@
+#include "particle_system.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+ParticleSystem::ParticleSystem(size_t capacity) : capacity(capacity) {
+    size_t stride = (capacity + 3) & ~size_t(3);
+    storage.reset(new float[stride * 6]());
+    px = storage.get();
+    py = px + stride;
+    vx = py + stride;
+    vy = vx + stride;
+    age = vy + stride;
+    life = age + stride;
+}
+
+float ParticleSystem::random01() {
+    // xorshift32
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return (seed >> 8) * (1.0f / 16777216.0f);
+}
+
+size_t ParticleSystem::emit(size_t n, float x, float y, float speed, float lifetime) {
+    n = std::min(n, capacity - count);
+    for (size_t i = count; i < count + n; i++) {
+        float a = random01() * 6.28318531f;
+        float s = speed * (0.25f + 0.75f * random01());
+        px[i] = x;
+        py[i] = y;
+        vx[i] = std::cos(a) * s;
+        vy[i] = std::sin(a) * s;
+        age[i] = 0;
+        life[i] = lifetime * (0.5f + 0.5f * random01());
+    }
+    count += n;
+    return n;
+}
+
+bool ParticleSystem::supports(ParticleIsa isa) {
+    return isa == ParticleIsa::Scalar || isa == nativeIsa();
+}
+
+ParticleIsa ParticleSystem::nativeIsa() {
+#if defined(__ARM_NEON)
+    return ParticleIsa::Neon;
+#elif defined(__SSE2__)
+    return ParticleIsa::Sse2;
+#else
+    return ParticleIsa::Scalar;
+#endif
+}
+
+void ParticleSystem::update(float dt, float gx, float gy) {
+    update(dt, gx, gy, nativeIsa());
+}
+
+void ParticleSystem::update(float dt, float gx, float gy, ParticleIsa isa) {
+    integrate(dt, gx, gy, supports(isa) ? isa : ParticleIsa::Scalar);
+    compact();
+}
+
+void ParticleSystem::integrate(float dt, float gx, float gy, ParticleIsa isa) {
+    // Arrays are padded to a multiple of 4, so the tail group may run over
+    // stale lanes past count; they are never read back as live.
+    size_t groups = (count + 3) / 4;
+#if defined(__ARM_NEON)
+    if (isa == ParticleIsa::Neon) {
+        float32x4_t vdt = vdupq_n_f32(dt);
+        float32x4_t vgx = vdupq_n_f32(gx * dt);
+        float32x4_t vgy = vdupq_n_f32(gy * dt);
+        for (size_t g = 0; g < groups; g++) {
+            size_t i = g * 4;
+            float32x4_t nvx = vaddq_f32(vld1q_f32(vx + i), vgx);
+            float32x4_t nvy = vaddq_f32(vld1q_f32(vy + i), vgy);
+            vst1q_f32(vx + i, nvx);
+            vst1q_f32(vy + i, nvy);
+            vst1q_f32(px + i, vmlaq_f32(vld1q_f32(px + i), nvx, vdt));
+            vst1q_f32(py + i, vmlaq_f32(vld1q_f32(py + i), nvy, vdt));
+            vst1q_f32(age + i, vaddq_f32(vld1q_f32(age + i), vdt));
+        }
+        return;
+    }
+#elif defined(__SSE2__)
+    if (isa == ParticleIsa::Sse2) {
+        __m128 vdt = _mm_set1_ps(dt);
+        __m128 vgx = _mm_set1_ps(gx * dt);
+        __m128 vgy = _mm_set1_ps(gy * dt);
+        for (size_t g = 0; g < groups; g++) {
+            size_t i = g * 4;
+            __m128 nvx = _mm_add_ps(_mm_loadu_ps(vx + i), vgx);
+            __m128 nvy = _mm_add_ps(_mm_loadu_ps(vy + i), vgy);
+            _mm_storeu_ps(vx + i, nvx);
+            _mm_storeu_ps(vy + i, nvy);
+            _mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(nvx, vdt)));
+            _mm_storeu_ps(py + i, _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(nvy, vdt)));
+            _mm_storeu_ps(age + i, _mm_add_ps(_mm_loadu_ps(age + i), vdt));
+        }
+        return;
+    }
+#endif
+    float dvx = gx * dt, dvy = gy * dt;
+    for (size_t i = 0; i < groups * 4; i++) {
+        vx[i] += dvx;
+        vy[i] += dvy;
+        px[i] += vx[i] * dt;
+        py[i] += vy[i] * dt;
+        age[i] += dt;
+    }
+}
+
+void ParticleSystem::compact() {
+    // Branch-free stream compaction: always write, only advance on survivors.
+    size_t out = 0;
+    for (size_t i = 0; i < count; i++) {
+        px[out] = px[i];
+        py[out] = py[i];
+        vx[out] = vx[i];
+        vy[out] = vy[i];
+        age[out] = age[i];
+        life[out] = life[i];
+        out += age[i] < life[i];
+    }
+    count = out;
+}
+
+void ParticleSystem::writeVertices(const uint32_t *indices, size_t n, ParticleVertex *out,
+                                   uint8_t r, uint8_t g, uint8_t b) const {
+    for (size_t k = 0; k < n; k++) {
+        auto i = indices[k];
+        float fade = 1.0f - age[i] / life[i];
+        out[k] = ParticleVertex{px[i], py[i], r, g, b, (uint8_t) (fade * 255)};
+    }
+}
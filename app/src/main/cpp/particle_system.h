@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * Interleaved vertex for point-sprite rendering.
+ */
+struct ParticleVertex {
+    float x, y;
+    uint8_t r, g, b, a;
+};
+
+/**
+ * Instruction sets ParticleSystem::update() can integrate with.
+ * Scalar is the portable loop, which the compiler may still vectorize.
+ */
+enum class ParticleIsa {
+    Scalar,
+    Sse2,
+    Neon,
+};
+
+/**
+ * Fixed-capacity particle pool stored as structure-of-arrays.
+ * update() integrates and ages four particles per step with NEON or SSE
+ * (scalar elsewhere), then kills expired ones by stream compaction so the
+ * live set stays packed at the front of every array. Nothing allocates
+ * after construction.
+ */
+class ParticleSystem {
+private:
+    size_t capacity;
+    size_t count = 0;
+    // One block holding every field array, each padded to a multiple of 4.
+    std::unique_ptr<float[]> storage;
+    float *px, *py, *vx, *vy, *age, *life;
+    uint32_t seed = 0x9e3779b9u;
+
+    float random01();
+
+    void integrate(float dt, float gx, float gy, ParticleIsa isa);
+
+    void compact();
+
+public:
+    explicit ParticleSystem(size_t capacity);
+
+    ParticleSystem(const ParticleSystem &) = delete;
+
+    ParticleSystem &operator=(const ParticleSystem &) = delete;
+
+    /**
+     * Spawn up to n particles at (x, y) flying outwards at up to speed px/s.
+     * @return how many fit
+     */
+    size_t emit(size_t n, float x, float y, float speed, float lifetime);
+
+    /**
+     * Advance by dt seconds under gravity (gx, gy) and drop expired particles.
+     */
+    void update(float dt, float gx, float gy);
+
+    /**
+     * update() with a given instruction set, for benchmarks and tests.
+     * Falls back to Scalar when the build does not support isa.
+     */
+    void update(float dt, float gx, float gy, ParticleIsa isa);
+
+    /**
+     * @return whether this build has a path for isa
+     */
+    static bool supports(ParticleIsa isa);
+
+    /**
+     * The instruction set update() uses.
+     */
+    static ParticleIsa nativeIsa();
+
+    /**
+     * Fill out[0..n) from the particles listed in indices; alpha fades with age.
+     */
+    void writeVertices(const uint32_t *indices, size_t n, ParticleVertex *out,
+                       uint8_t r, uint8_t g, uint8_t b) const;
+
+    inline const float *positionsX() const { return px; }
+
+    inline const float *positionsY() const { return py; }
+
+    inline size_t size() const { return count; }
+
+    inline size_t getCapacity() const { return capacity; }
+
+    void clear() { count = 0; }
+};
@@ -0,0 +1,137 @@
+#include "perf_counters.h"
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#include "logging.h"
+
+namespace {
+    const char *const pathNames[] = {
+            "input", "sensors", "animate", "command_recording", "swap", "save_state",
+            "restore_state", "log",
+    };
+    static_assert(sizeof(pathNames) / sizeof(pathNames[0]) == (size_t) HotPath::Count);
+
+    // 0..15 exactly, then eight buckets per power of two up to 2^48 ns.
+    const uint32_t bucketCount = 16 + 44 * 8;
+
+    struct Histogram {
+        uint64_t count;
+        uint64_t sumNs;
+        uint64_t maxNs;
+        uint32_t buckets[bucketCount];
+    };
+
+    Histogram histograms[(size_t) HotPath::Count];
+
+    inline uint32_t bucketOf(uint64_t ns) {
+        if (ns < 16) {
+            return (uint32_t) ns;
+        }
+        uint32_t e = 63 - __builtin_clzll(ns);
+        uint32_t bucket = 16 + (e - 4) * 8 + (uint32_t) ((ns >> (e - 3)) & 7);
+        return bucket < bucketCount ? bucket : bucketCount - 1;
+    }
+
+    /**
+     * @return the middle of a bucket's range
+     */
+    inline double bucketValue(uint32_t bucket) {
+        if (bucket < 16) {
+            return bucket;
+        }
+        uint32_t e = (bucket - 16) / 8 + 4;
+        uint64_t width = 1ULL << (e - 3);
+        return (double) ((8 + (bucket - 16) % 8) * width) + width / 2.0;
+    }
+
+    double percentile(const Histogram &h, double p) {
+        auto rank = (uint64_t) (p * (h.count - 1)) + 1;
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < bucketCount; i++) {
+            seen += h.buckets[i];
+            if (seen >= rank) {
+                // The top bucket's midpoint can lie above the true maximum.
+                double value = bucketValue(i);
+                return value < (double) h.maxNs ? value : (double) h.maxNs;
+            }
+        }
+        return (double) h.maxNs;
+    }
+}
+
+void PerfCounters::record(HotPath path, int64_t ns) {
+    auto &h = histograms[(size_t) path];
+    auto value = (uint64_t) (ns > 0 ? ns : 0);
+    h.count++;
+    h.sumNs += value;
+    h.maxNs = value > h.maxNs ? value : h.maxNs;
+    h.buckets[bucketOf(value)]++;
+}
+
+void PerfCounters::emit(const char *label) {
+    char record[2048];
+    char escapedLabel[256];
+    escapeJson(label, escapedLabel, sizeof(escapedLabel));
+    char date[32];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+#ifdef NDEBUG
+    const char *buildType = "release";
+#else
+    const char *buildType = "debug";
+#endif
+    int length = snprintf(record, sizeof(record),
+                          "{\"context\":{\"date\":\"%s\",\"label\":\"%s\","
+                          "\"library_build_type\":\"%s\"},\"benchmarks\":[",
+                          date, escapedLabel, buildType);
+    bool first = true;
+    for (size_t i = 0; i < (size_t) HotPath::Count; i++) {
+        auto &h = histograms[i];
+        if (!h.count || length >= (int) sizeof(record)) {
+            continue;
+        }
+        double mean = (double) h.sumNs / (double) h.count;
+        length += snprintf(record + length, sizeof(record) - length,
+                           "%s{\"name\":\"%s\",\"run_type\":\"iteration\",\"iterations\":%llu,"
+                           "\"real_time\":%.1f,\"time_unit\":\"ns\","
+                           "\"p50\":%.1f,\"p90\":%.1f,\"p99\":%.1f,\"max\":%llu}",
+                           first ? "" : ",", pathNames[i], (unsigned long long) h.count, mean,
+                           percentile(h, 0.5), percentile(h, 0.9), percentile(h, 0.99),
+                           (unsigned long long) h.maxNs);
+        first = false;
+    }
+    if (length < (int) sizeof(record)) {
+        snprintf(record + length, sizeof(record) - length, "]}");
+    }
+    LOGI("perf-record %s", record);
+    reset();
+}
+
+void PerfCounters::reset() {
+    memset(histograms, 0, sizeof(histograms));
+}
+
+void PerfCounters::escapeJson(const char *s, char *out, size_t size) {
+    size_t length = 0;
+    for (; *s; s++) {
+        char escaped[8];
+        auto c = (unsigned char) *s;
+        if (c == '"' || c == '\\') {
+            snprintf(escaped, sizeof(escaped), "\\%c", c);
+        } else if (c < 0x20) {
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+        } else {
+            escaped[0] = (char) c;
+            escaped[1] = 0;
+        }
+        size_t n = strlen(escaped);
+        if (length + n >= size) {
+            break;
+        }
+        memcpy(out + length, escaped, n);
+        length += n;
+    }
+    out[length] = 0;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+#include "engine_clock.h"
+
+enum class HotPath : uint8_t {
+    Input,
+    Sensors,
+    Animate,
+    // Recording the frame's draw commands, up to the swap.
+    CommandRecording,
+    Swap,
+    SaveState,
+    RestoreState,
+    Log,
+    Count
+};
+
+/**
+ * Latency histograms for the engine's hot paths.
+ * A PerfScope costs two clock reads and a histogram increment; buckets
+ * are eight per power of two, so percentiles are within about 6%.
+ * emit() logs everything since the last emit() as one line,
+ *
+ *     perf-record {"context":{...},"benchmarks":[{"name":"input",...},...]}
+ *
+ * in Google Benchmark's JSON layout (wall times in ns, plus p50/p90/p99/max;
+ * there is no cpu_time, which is not measured), and starts over.
+ * tools/perf_compare.py aggregates these records, or the host suite's
+ * (host/bench), and compares them with a stored baseline. Engine thread only.
+ */
+namespace PerfCounters {
+    void record(HotPath path, int64_t ns);
+
+    void emit(const char *label);
+
+    void reset();
+
+    /**
+     * Copy s into out as the body of a JSON string: quotes, backslashes and
+     * control characters are escaped, and the result is cut to fit size.
+     */
+    void escapeJson(const char *s, char *out, size_t size);
+}
+
+/**
+ * Time a hot path until the scope ends.
+ */
+class PerfScope {
+private:
+    HotPath path;
+    int64_t startNs;
+
+public:
+    explicit PerfScope(HotPath path) : path(path), startNs(monotonicNs()) {}
+
+    ~PerfScope() { PerfCounters::record(path, monotonicNs() - startNs); }
+
+    PerfScope(const PerfScope &) = delete;
+
+    PerfScope &operator=(const PerfScope &) = delete;
+};
@@ -0,0 +1,178 @@
+#include "performance_hint.h"
+
+#include <dlfcn.h>
+
+#include <cerrno>
+
+#include "logging.h"
+
+#if !defined(__ANDROID__)
+
+/*
+ * Host stand-in for an ADPF session. It applies the platform's argument
+ * checks, logs target changes, and logs reports in batches (every frame
+ * reports).
+ */
+struct APerformanceHintManager {
+};
+
+struct APerformanceHintSession {
+    PerformanceHint::StandInLog log;
+};
+
+namespace {
+    const uint32_t reportsPerLog = 300;
+
+    APerformanceHintManager standInManager;
+
+    APerformanceHintManager *standInGetManager() {
+        return &standInManager;
+    }
+
+    APerformanceHintSession *standInCreateSession(APerformanceHintManager *,
+                                                  const int32_t *threadIds, size_t size,
+                                                  int64_t targetNs) {
+        if (!size || targetNs <= 0) {
+            return nullptr;
+        }
+        auto *session = new APerformanceHintSession();
+        session->log.threads.assign(threadIds, threadIds + size);
+        session->log.targetNs = targetNs;
+        return session;
+    }
+
+    int standInUpdateTarget(APerformanceHintSession *session, int64_t targetNs) {
+        if (targetNs <= 0) {
+            session->log.rejected++;
+            return EINVAL;
+        }
+        LOGI("performance hint (stand-in): target %.2fms -> %.2fms",
+             session->log.targetNs / 1e6, targetNs / 1e6);
+        session->log.targetNs = targetNs;
+        session->log.targetUpdates++;
+        return 0;
+    }
+
+    int standInReportActual(APerformanceHintSession *session, int64_t actualNs) {
+        auto &log = session->log;
+        if (actualNs <= 0) {
+            log.rejected++;
+            return EINVAL;
+        }
+        log.reports++;
+        log.overruns += actualNs > log.targetNs;
+        log.lastActualNs = actualNs;
+        if (log.reports % reportsPerLog == 0) {
+            LOGI("performance hint (stand-in): %u reports, %u over target, last %.2fms of "
+                 "%.2fms", log.reports, log.overruns, actualNs / 1e6, log.targetNs / 1e6);
+        }
+        return 0;
+    }
+
+    void standInCloseSession(APerformanceHintSession *session) {
+        LOGI("performance hint (stand-in): closed after %u reports, %u over target, "
+             "%u rejected calls", session->log.reports, session->log.overruns,
+             session->log.rejected);
+        delete session;
+    }
+
+    int standInSetThreads(APerformanceHintSession *session, const pid_t *threadIds,
+                          size_t size) {
+        if (!size) {
+            session->log.rejected++;
+            return EINVAL;
+        }
+        session->log.threads.assign(threadIds, threadIds + size);
+        LOGI("performance hint (stand-in): %zu threads", size);
+        return 0;
+    }
+}
+
+const PerformanceHint::StandInLog *PerformanceHint::getStandInLog() const {
+    return session ? &session->log : nullptr;
+}
+
+#endif
+
+bool PerformanceHint::open(const std::vector<pid_t> &threadIds, int64_t targetDurationNs) {
+    close();
+    targetNs = targetDurationNs;
+#if defined(__ANDROID__)
+    androidHandle = dlopen("libandroid.so", RTLD_NOW);
+    if (!androidHandle) {
+        return false;
+    }
+    auto getManager = (PF_GETMANAGER) dlsym(androidHandle, "APerformanceHint_getManager");
+    auto createSession = (PF_CREATESESSION) dlsym(androidHandle,
+                                                  "APerformanceHint_createSession");
+    updateTarget = (PF_UPDATETARGET) dlsym(androidHandle,
+                                           "APerformanceHint_updateTargetWorkDuration");
+    reportActual = (PF_REPORTACTUAL) dlsym(androidHandle,
+                                           "APerformanceHint_reportActualWorkDuration");
+    closeSession = (PF_CLOSESESSION) dlsym(androidHandle, "APerformanceHint_closeSession");
+    // API 34+
+    setThreadsFunc = (PF_SETTHREADS) dlsym(androidHandle, "APerformanceHint_setThreads");
+#else
+    PF_GETMANAGER getManager = standInGetManager;
+    PF_CREATESESSION createSession = standInCreateSession;
+    updateTarget = standInUpdateTarget;
+    reportActual = standInReportActual;
+    closeSession = standInCloseSession;
+    setThreadsFunc = standInSetThreads;
+#endif
+    APerformanceHintManager *manager = getManager ? getManager() : nullptr;
+    if (manager && createSession && updateTarget && reportActual && closeSession) {
+        std::vector<int32_t> tids(threadIds.begin(), threadIds.end());
+        session = createSession(manager, tids.data(), tids.size(), targetDurationNs);
+    }
+    if (!session) {
+        LOGI("performance hint: ADPF unavailable, frame work will not be reported");
+        close();
+        return false;
+    }
+    LOGI("performance hint: session for %zu threads, target %.2fms", threadIds.size(),
+         targetDurationNs / 1e6);
+    return true;
+}
+
+void PerformanceHint::close() {
+    if (session) {
+        closeSession(session);
+        session = nullptr;
+    }
+    if (androidHandle) {
+        dlclose(androidHandle);
+        androidHandle = nullptr;
+    }
+}
+
+void PerformanceHint::setTargetDuration(int64_t durationNs) {
+    if (durationNs == targetNs) {
+        return;
+    }
+    targetNs = durationNs;
+    if (session && updateTarget(session, durationNs) != 0) {
+        LOGW("performance hint: updateTargetWorkDuration(%lld) rejected",
+             (long long) durationNs);
+    }
+}
+
+void PerformanceHint::setThreads(const std::vector<pid_t> &threadIds) {
+    if (session && setThreadsFunc && setThreadsFunc(session, threadIds.data(),
+                                                    threadIds.size()) != 0) {
+        LOGW("performance hint: setThreads rejected");
+    }
+}
+
+void PerformanceHint::reportWork(int64_t durationNs) {
+    if (durationNs <= 0) {
+        return;
+    }
+    reports++;
+    if (durationNs > targetNs) {
+        overruns++;
+    }
+    if (session) {
+        reportActual(session, durationNs);
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+#include <vector>
+
+struct APerformanceHintManager;
+struct APerformanceHintSession;
+
+/**
+ * ADPF performance hint session for the engine threads.
+ * The APerformanceHint_* entry points only exist from API 33 while this app
+ * targets API 26, so they are resolved from libandroid.so at runtime, the
+ * same way acquireASensorManagerInstance() resolves the sensor manager. On
+ * older devices every call is a no-op. Host builds talk to a stand-in
+ * session instead, which validates and logs every call like the platform
+ * would and records them for tests.
+ */
+class PerformanceHint {
+public:
+#if !defined(__ANDROID__)
+    /**
+     * What the host stand-in session has been told.
+     */
+    struct StandInLog {
+        std::vector<int32_t> threads;
+        int64_t targetNs;
+        uint32_t targetUpdates;
+        uint32_t reports;
+        uint32_t overruns;
+        int64_t lastActualNs;
+        // Calls the platform would fail with EINVAL.
+        uint32_t rejected;
+    };
+#endif
+
+private:
+    typedef APerformanceHintManager *(*PF_GETMANAGER)();
+    typedef APerformanceHintSession *(*PF_CREATESESSION)(APerformanceHintManager *,
+                                                         const int32_t *, size_t, int64_t);
+    typedef int (*PF_UPDATETARGET)(APerformanceHintSession *, int64_t);
+    typedef int (*PF_REPORTACTUAL)(APerformanceHintSession *, int64_t);
+    typedef void (*PF_CLOSESESSION)(APerformanceHintSession *);
+    typedef int (*PF_SETTHREADS)(APerformanceHintSession *, const pid_t *, size_t);
+
+    void *androidHandle = nullptr;
+    PF_UPDATETARGET updateTarget = nullptr;
+    PF_REPORTACTUAL reportActual = nullptr;
+    PF_CLOSESESSION closeSession = nullptr;
+    PF_SETTHREADS setThreadsFunc = nullptr;
+    APerformanceHintSession *session = nullptr;
+    int64_t targetNs = 0;
+    uint32_t reports = 0;
+    uint32_t overruns = 0;
+
+public:
+    ~PerformanceHint() { close(); }
+
+    /**
+     * Create a session covering the given threads.
+     * @return false if ADPF is unavailable on this device
+     */
+    bool open(const std::vector<pid_t> &threadIds, int64_t targetDurationNs);
+
+    void close();
+
+    inline bool isActive() const { return session != nullptr; }
+
+    /**
+     * Change the per-frame work target, e.g. when the frame-rate cap changes.
+     */
+    void setTargetDuration(int64_t durationNs);
+
+    /**
+     * Replace the thread set (API 34+; ignored before).
+     */
+    void setThreads(const std::vector<pid_t> &threadIds);
+
+    /**
+     * Report the CPU work of one frame, excluding time blocked on vsync.
+     */
+    void reportWork(int64_t durationNs);
+
+    inline int64_t getTargetDuration() const { return targetNs; }
+
+    inline uint32_t getReports() const { return reports; }
+
+    inline uint32_t getOverruns() const { return overruns; }
+
+#if !defined(__ANDROID__)
+
+    /**
+     * @return the open stand-in session's record, or nullptr
+     */
+    const StandInLog *getStandInLog() const;
+
+#endif
+};
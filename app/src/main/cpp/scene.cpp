@@ -0,0 +1,291 @@
+#include "scene.h"
+
+#include <android/input.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+#include "culling.h"
+#include "job_system.h"
+#include "mem_tracker.h"
+#include "vector_math.h"
+
+void Scene::init(GpuResources *gpuResources, JobSystem *jobSystem) {
+    gpu = gpuResources;
+    jobs = jobSystem;
+    // Refilled every frame, so there is nothing to restore but the name.
+    particleVbo = gpu->addBuffer(std::string(), {GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW, 0}, 1);
+    entityVbo = gpu->addBuffer(std::string(), {GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW, 0}, 1);
+    cursorVbo = gpu->addBuffer(std::string(), {GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW, 0}, 1);
+    // 0 to 1 in 100 frames at 60 Hz, like the original per-frame ramp.
+    angleTrack = animations.addTween(0, 1, 100.0f / 60, true);
+    buildCursorRig();
+}
+
+void Scene::resize(int32_t windowWidth, int32_t windowHeight) {
+    width = windowWidth;
+    height = windowHeight;
+    current.angle = 0;
+    animations.setTime(angleTrack, 0);
+    touchGrid.init(0, 0, (float) width, (float) height, 64);
+    if (!world.size()) {
+        populateWorld();
+    }
+}
+
+void Scene::initGl() const {
+    glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_FASTEST);
+    glEnable(GL_CULL_FACE);
+    glShadeModel(GL_SMOOTH);
+    glDisable(GL_DEPTH_TEST);
+
+    // Everything is drawn as additive points in window coordinates.
+    glMatrixMode(GL_PROJECTION);
+    glLoadMatrixf(Mat4::ortho(0, (float) width, (float) height, 0, -1, 1).m);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    glPointSize(4);
+}
+
+void Scene::touch(int32_t action, float x, float y, uint32_t effectQuality) {
+    current.x = (int) x;
+    current.y = (int) y;
+    uint32_t hit = 0;
+    touched = SlotHandle();
+    if (touchGrid.queryNearest(x, y, touchRadius, world.positionsX(), world.positionsY(), &hit)) {
+        touched = world.handleAt(hit);
+    }
+    if (action == AMOTION_EVENT_ACTION_DOWN && touched != SlotHandle()) {
+        // Flick the touched entity away from the finger.
+        float dx = world.positionsX()[hit] - x, dy = world.positionsY()[hit] - y;
+        float length = std::sqrt(dx * dx + dy * dy);
+        float scale = length > 1 ? 200 / length : 0;
+        world.setVelocity(touched, dx * scale, dy * scale);
+    }
+    particles.emit(8u << effectQuality, (float) current.x, (float) current.y, 300, 1.5f);
+}
+
+void Scene::update(float dt) {
+    animations.update(dt);
+    current.angle = animations.value(angleTrack);
+    updateWorld(dt);
+    updateTouchGrid();
+    updateCursorRig();
+    particles.update(dt, 0, 600);
+}
+
+void Scene::draw() {
+    // Just fill the screen with a color.
+    glClearColor(width ? (float) current.x / (float) width : 0, current.angle,
+                 height ? (float) current.y / (float) height : 0, 1);
+    glClear(GL_COLOR_BUFFER_BIT);
+    drawEntities();
+    drawParticles();
+    drawCursorRig();
+    // GL has its own copies of the vertices by now.
+    frameArena.reset();
+}
+
+void *Scene::saveState(size_t *size) const {
+    auto *saved = (SavedState *) malloc(sizeof(SavedState));
+    *saved = current;
+    *size = sizeof(SavedState);
+    return saved;
+}
+
+void Scene::restoreState(const void *data, size_t size) {
+    if (!data || size < sizeof(SavedState)) {
+        return;
+    }
+    current = *(const SavedState *) data;
+    animations.setTime(angleTrack, current.angle * animations.getDuration(angleTrack));
+}
+
+/**
+ * Scatter the entity population over the window, drifting in random
+ * directions; updateWorld() wraps it around the edges.
+ */
+void Scene::populateWorld() {
+    MemTagScope tag(MemTag::General);
+    const uint32_t count = 16 * 1024;
+    uint32_t seed = 0x2545f491u;
+    auto random01 = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return (float) (seed >> 8) * (1.0f / 16777216);
+    };
+    world.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        float heading = random01() * 6.28318531f;
+        float speed = 20 + random01() * 60;
+        world.spawn({random01() * (float) width, random01() * (float) height,
+                     std::cos(heading) * speed, std::sin(heading) * speed, heading,
+                     random01() * 2 - 1});
+    }
+}
+
+/**
+ * Step the entity world, fanning out across the job system once it is
+ * large enough to amortize the dispatch.
+ */
+void Scene::updateWorld(float dt) {
+    const uint32_t grain = 4 * 1024;
+    auto count = (uint32_t) world.size();
+    auto w = (float) width, h = (float) height;
+    auto body = [this, dt, w, h](uint32_t begin, uint32_t end) {
+        world.update(dt, begin, end);
+        if (w > 0 && h > 0) {
+            world.wrap(w, h, begin, end);
+        }
+    };
+    if (count <= grain || !jobs) {
+        body(0, count);
+        return;
+    }
+    JobCounter done;
+    jobs->parallelFor(count, grain, body, &done, true);
+    jobs->wait(&done);
+}
+
+/**
+ * Mirror entity positions into the touch grid as loose boxes; only
+ * entities that left theirs are re-filed.
+ */
+void Scene::updateTouchGrid() {
+    auto count = world.size();
+    if (touchGrid.size() != count) {
+        touchGrid.resize(count);
+    }
+    touchGrid.updatePoints(world.positionsX(), world.positionsY(), count, touchSlack);
+    touchGrid.commit();
+}
+
+/**
+ * Create the cursor's nodes. Satellites sit still relative to their
+ * arm; the root and the arms move every frame.
+ */
+void Scene::buildCursorRig() {
+    const float turn = 6.28318531f;
+    cursorRoot = cursorRig.create();
+    uint32_t n = 0;
+    for (uint32_t arm = 0; arm < cursorArms; arm++) {
+        auto armNode = cursorRig.create(cursorRoot);
+        cursorNodes[n++] = armNode;
+        for (uint32_t s = 0; s < cursorSatellites; s++) {
+            float b = turn * (float) s / cursorSatellites;
+            cursorNodes[n] = cursorRig.create(armNode);
+            cursorRig.setLocal(cursorNodes[n++], std::cos(b) * 20, std::sin(b) * 20, 0, 1);
+        }
+    }
+}
+
+/**
+ * Pin the cursor to the touch point and turn it with the angle track;
+ * the satellites follow through the hierarchy.
+ */
+void Scene::updateCursorRig() {
+    const float turn = 6.28318531f;
+    const uint32_t stride = 1 + cursorSatellites;
+    cursorRig.setLocal(cursorRoot, (float) current.x, (float) current.y, current.angle * turn,
+                       1);
+    for (uint32_t arm = 0; arm < cursorArms; arm++) {
+        float a = turn * (float) arm / cursorArms;
+        cursorRig.setLocal(cursorNodes[arm * stride], std::cos(a) * 64, std::sin(a) * 64,
+                           -current.angle * 2 * turn, 1);
+    }
+    cursorRig.update();
+}
+
+/**
+ * Draw the on-screen entities as dim points, the touched one highlighted.
+ */
+void Scene::drawEntities() {
+    GLuint vbo = world.size() ? gpu->get(entityVbo) : 0;
+    if (!vbo) {
+        return;
+    }
+    auto *visible = frameArena.allocArray<uint32_t>(world.size());
+    if (!visible) {
+        return;
+    }
+    Viewport2D view{0, 0, (float) width, (float) height};
+    auto count = Culling::points2D(world.positionsX(), world.positionsY(), world.size(), 2,
+                                   view, visible);
+    auto *vertices = frameArena.allocArray<ParticleVertex>(count);
+    if (!count || !vertices) {
+        return;
+    }
+    auto highlight = world.indexOf(touched);
+    for (size_t i = 0; i < count; i++) {
+        auto e = visible[i];
+        bool hit = e == highlight;
+        vertices[i] = ParticleVertex{world.positionsX()[e], world.positionsY()[e], 255, 255,
+                                     (uint8_t) (hit ? 64 : 255), (uint8_t) (hit ? 255 : 96)};
+    }
+    streamPoints(vbo, vertices, count);
+}
+
+/**
+ * Stream this frame's on-screen particles into the VBO and draw them as points.
+ */
+void Scene::drawParticles() {
+    GLuint vbo = particles.size() ? gpu->get(particleVbo) : 0;
+    if (!vbo) {
+        return;
+    }
+    auto *visible = frameArena.allocArray<uint32_t>(particles.size());
+    if (!visible) {
+        return;
+    }
+    Viewport2D view{0, 0, (float) width, (float) height};
+    auto count = Culling::points2D(particles.positionsX(), particles.positionsY(),
+                                   particles.size(), 2, view, visible);
+    auto *vertices = frameArena.allocArray<ParticleVertex>(count);
+    if (!count || !vertices) {
+        return;
+    }
+    particles.writeVertices(visible, count, vertices, 255, 200, 120);
+    streamPoints(vbo, vertices, count);
+}
+
+/**
+ * Draw every cursor node at its world position.
+ */
+void Scene::drawCursorRig() {
+    const uint32_t count = sizeof(cursorNodes) / sizeof(cursorNodes[0]);
+    GLuint vbo = gpu->get(cursorVbo);
+    auto *vertices = frameArena.allocArray<ParticleVertex>(count);
+    if (!vbo || !vertices) {
+        return;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        auto &m = cursorRig.worldOf(cursorNodes[i]);
+        // Arms come first in each group of 1 + cursorSatellites.
+        bool arm = i % (1 + cursorSatellites) == 0;
+        vertices[i] = ParticleVertex{m.tx, m.ty, (uint8_t) (arm ? 120 : 255), 220, 255, 255};
+    }
+    streamPoints(vbo, vertices, count);
+}
+
+/**
+ * Upload vertices into a streamed VBO and draw them as points.
+ */
+void Scene::streamPoints(GLuint vbo, const ParticleVertex *vertices, size_t count) {
+    auto bytes = (GLsizeiptr) (sizeof(ParticleVertex) * count);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    // Orphan last frame's storage so the upload never waits on the GPU.
+    glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, vertices);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(ParticleVertex),
+                    (const void *) offsetof(ParticleVertex, x));
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(ParticleVertex),
+                   (const void *) offsetof(ParticleVertex, r));
+    glDrawArrays(GL_POINTS, 0, (GLsizei) count);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "animation_set.h"
+#include "entity_world.h"
+#include "frame_arena.h"
+#include "gpu_resources.h"
+#include "particle_system.h"
+#include "slot_map.h"
+#include "spatial_grid.h"
+#include "transform_hierarchy.h"
+
+class JobSystem;
+
+/**
+ * What the app simulates and draws, without the platform around it: the
+ * drifting entities, touch sparks and cursor rig, the background ramp and
+ * the GL commands that draw them. Engine feeds it touches and frame times;
+ * host tests, benchmarks and the replay runner drive it the same way over
+ * stub or headless GL. Engine thread only.
+ */
+class Scene {
+public:
+    /**
+     * What survives the activity being recreated (android_app::savedState).
+     */
+    struct SavedState {
+        float angle;
+        int32_t x;
+        int32_t y;
+    };
+
+private:
+    SavedState current{};
+    int32_t width = 0;
+    int32_t height = 0;
+    GpuResources *gpu = nullptr;
+    JobSystem *jobs = nullptr;
+
+    // Scratch memory for per-frame work; never touch the heap inside a frame.
+    FrameArena frameArena{1024 * 1024};
+
+    // Drifting points filling the window, stepped once per animation frame.
+    EntityWorld world;
+
+    // Entity positions in window coordinates, for resolving touches.
+    static constexpr float touchRadius = 48;
+    static constexpr float touchSlack = 16;
+    SpatialGrid touchGrid;
+    SlotHandle touched;
+
+    // Cursor following the touch point: arms orbiting it, each with
+    // satellites of its own, all driven by the angle track.
+    static const uint32_t cursorArms = 3, cursorSatellites = 2;
+    TransformHierarchy cursorRig;
+    TransformHierarchy::NodeId cursorRoot = 0;
+    TransformHierarchy::NodeId cursorNodes[cursorArms * (1 + cursorSatellites)] = {};
+
+    // Touch sparks; the index and vertex streams are sized to fit in frameArena.
+    ParticleSystem particles{16384};
+
+    SlotHandle particleVbo;
+    SlotHandle entityVbo;
+    SlotHandle cursorVbo;
+
+    // Time-based animation tracks; the background color ramp is one.
+    AnimationSet animations;
+    AnimationSet::TrackId angleTrack = 0;
+
+    void populateWorld();
+
+    void updateWorld(float dt);
+
+    void updateTouchGrid();
+
+    void buildCursorRig();
+
+    void updateCursorRig();
+
+    void drawEntities();
+
+    void drawParticles();
+
+    void drawCursorRig();
+
+    void streamPoints(GLuint vbo, const ParticleVertex *vertices, size_t count);
+
+public:
+    /**
+     * Register the scene's buffers and build what does not depend on the
+     * window.
+     * @param jobs fans the world update out once it is large enough;
+     *             nullptr runs it inline
+     */
+    void init(GpuResources *gpuResources, JobSystem *jobSystem);
+
+    /**
+     * The window's size in pixels. Restarts the background ramp, and
+     * scatters the entities over the window the first time.
+     */
+    void resize(int32_t windowWidth, int32_t windowHeight);
+
+    /**
+     * Fixed GL state for draw(); call once the context is current.
+     */
+    void initGl() const;
+
+    /**
+     * A touch in window coordinates: picks the nearest entity, flicks it on
+     * a press and throws sparks.
+     * @param action AMOTION_EVENT_ACTION_* without the pointer index
+     * @param effectQuality thermal effect level; sparks double per step
+     */
+    void touch(int32_t action, float x, float y, uint32_t effectQuality);
+
+    /**
+     * Advance the animations, world, cursor and sparks by dt seconds.
+     */
+    void update(float dt);
+
+    /**
+     * Record this frame's draw commands, then release the frame's scratch
+     * memory.
+     */
+    void draw();
+
+    /**
+     * @return a malloc() copy of the state, as android_app::savedState wants
+     */
+    void *saveState(size_t *size) const;
+
+    void restoreState(const void *data, size_t size);
+
+    inline const SavedState &state() const { return current; }
+
+    inline int32_t windowWidth() const { return width; }
+
+    inline size_t entityCount() const { return world.size(); }
+
+    inline const EntityWorld &entities() const { return world; }
+
+    /**
+     * @return the entity the last touch picked, or an empty handle
+     */
+    inline SlotHandle touchedEntity() const { return touched; }
+
+    inline size_t particleCount() const { return particles.size(); }
+};
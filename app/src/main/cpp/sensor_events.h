@@ -0,0 +1,33 @@
+#pragma once
+
+#include <android/sensor.h>
+
+#include <cstddef>
+
+/**
+ * Draining ASensorEventQueue, shared by the engine and its host benchmarks.
+ */
+namespace SensorEvents {
+    // Events fetched per ASensorEventQueue_getEvents() call.
+    const size_t batch = 8;
+
+    /**
+     * Read every pending event, a batch per call into the queue rather than
+     * one, and hand each acceleration to onSample(x, y, z).
+     * @return the number of events read
+     */
+    template<typename F>
+    size_t drain(ASensorEventQueue *queue, F &&onSample) {
+        ASensorEvent events[batch];
+        size_t total = 0;
+        ssize_t n;
+        while ((n = ASensorEventQueue_getEvents(queue, events, batch)) > 0) {
+            for (ssize_t i = 0; i < n; i++) {
+                auto &a = events[i].acceleration;
+                onSample(a.x, a.y, a.z);
+            }
+            total += (size_t) n;
+        }
+        return total;
+    }
+}
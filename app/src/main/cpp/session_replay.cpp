@@ -0,0 +1,223 @@
+#include "session_replay.h"
+
+#include <android/asset_manager.h>
+#include <android/input.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include "engine_clock.h"
+#include "logging.h"
+#include "perf_counters.h"
+
+namespace {
+    const char *actionName(int32_t action) {
+        switch (action) {
+            case AMOTION_EVENT_ACTION_DOWN:
+                return "down";
+            case AMOTION_EVENT_ACTION_UP:
+                return "up";
+            default:
+                return "move";
+        }
+    }
+
+    bool readAll(AAssetManager *assets, const std::string &path, std::string &text) {
+        if (!path.empty() && path[0] == '/') {
+            FILE *fp = fopen(path.c_str(), "r");
+            if (!fp) {
+                return false;
+            }
+            char chunk[4096];
+            size_t n;
+            while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0) {
+                text.append(chunk, n);
+            }
+            fclose(fp);
+            return true;
+        }
+        AAsset *asset = assets ? AAssetManager_open(assets, path.c_str(), AASSET_MODE_BUFFER)
+                               : nullptr;
+        if (!asset) {
+            return false;
+        }
+        auto *buffer = (const char *) AAsset_getBuffer(asset);
+        if (buffer) {
+            text.assign(buffer, (size_t) AAsset_getLength64(asset));
+            AAsset_close(asset);
+            return true;
+        }
+        // No single buffer (out of memory, or the read failed): stream it instead.
+        char chunk[4096];
+        int n = AAsset_seek(asset, 0, SEEK_SET) < 0 ? -1 : 0;
+        while (n >= 0 && (n = AAsset_read(asset, chunk, sizeof(chunk))) > 0) {
+            text.append(chunk, (size_t) n);
+        }
+        AAsset_close(asset);
+        return n == 0;
+    }
+}
+
+bool SessionRecorder::open(const std::string &path, int64_t nowNs) {
+    close();
+    file = fopen(path.c_str(), "w");
+    if (!file) {
+        LOGW("replay: cannot record to %s", path.c_str());
+        return false;
+    }
+    startNs = nowNs;
+    fprintf(file, "# native-activity scenario 1\n");
+    LOGI("replay: recording to %s", path.c_str());
+    return true;
+}
+
+void SessionRecorder::close() {
+    if (!file) {
+        return;
+    }
+    // The session ran until now, not just until its last event.
+    fprintf(file, "%.3f end\n", (monotonicNs() - startNs) / 1e6);
+    fclose(file);
+    file = nullptr;
+}
+
+void SessionRecorder::flush() {
+    if (file) {
+        fflush(file);
+    }
+}
+
+void SessionRecorder::touch(int64_t nowNs, int32_t action, float x, float y) {
+    if (file) {
+        fprintf(file, "%.3f touch %s %.1f %.1f\n", (nowNs - startNs) / 1e6, actionName(action),
+                x, y);
+    }
+}
+
+void SessionRecorder::accelerometer(int64_t nowNs, float x, float y, float z) {
+    if (file) {
+        fprintf(file, "%.3f accel %.3f %.3f %.3f\n", (nowNs - startNs) / 1e6, x, y, z);
+    }
+}
+
+bool SessionReplay::load(AAssetManager *assets, const std::string &path) {
+    std::string text;
+    if (!readAll(assets, path, text)) {
+        LOGW("replay: cannot open %s", path.c_str());
+        return false;
+    }
+    name = path.substr(path.find_last_of('/') + 1);
+    events.clear();
+    endNs = 0;
+    size_t lineStart = 0;
+    uint32_t lineNumber = 0;
+    while (lineStart < text.size()) {
+        size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string::npos) {
+            lineEnd = text.size();
+        }
+        std::string line = text.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+        lineNumber++;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        double ms;
+        char kind[16], action[16];
+        SessionEvent event{};
+        if (sscanf(line.c_str(), "%lf %15s", &ms, kind) != 2) {
+            LOGW("replay: %s:%u: cannot parse \"%s\"", name.c_str(), lineNumber, line.c_str());
+            continue;
+        }
+        event.timeNs = (int64_t) (ms * 1e6);
+        if (!strcmp(kind, "touch") &&
+            sscanf(line.c_str(), "%*f %*s %15s %f %f", action, &event.x, &event.y) == 3) {
+            event.type = SessionEvent::Type::Touch;
+            event.action = !strcmp(action, "down") ? AMOTION_EVENT_ACTION_DOWN
+                                                   : !strcmp(action, "up")
+                                                     ? AMOTION_EVENT_ACTION_UP
+                                                     : AMOTION_EVENT_ACTION_MOVE;
+        } else if (!strcmp(kind, "accel") &&
+                   sscanf(line.c_str(), "%*f %*s %f %f %f", &event.x, &event.y,
+                          &event.z) == 3) {
+            event.type = SessionEvent::Type::Accelerometer;
+        } else if (!strcmp(kind, "end")) {
+            endNs = event.timeNs;
+            continue;
+        } else {
+            LOGW("replay: %s:%u: cannot parse \"%s\"", name.c_str(), lineNumber, line.c_str());
+            continue;
+        }
+        if (!events.empty() && event.timeNs < events.back().timeNs) {
+            event.timeNs = events.back().timeNs;
+        }
+        events.push_back(event);
+    }
+    if (!events.empty() && endNs < events.back().timeNs) {
+        endNs = events.back().timeNs;
+    }
+    LOGI("replay: loaded %s, %zu events over %.1fs", name.c_str(), events.size(), endNs / 1e9);
+    return isLoaded();
+}
+
+void SessionReplay::start(Pacing mode, int64_t nowNs) {
+    pacing = mode;
+    active = true;
+    cursor = 0;
+    startNs = nowNs;
+    sessionNs = 0;
+    frames = 0;
+    allocations = 0;
+    allocatingFrames = 0;
+    maxFrameNs = 0;
+}
+
+float SessionReplay::beginFrame(int64_t nowNs) {
+    int64_t previous = sessionNs;
+    sessionNs = pacing == Pacing::Fast ? (int64_t) frames * fastFrameNs : nowNs - startNs;
+    float dt = (float) ((sessionNs - previous) / 1e9);
+    return frames ? dt : 1.0f / 60;
+}
+
+const SessionEvent *SessionReplay::next() {
+    if (!active || cursor == events.size() || events[cursor].timeNs > sessionNs) {
+        return nullptr;
+    }
+    return &events[cursor++];
+}
+
+void SessionReplay::endFrame(int64_t frameNs, uint32_t allocs) {
+    frames++;
+    allocations += allocs;
+    allocatingFrames += allocs != 0;
+    maxFrameNs = frameNs > maxFrameNs ? frameNs : maxFrameNs;
+}
+
+bool SessionReplay::finished() const {
+    return active && cursor == events.size() && sessionNs >= endNs;
+}
+
+void SessionReplay::report(int64_t nowNs) {
+    active = false;
+    double seconds = (nowNs - startNs) / 1e9;
+    char allocationFields[64];
+#ifdef NDEBUG
+    // AllocGuard is compiled out of release builds, so nothing was counted.
+    snprintf(allocationFields, sizeof(allocationFields),
+             "\"allocations\":null,\"allocating_frames\":null");
+    const char *buildType = "release";
+#else
+    snprintf(allocationFields, sizeof(allocationFields),
+             "\"allocations\":%llu,\"allocating_frames\":%u", (unsigned long long) allocations,
+             allocatingFrames);
+    const char *buildType = "debug";
+#endif
+    char scenario[256];
+    PerfCounters::escapeJson(name.c_str(), scenario, sizeof(scenario));
+    LOGI("replay-record {\"scenario\":\"%s\",\"pacing\":\"%s\",\"events\":%zu,\"frames\":%u,"
+         "\"seconds\":%.3f,\"fps\":%.1f,\"session_seconds\":%.3f,\"max_frame_ms\":%.3f,%s,"
+         "\"build_type\":\"%s\"}",
+         scenario, pacing == Pacing::Fast ? "fast" : "recorded", events.size(), frames,
+         seconds, seconds > 0 ? frames / seconds : 0.0, sessionNs / 1e9, maxFrameNs / 1e6,
+         allocationFields, buildType);
+}
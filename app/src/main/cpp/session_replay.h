@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+struct AAssetManager;
+
+/**
+ * One input event of a recorded session.
+ */
+struct SessionEvent {
+    enum class Type : uint8_t {
+        Touch, Accelerometer
+    };
+
+    Type type;
+    // AMOTION_EVENT_ACTION_DOWN, _UP or _MOVE for touches.
+    int32_t action;
+    // Since the session started.
+    int64_t timeNs;
+    float x, y, z;
+};
+
+/*
+ * Sessions are stored as perf scenarios: text, one event per line, times
+ * in milliseconds since the start.
+ *
+ *     # native-activity scenario 1
+ *     0.000 touch down 120.0 640.0
+ *     16.700 touch move 130.0 610.0
+ *     20.100 accel 0.12 9.79 0.33
+ *     33.400 touch up 130.0 610.0
+ *     2000.000 end
+ *
+ * "end" marks how long the session ran after its last event; lines
+ * starting with '#' are comments.
+ */
+
+/**
+ * Writes live input as a scenario.
+ */
+class SessionRecorder {
+private:
+    FILE *file = nullptr;
+    int64_t startNs = 0;
+
+public:
+    ~SessionRecorder() { close(); }
+
+    /**
+     * @param nowNs CLOCK_MONOTONIC time the session starts at
+     */
+    bool open(const std::string &path, int64_t nowNs);
+
+    /**
+     * Write the end marker, at the current time, and close the file.
+     */
+    void close();
+
+    inline bool isOpen() const { return file != nullptr; }
+
+    void flush();
+
+    void touch(int64_t nowNs, int32_t action, float x, float y);
+
+    void accelerometer(int64_t nowNs, float x, float y, float z);
+};
+
+/**
+ * Plays a scenario back into the engine's frame loop. Every frame,
+ * beginFrame() sets the session time that frame stands for, and next()
+ * hands out the events due by then. Recorded pacing follows the wall
+ * clock, so the session runs as it was captured; fast pacing advances
+ * one 60 Hz frame per loop iteration, however long the frame took, so it
+ * measures throughput. endFrame() collects frame time and allocation
+ * counts for report(). Allocations are only counted in debug builds
+ * (AllocGuard); release records say so and carry null instead.
+ */
+class SessionReplay {
+public:
+    enum class Pacing : uint8_t {
+        Recorded, Fast
+    };
+
+    static const int64_t fastFrameNs = 1000000000LL / 60;
+
+private:
+    std::string name;
+    std::vector<SessionEvent> events;
+    int64_t endNs = 0;
+    Pacing pacing = Pacing::Recorded;
+    bool active = false;
+    size_t cursor = 0;
+    int64_t startNs = 0;
+    int64_t sessionNs = 0;
+    uint32_t frames = 0;
+    uint64_t allocations = 0;
+    uint32_t allocatingFrames = 0;
+    int64_t maxFrameNs = 0;
+
+public:
+    /**
+     * @param path a file if absolute, otherwise an asset
+     */
+    bool load(AAssetManager *assets, const std::string &path);
+
+    inline bool isLoaded() const { return !events.empty() || endNs; }
+
+    void start(Pacing mode, int64_t nowNs);
+
+    inline bool isActive() const { return active; }
+
+    inline Pacing getPacing() const { return pacing; }
+
+    /**
+     * @return the frame's time step in seconds
+     */
+    float beginFrame(int64_t nowNs);
+
+    /**
+     * @return the next event due by the current frame, or nullptr
+     */
+    const SessionEvent *next();
+
+    /**
+     * @param frameNs wall time the frame took
+     * @param allocs heap allocations made during the frame; always 0 in
+     *               release builds, where AllocGuard is compiled out
+     */
+    void endFrame(int64_t frameNs, uint32_t allocs);
+
+    /**
+     * @return true once every event has been delivered and the session's
+     * end time reached
+     */
+    bool finished() const;
+
+    /**
+     * Stop and log the run as one replay-record JSON line.
+     */
+    void report(int64_t nowNs);
+
+    inline const std::string &getName() const { return name; }
+};
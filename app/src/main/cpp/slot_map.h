@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * Stable reference to an object stored in a SlotMap.
+ * A default-constructed handle (generation 0) never resolves.
+ */
+struct SlotHandle {
+    uint32_t index;
+    uint32_t generation;
+
+    SlotHandle() : index(0), generation(0) {}
+
+    SlotHandle(uint32_t index, uint32_t generation) : index(index), generation(generation) {}
+
+    inline bool operator==(const SlotHandle &o) const {
+        return index == o.index && generation == o.generation;
+    }
+
+    inline bool operator!=(const SlotHandle &o) const { return !(*this == o); }
+};
+
+/**
+ * Container handing out generation-checked handles to densely packed values.
+ * insert/erase/get are O(1); values live contiguously so iterating over
+ * data()..data()+size() stays cache-linear. Erasing moves the last value
+ * into the hole, so dense indices (not handles) change on erase.
+ */
+template<typename T>
+class SlotMap {
+private:
+    struct Slot {
+        // Dense index while alive, next free slot while on the free list.
+        uint32_t target;
+        // Bumped on erase, so stale handles stop resolving; odd means alive.
+        uint32_t generation;
+    };
+
+    static const uint32_t endOfFreeList = UINT32_MAX;
+
+    std::vector<T> dense;
+    std::vector<uint32_t> denseToSlot;
+    std::vector<Slot> slots;
+    uint32_t freeHead = endOfFreeList;
+
+    SlotHandle allocSlot() {
+        uint32_t index;
+        if (freeHead != endOfFreeList) {
+            index = freeHead;
+            freeHead = slots[index].target;
+        } else {
+            index = (uint32_t) slots.size();
+            slots.push_back(Slot{0, 0});
+        }
+        auto &slot = slots[index];
+        slot.target = (uint32_t) dense.size();
+        slot.generation++;
+        denseToSlot.push_back(index);
+        return SlotHandle(index, slot.generation);
+    }
+
+public:
+    static const size_t npos = SIZE_MAX;
+
+    void reserve(size_t capacity) {
+        dense.reserve(capacity);
+        denseToSlot.reserve(capacity);
+        slots.reserve(capacity);
+    }
+
+    SlotHandle insert(const T &value) {
+        auto handle = allocSlot();
+        dense.push_back(value);
+        return handle;
+    }
+
+    SlotHandle insert(T &&value) {
+        auto handle = allocSlot();
+        dense.push_back(std::move(value));
+        return handle;
+    }
+
+    inline bool contains(SlotHandle h) const {
+        return h.index < slots.size() && slots[h.index].generation == h.generation &&
+               (h.generation & 1);
+    }
+
+    /**
+     * @return the value, or nullptr when the handle is stale or invalid
+     */
+    inline T *get(SlotHandle h) {
+        return contains(h) ? &dense[slots[h.index].target] : nullptr;
+    }
+
+    inline const T *get(SlotHandle h) const {
+        return contains(h) ? &dense[slots[h.index].target] : nullptr;
+    }
+
+    /**
+     * @return the dense index of a live handle, or npos
+     */
+    inline size_t indexOf(SlotHandle h) const {
+        return contains(h) ? slots[h.index].target : npos;
+    }
+
+    inline SlotHandle handleAt(size_t denseIndex) const {
+        auto slot = denseToSlot[denseIndex];
+        return SlotHandle(slot, slots[slot].generation);
+    }
+
+    /**
+     * Remove a value; the last value is moved into its dense position.
+     * @return the dense index that was vacated, or npos if the handle was stale
+     */
+    size_t erase(SlotHandle h) {
+        if (!contains(h)) {
+            return npos;
+        }
+        auto &slot = slots[h.index];
+        size_t hole = slot.target;
+        size_t last = dense.size() - 1;
+        if (hole != last) {
+            dense[hole] = std::move(dense[last]);
+            denseToSlot[hole] = denseToSlot[last];
+            slots[denseToSlot[hole]].target = (uint32_t) hole;
+        }
+        dense.pop_back();
+        denseToSlot.pop_back();
+        slot.generation++;
+        slot.target = freeHead;
+        freeHead = h.index;
+        return hole;
+    }
+
+    void clear() {
+        while (!dense.empty()) {
+            erase(handleAt(dense.size() - 1));
+        }
+    }
+
+    inline size_t size() const { return dense.size(); }
+
+    inline bool empty() const { return dense.empty(); }
+
+    inline T *data() { return dense.data(); }
+
+    inline const T *data() const { return dense.data(); }
+
+    inline T *begin() { return dense.data(); }
+
+    inline T *end() { return dense.data() + dense.size(); }
+
+    inline const T *begin() const { return dense.data(); }
+
+    inline const T *end() const { return dense.data() + dense.size(); }
+};
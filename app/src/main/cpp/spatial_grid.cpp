@@ -0,0 +1,260 @@
+#include "spatial_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    inline bool overlaps(const Aabb &a, const Aabb &b) {
+        return a.minX <= b.maxX && b.minX <= a.maxX && a.minY <= b.maxY && b.minY <= a.maxY;
+    }
+
+    inline uint16_t clampCell(float v, uint32_t limit) {
+        if (!(v > 0)) {
+            return 0;
+        }
+        return (uint16_t) std::min<float>(v, (float) (limit - 1));
+    }
+}
+
+void SpatialGrid::init(float x, float y, float width, float height, float cellSize) {
+    originX = x;
+    originY = y;
+    invCellSize = 1.0f / cellSize;
+    cols = std::max<uint32_t>(1, std::min<uint32_t>(UINT16_MAX,
+                                                    (uint32_t) std::ceil(width * invCellSize)));
+    rows = std::max<uint32_t>(1, std::min<uint32_t>(UINT16_MAX,
+                                                    (uint32_t) std::ceil(height * invCellSize)));
+    // New geometry: every span is stale, so refile everything on commit().
+    cellStart.assign(cols * rows + 1, 0);
+    cellCount.assign(cols * rows, 0);
+    for (uint32_t i = 0; i < (uint32_t) flags.size(); i++) {
+        flags[i] &= ~Listed;
+        if (flags[i] & Wanted) {
+            queue(i);
+        }
+    }
+}
+
+void SpatialGrid::resize(size_t count) {
+    for (size_t i = count; i < flags.size(); i++) {
+        if (flags[i] & Listed) {
+            unlink((uint32_t) i, spans[i]);
+        }
+    }
+    if (count < flags.size()) {
+        moved.erase(std::remove_if(moved.begin(), moved.end(), [count](uint32_t id) {
+            return id >= count;
+        }), moved.end());
+    }
+    bounds.resize(count, Aabb{0, 0, 0, 0});
+    spans.resize(count, Span{0, 0, 0, 0});
+    flags.resize(count, 0);
+    visited.resize(count, 0);
+    // Each id is queued at most once, so queueing never allocates.
+    moved.reserve(count);
+}
+
+SpatialGrid::Span SpatialGrid::spanOf(const Aabb &box) const {
+    return Span{clampCell((box.minX - originX) * invCellSize, cols),
+                clampCell((box.minY - originY) * invCellSize, rows),
+                clampCell((box.maxX - originX) * invCellSize, cols),
+                clampCell((box.maxY - originY) * invCellSize, rows)};
+}
+
+void SpatialGrid::queue(uint32_t id) {
+    if (!(flags[id] & Queued)) {
+        flags[id] |= Queued;
+        moved.push_back(id);
+    }
+}
+
+bool SpatialGrid::link(uint32_t id, const Span &span) {
+    bool fits = true;
+    for (uint32_t y = span.y0; y <= span.y1; y++) {
+        for (uint32_t x = span.x0; x <= span.x1; x++) {
+            auto cell = y * cols + x;
+            if (cellStart[cell] + cellCount[cell] < cellStart[cell + 1]) {
+                items[cellStart[cell] + cellCount[cell]++] = id;
+            } else {
+                fits = false;
+            }
+        }
+    }
+    return fits;
+}
+
+void SpatialGrid::unlink(uint32_t id, const Span &span) {
+    for (uint32_t y = span.y0; y <= span.y1; y++) {
+        for (uint32_t x = span.x0; x <= span.x1; x++) {
+            auto cell = y * cols + x;
+            auto *first = items.data() + cellStart[cell];
+            auto *last = first + cellCount[cell];
+            auto *it = std::find(first, last, id);
+            // Missing when linking it overflowed earlier in this commit.
+            if (it != last) {
+                *it = *(last - 1);
+                cellCount[cell]--;
+            }
+        }
+    }
+}
+
+void SpatialGrid::repack() {
+    // Counting sort: count per cell, leave headroom, prefix-sum into starts,
+    // then scatter.
+    std::fill(cellCount.begin(), cellCount.end(), 0);
+    for (size_t i = 0; i < spans.size(); i++) {
+        if (!(flags[i] & Listed)) {
+            continue;
+        }
+        auto &s = spans[i];
+        for (uint32_t y = s.y0; y <= s.y1; y++) {
+            for (uint32_t x = s.x0; x <= s.x1; x++) {
+                cellCount[y * cols + x]++;
+            }
+        }
+    }
+    cellStart[0] = 0;
+    for (size_t c = 0; c < cellCount.size(); c++) {
+        cellStart[c + 1] = cellStart[c] + cellCount[c] + cellCount[c] / 2 + 4;
+        cellCount[c] = 0;
+    }
+    if (items.capacity() < cellStart.back()) {
+        // Room to grow, so the next few re-packs reuse it.
+        items.reserve(cellStart.back() * 2);
+    }
+    items.resize(cellStart.back());
+    for (size_t i = 0; i < spans.size(); i++) {
+        if (flags[i] & Listed) {
+            link((uint32_t) i, spans[i]);
+        }
+    }
+}
+
+void SpatialGrid::setBounds(uint32_t id, const Aabb &box) {
+    bounds[id] = box;
+    flags[id] |= Wanted;
+    if (!(flags[id] & Listed) || !(spanOf(box) == spans[id])) {
+        queue(id);
+    }
+}
+
+void SpatialGrid::updatePoints(const float *x, const float *y, size_t count, float slack) {
+    for (size_t i = 0; i < count; i++) {
+        auto &b = bounds[i];
+        if (x[i] < b.minX || x[i] > b.maxX || y[i] < b.minY || y[i] > b.maxY ||
+            !(flags[i] & Wanted)) {
+            setBounds((uint32_t) i, Aabb{x[i] - slack, y[i] - slack, x[i] + slack, y[i] + slack});
+        }
+    }
+}
+
+void SpatialGrid::remove(uint32_t id) {
+    flags[id] &= ~Wanted;
+    if (flags[id] & Listed) {
+        queue(id);
+    }
+}
+
+void SpatialGrid::commit() {
+    bool overflow = false;
+    for (auto id: moved) {
+        auto &f = flags[id];
+        f &= ~Queued;
+        auto span = spanOf(bounds[id]);
+        if ((f & Listed) && (!(f & Wanted) || !(span == spans[id]))) {
+            unlink(id, spans[id]);
+            f &= ~Listed;
+        }
+        if ((f & Wanted) && !(f & Listed)) {
+            overflow |= !link(id, span);
+            spans[id] = span;
+            f |= Listed;
+        }
+    }
+    moved.clear();
+    if (overflow) {
+        repack();
+    }
+}
+
+uint32_t SpatialGrid::nextStamp() {
+    if (++queryStamp == 0) {
+        std::fill(visited.begin(), visited.end(), 0);
+        queryStamp = 1;
+    }
+    return queryStamp;
+}
+
+template<typename Test, typename Visit>
+void SpatialGrid::scan(const Aabb &region, Test test, Visit visit) {
+    auto span = spanOf(region);
+    auto stamp = nextStamp();
+    for (uint32_t y = span.y0; y <= span.y1; y++) {
+        for (uint32_t x = span.x0; x <= span.x1; x++) {
+            auto cell = y * cols + x;
+            for (auto i = cellStart[cell]; i < cellStart[cell] + cellCount[cell]; i++) {
+                auto id = items[i];
+                if (visited[id] == stamp) {
+                    continue;
+                }
+                visited[id] = stamp;
+                if (test(bounds[id]) && !visit(id)) {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+template<typename Test>
+size_t SpatialGrid::query(const Aabb &region, Test test, uint32_t *out, size_t maxOut) {
+    size_t found = 0;
+    scan(region, test, [out, maxOut, &found](uint32_t id) {
+        if (found == maxOut) {
+            return false;
+        }
+        out[found++] = id;
+        return true;
+    });
+    return found;
+}
+
+size_t SpatialGrid::queryPoint(float x, float y, uint32_t *out, size_t maxOut) {
+    Aabb point{x, y, x, y};
+    return query(point, [&point](const Aabb &b) { return overlaps(point, b); }, out, maxOut);
+}
+
+size_t SpatialGrid::queryRadius(float x, float y, float radius, uint32_t *out, size_t maxOut) {
+    Aabb region{x - radius, y - radius, x + radius, y + radius};
+    float r2 = radius * radius;
+    return query(region, [x, y, r2](const Aabb &b) {
+        float dx = x - std::max(b.minX, std::min(x, b.maxX));
+        float dy = y - std::max(b.minY, std::min(y, b.maxY));
+        return dx * dx + dy * dy <= r2;
+    }, out, maxOut);
+}
+
+size_t SpatialGrid::queryAabb(const Aabb &box, uint32_t *out, size_t maxOut) {
+    return query(box, [&box](const Aabb &b) { return overlaps(box, b); }, out, maxOut);
+}
+
+bool SpatialGrid::queryNearest(float x, float y, float radius, const float *px, const float *py,
+                               uint32_t *nearest) {
+    // A tracked point lies inside its box, so every point in reach is in a
+    // box overlapping the region.
+    Aabb region{x - radius, y - radius, x + radius, y + radius};
+    float best = radius * radius;
+    bool found = false;
+    scan(region, [&region](const Aabb &b) { return overlaps(region, b); },
+         [x, y, px, py, nearest, &best, &found](uint32_t id) {
+             float dx = px[id] - x, dy = py[id] - y;
+             if (dx * dx + dy * dy <= best) {
+                 best = dx * dx + dy * dy;
+                 *nearest = id;
+                 found = true;
+             }
+             return true;
+         });
+    return found;
+}
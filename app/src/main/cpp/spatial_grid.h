@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Aabb {
+    float minX, minY, maxX, maxY;
+};
+
+/**
+ * Uniform-grid spatial hash over a fixed rectangle for hit-testing and
+ * proximity queries.
+ * Objects are dense ids [0, size()) with an AABB each. Cell contents are
+ * slices of one packed array with some headroom each, so a query reads
+ * contiguous memory. setBounds() only queues objects whose cell span
+ * changed; commit() moves just those between slices, and re-packs every
+ * cell (counting sort, reusing its arrays) only when a slice overflows.
+ * Steady-state frames neither rehash nor allocate.
+ * Queries write ids to a caller buffer and return how many matched.
+ */
+class SpatialGrid {
+private:
+    struct Span {
+        uint16_t x0, y0, x1, y1;
+
+        inline bool operator==(const Span &o) const {
+            return x0 == o.x0 && y0 == o.y0 && x1 == o.x1 && y1 == o.y1;
+        }
+    };
+
+    enum : uint8_t {
+        // setBounds() was called and remove() was not.
+        Wanted = 1,
+        // Listed in the cells of its span.
+        Listed = 2,
+        // In moved, waiting for commit().
+        Queued = 4,
+    };
+
+    float originX = 0, originY = 0;
+    float invCellSize = 1;
+    // A single cell until init() is called.
+    uint32_t cols = 1, rows = 1;
+    std::vector<Aabb> bounds;
+    // Span each listed object is filed under.
+    std::vector<Span> spans;
+    std::vector<uint8_t> flags;
+    // Cell c owns items[cellStart[c], cellStart[c + 1]), of which the
+    // first cellCount[c] are in use.
+    std::vector<uint32_t> cellStart = {0, 0};
+    std::vector<uint32_t> cellCount = {0};
+    std::vector<uint32_t> items;
+    std::vector<uint32_t> moved;
+    // Per-object stamp used to report objects spanning several cells once.
+    std::vector<uint32_t> visited;
+    uint32_t queryStamp = 0;
+
+    Span spanOf(const Aabb &box) const;
+
+    void queue(uint32_t id);
+
+    bool link(uint32_t id, const Span &span);
+
+    void unlink(uint32_t id, const Span &span);
+
+    void repack();
+
+    uint32_t nextStamp();
+
+    /**
+     * Calls visit(id) once for each object whose box passes test(), until it returns false.
+     */
+    template<typename Test, typename Visit>
+    void scan(const Aabb &region, Test test, Visit visit);
+
+    template<typename Test>
+    size_t query(const Aabb &region, Test test, uint32_t *out, size_t maxOut);
+
+public:
+    /**
+     * Cover [x, x+width) x [y, y+height); objects outside are clamped to the edge cells.
+     */
+    void init(float x, float y, float width, float height, float cellSize);
+
+    /**
+     * Grow or shrink the id range; new ids start out absent.
+     */
+    void resize(size_t count);
+
+    inline size_t size() const { return bounds.size(); }
+
+    void setBounds(uint32_t id, const Aabb &box);
+
+    /**
+     * Track points with loose boxes of half-size slack around them. An
+     * object is only re-boxed once its point leaves the box, so most
+     * points cost two compares; queries then test the loose boxes, and
+     * callers wanting exact hits filter the results by position.
+     */
+    void updatePoints(const float *x, const float *y, size_t count, float slack);
+
+    void remove(uint32_t id);
+
+    /**
+     * Move the objects queued since the last commit between cells.
+     */
+    void commit();
+
+    /**
+     * @return objects waiting for commit()
+     */
+    inline size_t pendingMoves() const { return moved.size(); }
+
+    size_t queryPoint(float x, float y, uint32_t *out, size_t maxOut);
+
+    size_t queryRadius(float x, float y, float radius, uint32_t *out, size_t maxOut);
+
+    size_t queryAabb(const Aabb &box, uint32_t *out, size_t maxOut);
+
+    /**
+     * Nearest of the points tracked with updatePoints() within radius of
+     * (x, y), by exact distance to px/py; every candidate is considered.
+     * @return false if none is in reach
+     */
+    bool queryNearest(float x, float y, float radius, const float *px, const float *py,
+                      uint32_t *nearest);
+};
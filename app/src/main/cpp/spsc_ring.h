@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * Bounded single-producer/single-consumer ring buffer.
+ * Storage is allocated once by the constructor; push/pop and the bulk
+ * write/read never lock or allocate, so either side may be a real-time
+ * thread. Exactly one thread may produce and one thread consume.
+ */
+template<typename T>
+class SpscRing {
+private:
+    std::unique_ptr<T[]> items;
+    size_t mask;
+    // Each index is written by one side only; keep them on separate lines.
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+
+public:
+    /**
+     * @param capacity rounded up to a power of two
+     */
+    explicit SpscRing(size_t capacity) {
+        size_t n = 1;
+        while (n < capacity) {
+            n <<= 1;
+        }
+        items.reset(new T[n]);
+        mask = n - 1;
+    }
+
+    SpscRing(const SpscRing &) = delete;
+
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    inline size_t capacity() const { return mask + 1; }
+
+    /**
+     * Items ready for the consumer.
+     */
+    inline size_t readable() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Free space for the producer.
+     */
+    inline size_t writable() const { return capacity() - readable(); }
+
+    bool push(const T &item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) > mask) {
+            return false;
+        }
+        items[t & mask] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Producer side: copy up to count items in.
+     * @return the number of items written
+     */
+    size_t write(const T *src, size_t count) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t n = std::min(count, capacity() - (t - head.load(std::memory_order_acquire)));
+        size_t first = std::min(n, capacity() - (t & mask));
+        std::copy(src, src + first, &items[t & mask]);
+        std::copy(src + first, src + n, &items[0]);
+        tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+    /**
+     * Consumer side: copy up to count items out.
+     * @return the number of items read
+     */
+    size_t read(T *dst, size_t count) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t n = std::min(count, tail.load(std::memory_order_acquire) - h);
+        size_t first = std::min(n, capacity() - (h & mask));
+        std::copy(&items[h & mask], &items[h & mask] + first, dst);
+        std::copy(&items[0], &items[0] + (n - first), dst + first);
+        head.store(h + n, std::memory_order_release);
+        return n;
+    }
+
+    /**
+     * Consumer side: drop everything currently queued.
+     */
+    void clear() { head.store(tail.load(std::memory_order_acquire), std::memory_order_release); }
+};
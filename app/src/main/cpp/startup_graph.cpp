@@ -0,0 +1,156 @@
+#include "startup_graph.h"
+
+#include <string>
+
+#include "engine_clock.h"
+#include "logging.h"
+
+StartupGraph::~StartupGraph() {
+    // Nodes capture the engine; none may still run once it is destroyed.
+    if (jobs) {
+        jobs->wait(&inFlight);
+    }
+}
+
+StartupGraph::NodeId StartupGraph::add(const char *name, std::function<void()> fn,
+                                       std::initializer_list<NodeId> dependencies,
+                                       Thread thread) {
+    auto id = (NodeId) nodes.size();
+    auto node = std::make_unique<Node>();
+    node->name = name;
+    node->fn = std::move(fn);
+    node->thread = thread;
+    node->gate = false;
+    node->dependencies.assign(dependencies.begin(), dependencies.end());
+    node->waiting.store((uint32_t) dependencies.size(), std::memory_order_relaxed);
+    for (auto dependency : dependencies) {
+        nodes[dependency]->dependents.push_back(id);
+    }
+    nodes.push_back(std::move(node));
+    remaining.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+StartupGraph::NodeId StartupGraph::addGate(const char *name) {
+    auto id = add(name, nullptr);
+    nodes[id]->gate = true;
+    // Held back until signal().
+    nodes[id]->waiting.store(1, std::memory_order_relaxed);
+    return id;
+}
+
+void StartupGraph::start(JobSystem *jobSystem) {
+    jobs = jobSystem->threadCount() > 1 ? jobSystem : nullptr;
+    beginNs = monotonicNs();
+    for (NodeId id = 0; id < nodes.size(); id++) {
+        if (nodes[id]->dependencies.empty() && !nodes[id]->gate) {
+            ready(id);
+        }
+    }
+}
+
+bool StartupGraph::signal(NodeId gate) {
+    auto &node = *nodes[gate];
+    if (!node.gate || node.waiting.exchange(0, std::memory_order_acq_rel) == 0) {
+        return false;
+    }
+    node.readyNs = node.startNs = beginNs;
+    finish(gate);
+    return true;
+}
+
+void StartupGraph::ready(NodeId id) {
+    auto &node = *nodes[id];
+    node.readyNs = monotonicNs();
+    if (node.thread == Thread::Any && jobs) {
+        jobs->submit([](void *data, uint32_t begin, uint32_t) {
+            static_cast<StartupGraph *>(data)->run(begin);
+        }, this, id, id + 1, &inFlight);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mainMutex);
+        mainReady.push_back(id);
+    }
+    if (onMainReady) {
+        onMainReady();
+    }
+}
+
+void StartupGraph::runMainReady() {
+    for (;;) {
+        NodeId id;
+        {
+            std::lock_guard<std::mutex> lock(mainMutex);
+            if (mainReady.empty()) {
+                return;
+            }
+            id = mainReady.front();
+            mainReady.erase(mainReady.begin());
+        }
+        run(id);
+    }
+}
+
+void StartupGraph::run(NodeId id) {
+    auto &node = *nodes[id];
+    node.startNs = monotonicNs();
+    if (node.fn) {
+        node.fn();
+    }
+    finish(id);
+}
+
+void StartupGraph::finish(NodeId id) {
+    auto &node = *nodes[id];
+    node.endNs = monotonicNs();
+    node.finished.store(true, std::memory_order_release);
+    for (auto dependent : node.dependents) {
+        if (nodes[dependent]->waiting.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            ready(dependent);
+        }
+    }
+    if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        report();
+    }
+}
+
+void StartupGraph::report() const {
+    // Walk back from the last node to finish, each time through the
+    // dependency that finished last: that is what held the node up.
+    NodeId last = 0;
+    for (NodeId id = 1; id < nodes.size(); id++) {
+        if (nodes[id]->endNs > nodes[last]->endNs) {
+            last = id;
+        }
+    }
+    std::vector<NodeId> path{last};
+    for (;;) {
+        auto &deps = nodes[path.back()]->dependencies;
+        if (deps.empty()) {
+            break;
+        }
+        NodeId gating = deps[0];
+        for (auto dependency : deps) {
+            if (nodes[dependency]->endNs > nodes[gating]->endNs) {
+                gating = dependency;
+            }
+        }
+        path.push_back(gating);
+    }
+    std::string steps;
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        auto &node = *nodes[*it];
+        char step[96];
+        if (node.gate) {
+            snprintf(step, sizeof(step), "%s%s (waited %.1fms)", steps.empty() ? "" : " -> ",
+                     node.name, (node.endNs - beginNs) / 1e6);
+        } else {
+            snprintf(step, sizeof(step), "%s%s %.1fms", steps.empty() ? "" : " -> ", node.name,
+                     (node.endNs - node.startNs) / 1e6);
+        }
+        steps += step;
+    }
+    LOGI("startup: %zu nodes in %.1fms, critical path: %s", nodes.size(),
+         (nodes[last]->endNs - beginNs) / 1e6, steps.c_str());
+}
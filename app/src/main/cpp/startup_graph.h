@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "job_system.h"
+
+/**
+ * Startup work as a dependency graph.
+ * Subsystems are added as nodes with the nodes they depend on; once
+ * started, every node whose dependencies are met runs on the job system,
+ * or on the engine thread for nodes that must (EGL, looper-bound work),
+ * which picks them up in runMainReady(). Gates are nodes completed from
+ * outside, such as the window becoming available. When the last node
+ * finishes, the critical path is logged with each step's duration.
+ */
+class StartupGraph {
+public:
+    typedef uint32_t NodeId;
+
+    enum class Thread : uint8_t {
+        Any, Main
+    };
+
+private:
+    struct Node {
+        const char *name;
+        std::function<void()> fn;
+        Thread thread;
+        bool gate;
+        std::vector<NodeId> dependencies;
+        std::vector<NodeId> dependents;
+        std::atomic<uint32_t> waiting{0};
+        std::atomic<bool> finished{false};
+        int64_t readyNs = 0;
+        int64_t startNs = 0;
+        int64_t endNs = 0;
+    };
+
+    std::vector<std::unique_ptr<Node>> nodes;
+    JobSystem *jobs = nullptr;
+    JobCounter inFlight;
+    std::mutex mainMutex;
+    std::vector<NodeId> mainReady;
+    std::atomic<uint32_t> remaining{0};
+    int64_t beginNs = 0;
+
+    void ready(NodeId id);
+
+    void run(NodeId id);
+
+    void finish(NodeId id);
+
+    void report() const;
+
+public:
+    // Called from any thread when a main-thread node becomes ready, e.g. to
+    // wake the looper.
+    std::function<void()> onMainReady;
+
+    ~StartupGraph();
+
+    /**
+     * @param dependencies nodes added earlier
+     */
+    NodeId add(const char *name, std::function<void()> fn,
+               std::initializer_list<NodeId> dependencies = {}, Thread thread = Thread::Any);
+
+    /**
+     * A node with no work, finished by signal().
+     */
+    NodeId addGate(const char *name);
+
+    /**
+     * Run every node without dependencies. A job system with no worker
+     * threads makes every node run on the engine thread.
+     */
+    void start(JobSystem *jobSystem);
+
+    /**
+     * Finish a gate; call from the engine thread.
+     * @return false if it had already been signalled
+     */
+    bool signal(NodeId gate);
+
+    /**
+     * Run the main-thread nodes that are ready; call from the engine thread.
+     */
+    void runMainReady();
+
+    inline bool isFinished(NodeId id) const {
+        return nodes[id]->finished.load(std::memory_order_acquire);
+    }
+
+    inline bool done() const { return !remaining.load(std::memory_order_acquire); }
+};
@@ -0,0 +1,111 @@
+#include "startup_trace.h"
+
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+#include "engine_clock.h"
+#include "logging.h"
+
+namespace {
+    const char *const names[] = {
+            "processStart", "libraryLoad", "androidMain", "engineInit", "initWindow",
+            "eglInitialize", "eglConfig", "eglContext", "firstSwap",
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == (size_t) Milestone::Count);
+
+    std::atomic<int64_t> marks[(size_t) Milestone::Count];
+    std::atomic<bool> emitted{false};
+    std::atomic<const char *> variant{nullptr};
+    bool warm = false;
+
+    /**
+     * Process start time on the CLOCK_MONOTONIC timeline, or 0.
+     * /proc/self/stat field 22 is the start time in clock ticks since
+     * boot, which is CLOCK_BOOTTIME.
+     */
+    int64_t processStartNs() {
+        FILE *fp = fopen("/proc/self/stat", "r");
+        if (!fp) {
+            return 0;
+        }
+        char stat[1024];
+        size_t length = fread(stat, 1, sizeof(stat) - 1, fp);
+        fclose(fp);
+        stat[length] = 0;
+        // The command name may contain spaces; fields resume after its ')'.
+        const char *p = strrchr(stat, ')');
+        unsigned long long ticks = 0;
+        if (!p || sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u "
+                                "%*d %*d %*d %*d %*d %*d %llu", &ticks) != 1) {
+            return 0;
+        }
+        timespec boot;
+        clock_gettime(CLOCK_BOOTTIME, &boot);
+        int64_t bootNs = (int64_t) boot.tv_sec * 1000000000LL + boot.tv_nsec;
+        int64_t startNs = (int64_t) (ticks * 1000000000ULL / sysconf(_SC_CLK_TCK));
+        return monotonicNs() - (bootNs - startNs);
+    }
+
+    struct LoadMark {
+        LoadMark() {
+            marks[(size_t) Milestone::ProcessStart].store(processStartNs(),
+                                                          std::memory_order_relaxed);
+            StartupTrace::mark(Milestone::LibraryLoad);
+        }
+    } loadMark;
+}
+
+void StartupTrace::mark(Milestone milestone) {
+    if (milestone == Milestone::AndroidMain && at(Milestone::AndroidMain)) {
+        // A new launch in a process that already started once.
+        for (size_t i = (size_t) Milestone::AndroidMain; i < (size_t) Milestone::Count; i++) {
+            marks[i].store(0, std::memory_order_relaxed);
+        }
+        warm = true;
+        emitted.store(false, std::memory_order_relaxed);
+    }
+    int64_t expected = 0;
+    marks[(size_t) milestone].compare_exchange_strong(expected, monotonicNs(),
+                                                      std::memory_order_relaxed);
+}
+
+int64_t StartupTrace::at(Milestone milestone) {
+    return marks[(size_t) milestone].load(std::memory_order_relaxed);
+}
+
+void StartupTrace::setVariant(const char *name) {
+    variant.store(name, std::memory_order_relaxed);
+}
+
+void StartupTrace::emit() {
+    if (emitted.exchange(true, std::memory_order_relaxed)) {
+        return;
+    }
+    auto first = warm ? Milestone::AndroidMain : Milestone::ProcessStart;
+    int64_t originNs = 0;
+    for (auto i = (size_t) first; i < (size_t) Milestone::Count && !originNs; i++) {
+        originNs = at((Milestone) i);
+    }
+    char record[512];
+    int length = snprintf(record, sizeof(record), "{\"v\":1,\"launch\":\"%s\"",
+                          warm ? "warm" : "cold");
+    if (const char *name = variant.load(std::memory_order_relaxed)) {
+        length += snprintf(record + length, sizeof(record) - length, ",\"variant\":\"%s\"",
+                           name);
+    }
+    for (auto i = (size_t) first; i < (size_t) Milestone::Count; i++) {
+        int64_t ns = at((Milestone) i);
+        if (ns) {
+            length += snprintf(record + length, sizeof(record) - length, ",\"%s\":%.2f",
+                               names[i], (ns - originNs) / 1e6);
+        } else {
+            length += snprintf(record + length, sizeof(record) - length, ",\"%s\":null",
+                               names[i]);
+        }
+    }
+    snprintf(record + length, sizeof(record) - length, "}");
+    LOGI("startup-record %s", record);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Launch milestones, in the order a cold start passes them. Each marks the
+ * moment the step finished.
+ */
+enum class Milestone : uint8_t {
+    // Process fork, from /proc/self/stat (scheduler tick resolution).
+    ProcessStart,
+    // Our library's static initializers; NativeActivity calls
+    // ANativeActivity_onCreate (in the glue) right after loading it.
+    LibraryLoad,
+    AndroidMain,
+    EngineInit,
+    InitWindow,
+    EglInitialize,
+    EglConfig,
+    EglContext,
+    FirstSwap,
+    Count
+};
+
+/**
+ * Time-to-first-frame breakdown. mark() is a clock read and a store, safe
+ * from any thread; only the first mark of each milestone per launch
+ * counts. emit() logs the launch as one line,
+ *
+ *     startup-record {"v":1,"launch":"cold","variant":"jni-cached","processStart":0.0,...}
+ *
+ * with milliseconds since the earliest milestone of the launch and null
+ * for milestones that were not reached. The variant names the build
+ * flavour, so launches of two builds can be compared side by side. tools/startup_report.py aggregates
+ * these over runs from logcat output. A launch in a process that already
+ * reached android_main is a warm start: the process and library
+ * milestones are stale and left out.
+ */
+namespace StartupTrace {
+    void mark(Milestone milestone);
+
+    /**
+     * @return CLOCK_MONOTONIC nanoseconds, or 0 if not reached this launch
+     */
+    int64_t at(Milestone milestone);
+
+    /**
+     * Tag this launch's record; name must outlive the process (a literal).
+     */
+    void setVariant(const char *name);
+
+    /**
+     * Log the startup record; once per launch.
+     */
+    void emit();
+}
@@ -0,0 +1,156 @@
+#include "task.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "logging.h"
+
+namespace {
+    const size_t blockSize = 1024;
+    const size_t blockCount = 256;
+
+    union Block {
+        Block *next;
+        alignas(std::max_align_t) unsigned char bytes[blockSize];
+    };
+
+    Block blocks[blockCount];
+    Block *freeList = nullptr;
+    size_t carved = 0;
+    uint32_t fallbacks = 0;
+}
+
+namespace CoroFramePool {
+    void *alloc(size_t size) {
+        if (size <= blockSize) {
+            if (freeList) {
+                Block *b = freeList;
+                freeList = b->next;
+                return b;
+            }
+            if (carved < blockCount) {
+                return &blocks[carved++];
+            }
+        }
+        fallbacks++;
+        void *p = malloc(size);
+        if (!p) {
+            abort();
+        }
+        return p;
+    }
+
+    void release(void *p) {
+        // Comparing unrelated pointers is unspecified; compare addresses.
+        auto address = reinterpret_cast<uintptr_t>(p);
+        auto first = reinterpret_cast<uintptr_t>(blocks);
+        if (address >= first && address < first + sizeof(blocks)) {
+            auto *b = static_cast<Block *>(p);
+            b->next = freeList;
+            freeList = b;
+        } else {
+            free(p);
+        }
+    }
+
+    uint32_t heapFallbacks() {
+        return fallbacks;
+    }
+}
+
+void Task::promise_type::unhandled_exception() {
+    LOGW("task: unhandled exception");
+    abort();
+}
+
+Scheduler::~Scheduler() {
+    // Destroying a root also destroys any child task it is awaiting.
+    for (auto h: roots) {
+        h.destroy();
+    }
+}
+
+void Scheduler::init(JobSystem *jobSystem, size_t capacity) {
+    jobs = jobSystem;
+    roots.reserve(capacity);
+    nextFrameWaiters.reserve(capacity);
+    resuming.reserve(capacity);
+    timers.reserve(capacity);
+    fences.reserve(capacity);
+    completed.reserve(capacity);
+    completedSwap.reserve(capacity);
+}
+
+void Scheduler::setDisplay(EGLDisplay display) {
+    fenceDisplay = display;
+    createSync = (PFNEGLCREATESYNCKHRPROC) eglGetProcAddress("eglCreateSyncKHR");
+    clientWaitSync = (PFNEGLCLIENTWAITSYNCKHRPROC) eglGetProcAddress("eglClientWaitSyncKHR");
+    destroySync = (PFNEGLDESTROYSYNCKHRPROC) eglGetProcAddress("eglDestroySyncKHR");
+    if (!createSync || !clientWaitSync || !destroySync) {
+        createSync = nullptr;
+    }
+}
+
+void Scheduler::onDisplayLost() {
+    for (auto &f: fences) {
+        resuming.push_back(f.handle);
+    }
+    fences.clear();
+    fenceDisplay = EGL_NO_DISPLAY;
+    createSync = nullptr;
+}
+
+void Scheduler::spawn(Task task) {
+    auto h = task.release();
+    roots.push_back(h);
+    nextFrameWaiters.push_back(h);
+}
+
+void Scheduler::tick(int64_t now) {
+    nowNs = now;
+    // Anything suspended during this tick waits for the next one, so gather
+    // the ready set first.
+    resuming.insert(resuming.end(), nextFrameWaiters.begin(), nextFrameWaiters.end());
+    nextFrameWaiters.clear();
+    {
+        std::lock_guard<std::mutex> lock(completedMutex);
+        completed.swap(completedSwap);
+    }
+    resuming.insert(resuming.end(), completedSwap.begin(), completedSwap.end());
+    completedSwap.clear();
+    for (size_t i = 0; i < timers.size();) {
+        if (timers[i].deadlineNs <= now) {
+            resuming.push_back(timers[i].handle);
+            timers[i] = timers.back();
+            timers.pop_back();
+        } else {
+            i++;
+        }
+    }
+    for (size_t i = 0; i < fences.size();) {
+        if (clientWaitSync(fenceDisplay, fences[i].sync, 0, 0) != EGL_TIMEOUT_EXPIRED_KHR) {
+            destroySync(fenceDisplay, fences[i].sync);
+            resuming.push_back(fences[i].handle);
+            fences[i] = fences.back();
+            fences.pop_back();
+        } else {
+            i++;
+        }
+    }
+    // Resuming may suspend onto nextFrameWaiters/timers but never appends
+    // to resuming, so iterating by index is safe.
+    for (size_t i = 0; i < resuming.size(); i++) {
+        resuming[i].resume();
+    }
+    resumes += resuming.size();
+    resuming.clear();
+    for (size_t i = 0; i < roots.size();) {
+        if (roots[i].done()) {
+            roots[i].destroy();
+            roots[i] = roots.back();
+            roots.pop_back();
+        } else {
+            i++;
+        }
+    }
+}
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "job_system.h"
+
+/**
+ * Fixed pool of coroutine frames.
+ * Frames are created and destroyed on the engine thread only, so the pool
+ * is a plain free list; frames larger than a block, or any beyond the pool
+ * size, fall back to malloc and are counted.
+ */
+namespace CoroFramePool {
+    void *alloc(size_t size);
+
+    void release(void *p);
+
+    uint32_t heapFallbacks();
+}
+
+/**
+ * Coroutine returning nothing, started lazily.
+ * Either hand it to Scheduler::spawn() or co_await it from another Task,
+ * in which case it runs inline and resumes the awaiting task when done.
+ */
+class Task {
+public:
+    struct promise_type {
+        std::coroutine_handle<> continuation;
+
+        Task get_return_object() {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                auto next = h.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_void() {}
+
+        void unhandled_exception();
+
+        static void *operator new(size_t size) { return CoroFramePool::alloc(size); }
+
+        static void operator delete(void *p) { CoroFramePool::release(p); }
+    };
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+public:
+    explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+
+    Task(Task &&o) noexcept: handle(std::exchange(o.handle, nullptr)) {}
+
+    Task(const Task &) = delete;
+
+    Task &operator=(const Task &) = delete;
+
+    ~Task() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    inline bool done() const { return !handle || handle.done(); }
+
+    std::coroutine_handle<promise_type> release() { return std::exchange(handle, nullptr); }
+
+    bool await_ready() const { return done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+
+    void await_resume() {}
+};
+
+/**
+ * Runs Tasks from the engine's frame loop.
+ * Every resumption happens on the engine thread inside tick(); work handed
+ * to runAsync() executes on the job system and only its completion is
+ * marshalled back. Waiter lists are reserved up front so steady-state
+ * suspension does not allocate.
+ */
+class Scheduler {
+private:
+    struct Timer {
+        int64_t deadlineNs;
+        std::coroutine_handle<> handle;
+    };
+
+    struct Fence {
+        EGLSyncKHR sync;
+        std::coroutine_handle<> handle;
+    };
+
+    JobSystem *jobs = nullptr;
+    std::vector<std::coroutine_handle<Task::promise_type>> roots;
+    std::vector<std::coroutine_handle<>> nextFrameWaiters;
+    std::vector<std::coroutine_handle<>> resuming;
+    std::vector<Timer> timers;
+    std::vector<Fence> fences;
+    std::mutex completedMutex;
+    std::vector<std::coroutine_handle<>> completed;
+    std::vector<std::coroutine_handle<>> completedSwap;
+    int64_t nowNs = 0;
+    uint64_t resumes = 0;
+
+    EGLDisplay fenceDisplay = EGL_NO_DISPLAY;
+    PFNEGLCREATESYNCKHRPROC createSync = nullptr;
+    PFNEGLCLIENTWAITSYNCKHRPROC clientWaitSync = nullptr;
+    PFNEGLDESTROYSYNCKHRPROC destroySync = nullptr;
+
+    void complete(std::coroutine_handle<> h) {
+        std::lock_guard<std::mutex> lock(completedMutex);
+        completed.push_back(h);
+    }
+
+public:
+    ~Scheduler();
+
+    void init(JobSystem *jobSystem, size_t capacity = 256);
+
+    /**
+     * Load EGL_KHR_fence_sync for gpuFence(); call once a context is current.
+     */
+    void setDisplay(EGLDisplay display);
+
+    /**
+     * The context is gone, so are its fences: wake everything waiting on one.
+     */
+    void onDisplayLost();
+
+    /**
+     * Take ownership of a task and start it on the next tick.
+     */
+    void spawn(Task task);
+
+    /**
+     * Resume everything that became ready since the last tick.
+     */
+    void tick(int64_t now);
+
+    /**
+     * @return true while any spawned task has not finished
+     */
+    inline bool pending() const { return !roots.empty(); }
+
+    inline uint64_t getResumes() const { return resumes; }
+
+    struct NextFrame {
+        Scheduler *s;
+
+        bool await_ready() const { return false; }
+
+        void await_suspend(std::coroutine_handle<> h) { s->nextFrameWaiters.push_back(h); }
+
+        void await_resume() {}
+    };
+
+    /**
+     * co_await nextFrame(): continue on the next tick.
+     */
+    NextFrame nextFrame() { return NextFrame{this}; }
+
+    struct Sleep {
+        Scheduler *s;
+        int64_t deadlineNs;
+
+        bool await_ready() const { return deadlineNs <= s->nowNs; }
+
+        void await_suspend(std::coroutine_handle<> h) {
+            s->timers.push_back(Timer{deadlineNs, h});
+        }
+
+        void await_resume() {}
+    };
+
+    /**
+     * co_await sleepFor(ns): continue on the first tick at least ns later.
+     */
+    Sleep sleepFor(int64_t ns) { return Sleep{this, nowNs + ns}; }
+
+    template<typename F>
+    struct Async {
+        Scheduler *s;
+        F fn;
+        std::coroutine_handle<> handle;
+
+        bool await_ready() const { return false; }
+
+        void await_suspend(std::coroutine_handle<> h) {
+            handle = h;
+            auto run = [](void *data, uint32_t, uint32_t) {
+                auto *self = static_cast<Async *>(data);
+                self->fn();
+                self->s->complete(self->handle);
+            };
+            if (!s->jobs) {
+                // No worker to hand it to; do it now and resume next tick.
+                run(this, 0, 1);
+                return;
+            }
+            // The background queue, so a jobs.wait() on the engine thread
+            // never ends up running the blocking work itself.
+            s->jobs->submitBackground(run, this);
+        }
+
+        void await_resume() {}
+    };
+
+    /**
+     * co_await runAsync(fn): run fn (e.g. blocking file I/O) on a worker and
+     * continue on the engine thread once it has finished. fn runs inline
+     * when the job system has no worker threads.
+     */
+    template<typename F>
+    Async<F> runAsync(F fn) { return Async<F>{this, std::move(fn), nullptr}; }
+
+    struct GpuFence {
+        Scheduler *s;
+
+        bool await_ready() const { return !s->createSync; }
+
+        bool await_suspend(std::coroutine_handle<> h) {
+            auto sync = s->createSync(s->fenceDisplay, EGL_SYNC_FENCE_KHR, nullptr);
+            if (sync == EGL_NO_SYNC_KHR) {
+                return false;
+            }
+            s->fences.push_back(Fence{sync, h});
+            return true;
+        }
+
+        void await_resume() {}
+    };
+
+    /**
+     * co_await gpuFence(): continue once the GPU has finished every command
+     * issued so far. Resumes immediately without EGL_KHR_fence_sync.
+     */
+    GpuFence gpuFence() { return GpuFence{this}; }
+};
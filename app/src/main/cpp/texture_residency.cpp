@@ -0,0 +1,289 @@
+#include "texture_residency.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "engine_clock.h"
+#include "logging.h"
+#include "mem_tracker.h"
+
+namespace {
+    inline uint32_t mipSize(uint32_t size, uint32_t level) {
+        return std::max(size >> level, 1u);
+    }
+
+    /**
+     * 2x2 box filter into the next level; an odd or unit edge repeats its
+     * last texel.
+     */
+    GpuData downsample(const GpuData &src) {
+        GpuData dst;
+        dst.format = src.format;
+        dst.width = std::max(src.width / 2, 1u);
+        dst.height = std::max(src.height / 2, 1u);
+        uint32_t bpp = GpuData::bytesPerPixel(src.format);
+        dst.bytes.resize((size_t) dst.width * dst.height * bpp);
+        for (uint32_t y = 0; y < dst.height; y++) {
+            uint32_t y0 = std::min(y * 2, src.height - 1);
+            uint32_t y1 = std::min(y * 2 + 1, src.height - 1);
+            const uint8_t *row0 = &src.bytes[(size_t) y0 * src.width * bpp];
+            const uint8_t *row1 = &src.bytes[(size_t) y1 * src.width * bpp];
+            uint8_t *out = &dst.bytes[(size_t) y * dst.width * bpp];
+            for (uint32_t x = 0; x < dst.width; x++) {
+                uint32_t x0 = std::min(x * 2, src.width - 1) * bpp;
+                uint32_t x1 = std::min(x * 2 + 1, src.width - 1) * bpp;
+                for (uint32_t c = 0; c < bpp; c++) {
+                    *out++ = (uint8_t) ((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] +
+                                         row1[x1 + c] + 2) >> 2);
+                }
+            }
+        }
+        return dst;
+    }
+}
+
+TextureResidency::TextureResidency(size_t budgetBytes, uint32_t floorSize)
+        : budget(budgetBytes), floorSize(floorSize) {}
+
+size_t TextureResidency::chainBytes(const Texture &texture, uint32_t level) {
+    size_t bytes = 0;
+    for (uint32_t l = level; l < texture.levels; l++) {
+        bytes += (size_t) mipSize(texture.width, l) * mipSize(texture.height, l);
+    }
+    return bytes * GpuData::bytesPerPixel(texture.format);
+}
+
+bool TextureResidency::load(const Texture &texture, GpuData &data) {
+    totals.loads++;
+    bool ok;
+    {
+        // Decoded data, and the low mips built from it, are charged to assets.
+        MemTagScope tag(MemTag::Assets);
+        ok = texture.loader ? texture.loader(assets, texture.asset, data)
+                            : GpuResources::loadAsset(assets, texture.asset, data);
+    }
+    if (!ok || !data.width || !data.height) {
+        LOGW("textures: failed to load %s", texture.asset.c_str());
+        return false;
+    }
+    return true;
+}
+
+SlotHandle TextureResidency::add(const std::string &asset, const GpuTextureParams &params,
+                                 int priority, GpuResources::Loader loader) {
+    Texture texture{};
+    texture.asset = asset;
+    texture.params = params;
+    texture.priority = priority;
+    texture.loader = std::move(loader);
+    GpuData data;
+    if (!load(texture, data)) {
+        return SlotHandle();
+    }
+    texture.width = data.width;
+    texture.height = data.height;
+    texture.format = data.format;
+    texture.levels = 1;
+    while (mipSize(texture.width, texture.levels - 1) > 1 ||
+           mipSize(texture.height, texture.levels - 1) > 1) {
+        texture.levels++;
+    }
+    texture.floorLevel = 0;
+    while (std::max(mipSize(texture.width, texture.floorLevel),
+                    mipSize(texture.height, texture.floorLevel)) > floorSize) {
+        texture.floorLevel++;
+    }
+    {
+        MemTagScope tag(MemTag::Assets);
+        for (uint32_t level = 0; level < texture.levels; level++) {
+            if (level >= texture.floorLevel) {
+                texture.floorMips.push_back(data);
+            }
+            if (level + 1 < texture.levels) {
+                data = downsample(data);
+            }
+        }
+    }
+    texture.residentLevel = texture.wantedLevel = texture.floorLevel;
+    return textures.insert(std::move(texture));
+}
+
+void TextureResidency::remove(SlotHandle handle) {
+    auto *texture = textures.get(handle);
+    if (!texture) {
+        return;
+    }
+    if (texture->name && contextReady) {
+        glDeleteTextures(1, &texture->name);
+    }
+    textures.erase(handle);
+}
+
+void TextureResidency::clear() {
+    while (!textures.empty()) {
+        remove(textures.handleAt(textures.size() - 1));
+    }
+}
+
+void TextureResidency::upload(Texture &texture, uint32_t level,
+                              const std::vector<GpuData> &levels) {
+    if (texture.name) {
+        glDeleteTextures(1, &texture.name);
+    }
+    auto &params = texture.params;
+    glGenTextures(1, &texture.name);
+    glBindTexture(GL_TEXTURE_2D, texture.name);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, params.minFilter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, params.magFilter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, params.wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, params.wrap);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (uint32_t l = level; l < texture.levels; l++) {
+        auto &mip = l < texture.floorLevel ? levels[l - level]
+                                           : texture.floorMips[l - texture.floorLevel];
+        glTexImage2D(GL_TEXTURE_2D, (GLint) (l - level), (GLint) mip.format,
+                     (GLsizei) mip.width, (GLsizei) mip.height, 0, mip.format,
+                     GL_UNSIGNED_BYTE, mip.bytes.data());
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    texture.residentLevel = (uint8_t) level;
+    texture.residentBytes = chainBytes(texture, level);
+}
+
+GLuint TextureResidency::get(SlotHandle handle) {
+    auto *texture = textures.get(handle);
+    if (!texture || !contextReady) {
+        return 0;
+    }
+    if (!texture->name) {
+        upload(*texture, texture->floorLevel, {});
+    }
+    return texture->name;
+}
+
+void TextureResidency::reportUsage(SlotHandle handle, float screenWidth, float screenHeight) {
+    auto *texture = textures.get(handle);
+    if (!texture || screenWidth <= 0 || screenHeight <= 0) {
+        return;
+    }
+    // Like the GPU's LOD: the larger texel-to-pixel ratio, rounded down so
+    // the loaded mip never has fewer texels than pixels it covers.
+    float ratio = std::max(texture->width / screenWidth, texture->height / screenHeight);
+    auto level = (uint32_t) std::clamp(std::floor(std::log2(std::max(ratio, 1.0f))), 0.0f,
+                                       (float) texture->floorLevel);
+    if (texture->usedFrame != frame || level < texture->wantedLevel) {
+        texture->wantedLevel = (uint8_t) level;
+    }
+    texture->usedFrame = frame;
+}
+
+bool TextureResidency::evictFor(size_t bytes) {
+    size_t resident = 0;
+    for (auto &texture: textures) {
+        resident += texture.residentBytes;
+    }
+    while (resident + bytes > budget) {
+        Texture *victim = nullptr;
+        for (auto &texture: textures) {
+            if (texture.usedFrame == frame || texture.residentLevel >= texture.floorLevel ||
+                !texture.name) {
+                continue;
+            }
+            if (!victim || texture.priority < victim->priority ||
+                (texture.priority == victim->priority && texture.usedFrame < victim->usedFrame)) {
+                victim = &texture;
+            }
+        }
+        if (!victim) {
+            return false;
+        }
+        auto before = victim->residentBytes;
+        upload(*victim, victim->floorLevel, {});
+        victim->wantedLevel = victim->floorLevel;
+        resident -= before - victim->residentBytes;
+        totals.evictions++;
+        totals.evictedBytes += before - victim->residentBytes;
+    }
+    return true;
+}
+
+bool TextureResidency::promote(Texture &texture) {
+    uint32_t level = texture.wantedLevel;
+    size_t extra = chainBytes(texture, level) - texture.residentBytes;
+    if (!evictFor(extra)) {
+        return false;
+    }
+    GpuData data;
+    if (!load(texture, data)) {
+        // Do not retry every frame.
+        texture.wantedLevel = texture.residentLevel;
+        return false;
+    }
+    std::vector<GpuData> levels;
+    for (uint32_t l = 0; l < texture.floorLevel; l++) {
+        if (l >= level) {
+            levels.push_back(data);
+        }
+        if (l + 1 < texture.floorLevel) {
+            data = downsample(data);
+        }
+    }
+    upload(texture, level, levels);
+    totals.promotions++;
+    return true;
+}
+
+void TextureResidency::update(int64_t budgetNs) {
+    if (contextReady) {
+        auto start = monotonicNs();
+        std::vector<Texture *> wanting;
+        for (auto &texture: textures) {
+            if (texture.usedFrame == frame && texture.wantedLevel < texture.residentLevel) {
+                wanting.push_back(&texture);
+            }
+        }
+        // Highest priority first, then the largest on screen.
+        std::sort(wanting.begin(), wanting.end(), [](const Texture *a, const Texture *b) {
+            return a->priority != b->priority ? a->priority > b->priority
+                                              : a->wantedLevel < b->wantedLevel;
+        });
+        for (auto *texture: wanting) {
+            if (monotonicNs() - start >= budgetNs) {
+                break;
+            }
+            promote(*texture);
+        }
+    }
+    frame++;
+}
+
+void TextureResidency::onContextLost() {
+    // The textures die with the context; only the names are forgotten.
+    contextReady = false;
+    for (auto &texture: textures) {
+        texture.name = 0;
+        texture.residentLevel = texture.floorLevel;
+        texture.residentBytes = 0;
+    }
+}
+
+TextureResidency::Stats TextureResidency::getStats() const {
+    Stats stats = totals;
+    stats.textures = (uint32_t) textures.size();
+    stats.budgetBytes = budget;
+    for (auto &texture: textures) {
+        for (auto &mip: texture.floorMips) {
+            stats.floorBytes += mip.bytes.size();
+        }
+        if (!texture.name) {
+            continue;
+        }
+        stats.resident++;
+        stats.residentBytes += texture.residentBytes;
+        stats.fullResolution += texture.residentLevel == 0;
+        stats.raised += texture.residentLevel < texture.floorLevel;
+        stats.starved += texture.usedFrame + 1 >= frame &&
+                         texture.wantedLevel < texture.residentLevel;
+    }
+    return stats;
+}
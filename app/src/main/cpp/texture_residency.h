@@ -0,0 +1,139 @@
+#pragma once
+
+#include <GLES/gl.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gpu_resources.h"
+#include "slot_map.h"
+
+/**
+ * Keeps textures within a GPU memory budget by streaming mip levels.
+ * Each texture's low mips, those no larger than floorSize, are decoded
+ * once when it is added, kept in memory and always resident. Higher mips
+ * are loaded on demand: every frame the renderer reports how large each
+ * texture appears on screen, and update() raises a texture to the mip its
+ * texel density calls for. When the budget is exceeded, textures not used
+ * this frame are dropped back to their low mips, lowest priority first,
+ * then least recently used.
+ * GLES1 has no base-level control, so changing the top mip re-creates
+ * the texture with that mip as level 0; loading a higher mip decodes the
+ * source again and builds the chain on the CPU. Used from the GL thread
+ * only.
+ */
+class TextureResidency {
+public:
+    struct Stats {
+        uint32_t textures;
+        uint32_t resident;
+        // At their full resolution / raised above their low mips.
+        uint32_t fullResolution;
+        uint32_t raised;
+        // Wanting a higher mip than they have.
+        uint32_t starved;
+        size_t residentBytes;
+        size_t budgetBytes;
+        size_t floorBytes;
+        // Totals since construction.
+        uint32_t loads;
+        uint32_t promotions;
+        uint32_t evictions;
+        size_t evictedBytes;
+    };
+
+private:
+    struct Texture {
+        std::string asset;
+        GpuTextureParams params;
+        int priority;
+        GpuResources::Loader loader;
+        uint32_t width;
+        uint32_t height;
+        GLenum format;
+        uint8_t levels;
+        // First level no larger than floorSize; it and below are in floorMips.
+        uint8_t floorLevel;
+        std::vector<GpuData> floorMips;
+        GLuint name;
+        uint8_t residentLevel;
+        uint8_t wantedLevel;
+        uint64_t usedFrame;
+        size_t residentBytes;
+    };
+
+    SlotMap<Texture> textures;
+    AAssetManager *assets = nullptr;
+    size_t budget;
+    uint32_t floorSize;
+    uint64_t frame = 1;
+    bool contextReady = false;
+    Stats totals{};
+
+    static size_t chainBytes(const Texture &texture, uint32_t level);
+
+    bool load(const Texture &texture, GpuData &data);
+
+    /**
+     * Re-create the GL texture with level as its top mip.
+     * @param levels levels above floorLevel, from level, already decoded
+     */
+    void upload(Texture &texture, uint32_t level, const std::vector<GpuData> &levels);
+
+    bool promote(Texture &texture);
+
+    bool evictFor(size_t bytes);
+
+public:
+    /**
+     * @param budgetBytes GPU memory for every texture and mip combined
+     * @param floorSize largest mip dimension that stays resident
+     */
+    explicit TextureResidency(size_t budgetBytes = 64u << 20, uint32_t floorSize = 64);
+
+    ~TextureResidency() { clear(); }
+
+    void setAssetManager(AAssetManager *assetManager) { assets = assetManager; }
+
+    void setBudget(size_t bytes) { budget = bytes; }
+
+    /**
+     * Decode the texture and keep its low mips; call with or without a
+     * context. Mipmapped minification is assumed.
+     * @param priority higher keeps its high mips longer
+     * @param loader nullptr for GpuResources::loadAsset
+     */
+    SlotHandle add(const std::string &asset, const GpuTextureParams &params, int priority = 0,
+                   GpuResources::Loader loader = nullptr);
+
+    void remove(SlotHandle handle);
+
+    void clear();
+
+    /**
+     * @return the GL name, uploading the low mips if the texture has none
+     * on the GPU; 0 without a context
+     */
+    GLuint get(SlotHandle handle);
+
+    /**
+     * Report that the texture was drawn this frame covering screenWidth by
+     * screenHeight pixels with its full extent, e.g. a quad's projected
+     * size scaled by its UV range. Several reports keep the largest.
+     */
+    void reportUsage(SlotHandle handle, float screenWidth, float screenHeight);
+
+    /**
+     * Load the mips reported usage calls for and end the frame; loads
+     * stop once budgetNs has been spent.
+     */
+    void update(int64_t budgetNs);
+
+    void onContextLost();
+
+    void onContextReady() { contextReady = true; }
+
+    Stats getStats() const;
+};
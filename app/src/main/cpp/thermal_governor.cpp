@@ -0,0 +1,137 @@
+#include "thermal_governor.h"
+
+#include <cmath>
+#include <cstdio>
+#include <dlfcn.h>
+
+#include "logging.h"
+
+namespace {
+    const ThermalGovernor::Quality levels[] = {
+            {1, 1.0f, 60, 2},
+            {1, 0.85f, 30, 1},
+            {2, 0.7f, 20, 1},
+            {2, 0.5f, 10, 0},
+    };
+    const int levelCount = sizeof(levels) / sizeof(levels[0]);
+
+    // Headroom (1.0 = throttling starts) at which each level is entered.
+    const float enterAt[] = {0.0f, 0.75f, 0.85f, 0.95f};
+    static_assert(sizeof(enterAt) / sizeof(enterAt[0]) == levelCount,
+                  "enterAt must cover every level");
+
+    // Step back up only once headroom is this far below the current level's
+    // entry point for several consecutive polls.
+    const float hysteresis = 0.1f;
+    const int recoveryPolls = 5;
+
+    const int64_t pollIntervalNs = 1000000000LL;
+    // Ask for the headroom forecast a few seconds ahead to act before throttling.
+    const int forecastSeconds = 5;
+}
+
+void ThermalGovernor::open(const std::string &standIn) {
+    close();
+    standInPath = standIn;
+    androidHandle = dlopen("libandroid.so", RTLD_NOW);
+    if (androidHandle) {
+        auto acquire = (PF_ACQUIRE) dlsym(androidHandle, "AThermal_acquireManager");
+        release = (PF_RELEASE) dlsym(androidHandle, "AThermal_releaseManager");
+        getHeadroom = (PF_GETHEADROOM) dlsym(androidHandle, "AThermal_getThermalHeadroom");
+        if (acquire && release && getHeadroom) {
+            manager = acquire();
+        }
+    }
+    if (!manager) {
+        LOGI("thermal: headroom API unavailable%s%s", standInPath.empty() ? "" : ", reading ",
+             standInPath.c_str());
+    }
+}
+
+void ThermalGovernor::close() {
+    if (manager) {
+        release(manager);
+        manager = nullptr;
+    }
+    if (androidHandle) {
+        dlclose(androidHandle);
+        androidHandle = nullptr;
+    }
+}
+
+float ThermalGovernor::readHeadroom() {
+    if (manager) {
+        return getHeadroom(manager, forecastSeconds);
+    }
+    float value = NAN;
+    if (!standInPath.empty()) {
+        FILE *fp = fopen(standInPath.c_str(), "r");
+        if (fp) {
+            if (fscanf(fp, "%f", &value) != 1) {
+                value = NAN;
+            }
+            fclose(fp);
+        }
+    }
+    return value;
+}
+
+bool ThermalGovernor::sampleDue(int64_t nowNs) {
+    if (nowNs < nextPollNs || sampling.load(std::memory_order_acquire)) {
+        return false;
+    }
+    nextPollNs = nowNs + pollIntervalNs;
+    sampling.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void ThermalGovernor::sample() {
+    float headroom = readHeadroom();
+    // NAN: not supported, or polled too often; nothing to publish.
+    if (!std::isnan(headroom)) {
+        sampled.store(headroom, std::memory_order_relaxed);
+    }
+    sampling.store(false, std::memory_order_release);
+}
+
+bool ThermalGovernor::update() {
+    float headroom = sampled.exchange(NAN, std::memory_order_acq_rel);
+    if (std::isnan(headroom)) {
+        return false;
+    }
+    lastHeadroom = headroom;
+    int target = 0;
+    while (target + 1 < levelCount && headroom >= enterAt[target + 1]) {
+        target++;
+    }
+    if (target > level) {
+        LOGW("thermal: headroom %.3f, stepping quality down %d -> %d", headroom, level, target);
+        level = target;
+        recoveringPolls = 0;
+        return true;
+    }
+    if (level > 0 && headroom < enterAt[level] - hysteresis) {
+        if (++recoveringPolls >= recoveryPolls) {
+            LOGI("thermal: headroom %.3f, stepping quality up %d -> %d", headroom, level,
+                 level - 1);
+            level--;
+            recoveringPolls = 0;
+            return true;
+        }
+    } else {
+        recoveringPolls = 0;
+    }
+    return false;
+}
+
+bool ThermalGovernor::poll(int64_t nowNs) {
+    if (!sampleDue(nowNs)) {
+        return false;
+    }
+    sample();
+    return update();
+}
+
+const ThermalGovernor::Quality &ThermalGovernor::quality() const {
+    return levels[level];
+}
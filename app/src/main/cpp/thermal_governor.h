@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+struct AThermalManager;
+
+/**
+ * Steps rendering and sensor quality down as thermal headroom shrinks, so
+ * the engine sheds load before the device throttles, and back up with
+ * hysteresis once headroom recovers.
+ * Headroom comes from AThermal_getThermalHeadroom() (API 30, resolved at
+ * runtime since this app targets API 26). Without it a file holding a
+ * single float can stand in, which also makes levels scriptable via adb.
+ *
+ * Reading headroom is a binder call (or a file read), so the frame loop
+ * asks sampleDue(), runs sample() on a background thread, and picks the
+ * result up with update(); poll() does all three in place.
+ */
+class ThermalGovernor {
+public:
+    struct Quality {
+        // eglSwapInterval() value; 2 caps a 60 Hz panel at 30 fps.
+        int swapInterval;
+        float resolutionScale;
+        int32_t sensorRateHz;
+        // 0 = minimal effects .. 2 = full effects.
+        int effectQuality;
+    };
+
+private:
+    typedef AThermalManager *(*PF_ACQUIRE)();
+    typedef void (*PF_RELEASE)(AThermalManager *);
+    typedef float (*PF_GETHEADROOM)(AThermalManager *, int);
+
+    void *androidHandle = nullptr;
+    PF_RELEASE release = nullptr;
+    PF_GETHEADROOM getHeadroom = nullptr;
+    AThermalManager *manager = nullptr;
+    std::string standInPath;
+    int64_t nextPollNs = 0;
+    // Written by sample(), taken by update(); NAN when there is nothing new.
+    std::atomic<float> sampled{NAN};
+    std::atomic<bool> sampling{false};
+    int level = 0;
+    int recoveringPolls = 0;
+    float lastHeadroom = 0;
+
+    float readHeadroom();
+
+public:
+    ~ThermalGovernor() { close(); }
+
+    /**
+     * @param standIn file to read headroom from when the thermal API is
+     * unavailable; empty for none
+     */
+    void open(const std::string &standIn = std::string());
+
+    void close();
+
+    /**
+     * @return true if headroom should be sampled now: at most once per
+     * second, the API's rate limit, and never while a sample is running.
+     * The caller must then call sample().
+     */
+    bool sampleDue(int64_t nowNs);
+
+    /**
+     * Read headroom and publish it for update(). Safe on any thread.
+     */
+    void sample();
+
+    /**
+     * Adjust the quality level to the last published sample, if any.
+     * @return true if the level changed and quality() should be reapplied
+     */
+    bool update();
+
+    /**
+     * sampleDue(), sample() and update() on the calling thread.
+     */
+    bool poll(int64_t nowNs);
+
+    const Quality &quality() const;
+
+    inline int getLevel() const { return level; }
+
+    inline float getLastHeadroom() const { return lastHeadroom; }
+};
@@ -0,0 +1,150 @@
+#include "thread_manager.h"
+
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "logging.h"
+
+namespace {
+    const char *const roleNames[] = {"main", "render", "audio", "worker", "io"};
+    static_assert(sizeof(roleNames) / sizeof(roleNames[0]) == (size_t) ThreadRole::Count,
+                  "roleNames must cover every ThreadRole");
+
+    // Nice values matching the framework's THREAD_PRIORITY_* constants.
+    const int priorityDisplay = -4;
+    const int priorityUrgentAudio = -19;
+    const int priorityBackground = 10;
+
+    pid_t currentTid() {
+        return (pid_t) gettid();
+    }
+
+    bool setNice(int nice) {
+        if (setpriority(PRIO_PROCESS, (id_t) currentTid(), nice) != 0) {
+            LOGW("thread: setpriority(%d) failed: %s", nice, strerror(errno));
+            return false;
+        }
+        return true;
+    }
+
+    int64_t readClock(clockid_t clock) {
+        timespec ts;
+        if (clock_gettime(clock, &ts) != 0) {
+            return -1;
+        }
+        return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    }
+}
+
+void ThreadManager::init() {
+    topology.load();
+}
+
+void ThreadManager::applyPolicy(ThreadRole role) {
+    switch (role) {
+        case ThreadRole::Main:
+        case ThreadRole::Render:
+            CpuTopology::pinCurrentThread(topology.bigCores());
+            setNice(priorityDisplay);
+            break;
+        case ThreadRole::Audio: {
+            CpuTopology::pinCurrentThread(topology.bigCores());
+            sched_param param;
+            memset(&param, 0, sizeof(param));
+            param.sched_priority = 2;
+            if (sched_setscheduler(0, SCHED_FIFO, &param) != 0) {
+                // Ordinary apps normally lack CAP_SYS_NICE; settle for nice.
+                setNice(priorityUrgentAudio);
+            }
+            break;
+        }
+        case ThreadRole::Io: {
+            auto little = topology.littleCores();
+            CpuTopology::pinCurrentThread(little.empty() ? topology.bigCores() : little);
+            setNice(priorityBackground);
+            break;
+        }
+        case ThreadRole::Worker:
+        default:
+            break;
+    }
+}
+
+void ThreadManager::registerCurrentThread(ThreadRole role, const char *name) {
+    pthread_setname_np(pthread_self(), name);
+    applyPolicy(role);
+    Entry entry;
+    entry.role = role;
+    entry.tid = currentTid();
+    // CLOCK_THREAD_CPUTIME_ID is no fallback: it reads whichever thread
+    // calls clock_gettime(), which in sampleFrame() is the sampler.
+    entry.measurable = cpuClockOf(pthread_self(), &entry.clock) == 0;
+    entry.lastCpuNs = entry.measurable ? readClock(entry.clock) : 0;
+    if (!entry.measurable) {
+        LOGW("thread: no CPU clock for %s, its time will not be counted", name);
+    }
+    LOGI("thread: %s registered as %s (tid %d)", name, roleNames[(size_t) role], entry.tid);
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.push_back(entry);
+}
+
+void ThreadManager::unregisterCurrentThread() {
+    auto tid = currentTid();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (entries[i].tid == tid) {
+            entries[i] = entries.back();
+            entries.pop_back();
+            break;
+        }
+    }
+}
+
+void ThreadManager::sampleFrame(uint32_t logInterval) {
+    for (auto &s: stats) {
+        s.frameCpuNs = 0;
+        s.threads = 0;
+        s.unmeasured = 0;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &e: entries) {
+            auto &s = stats[(size_t) e.role];
+            auto now = e.measurable ? readClock(e.clock) : -1;
+            if (now < 0) {
+                s.unmeasured++;
+                continue;
+            }
+            s.frameCpuNs += now - e.lastCpuNs;
+            s.threads++;
+            e.lastCpuNs = now;
+        }
+    }
+    for (size_t i = 0; i < (size_t) ThreadRole::Count; i++) {
+        windowCpuNs[i] += stats[i].frameCpuNs;
+    }
+    if (!logInterval || ++windowFrames < logInterval) {
+        return;
+    }
+    LOGI("cpu/frame: main=%.2fms render=%.2fms audio=%.2fms worker=%.2fms io=%.2fms",
+         windowCpuNs[0] / 1e6 / windowFrames, windowCpuNs[1] / 1e6 / windowFrames,
+         windowCpuNs[2] / 1e6 / windowFrames, windowCpuNs[3] / 1e6 / windowFrames,
+         windowCpuNs[4] / 1e6 / windowFrames);
+    memset(windowCpuNs, 0, sizeof(windowCpuNs));
+    windowFrames = 0;
+}
+
+std::vector<pid_t> ThreadManager::threadIds(ThreadRole role) {
+    std::vector<pid_t> ids;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto &e: entries) {
+        if (e.role == role) {
+            ids.push_back(e.tid);
+        }
+    }
+    return ids;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <pthread.h>
+#include <sys/types.h>
+
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "cpu_topology.h"
+
+enum class ThreadRole : uint8_t {
+    Main,
+    Render,
+    Audio,
+    Worker,
+    Io,
+    Count
+};
+
+/**
+ * Registry of engine threads by role.
+ * Registering a thread names it and applies the role's placement and
+ * priority (main/render on big cores with display priority, audio
+ * SCHED_FIFO where permitted, io on little cores at background priority;
+ * workers keep the job system's placement). sampleFrame() reads every
+ * registered thread's CPU-time clock so per-frame cost can be reported per
+ * role rather than as wall time. A thread whose clock cannot be resolved
+ * is still registered but counted as unmeasured, not charged.
+ */
+class ThreadManager {
+public:
+    struct Stats {
+        // CPU time consumed by all threads of the role during the last frame.
+        int64_t frameCpuNs;
+        uint32_t threads;
+        // Registered threads without a CPU clock, left out of frameCpuNs.
+        uint32_t unmeasured;
+    };
+
+private:
+    struct Entry {
+        ThreadRole role;
+        pid_t tid;
+        clockid_t clock;
+        bool measurable;
+        int64_t lastCpuNs;
+    };
+
+    CpuTopology topology;
+    std::mutex mutex;
+    std::vector<Entry> entries;
+    Stats stats[(size_t) ThreadRole::Count] = {};
+    int64_t windowCpuNs[(size_t) ThreadRole::Count] = {};
+    uint32_t windowFrames = 0;
+
+    void applyPolicy(ThreadRole role);
+
+public:
+    // Resolves a thread's CPU clock; replaceable so tests can make it fail.
+    std::function<int(pthread_t, clockid_t *)> cpuClockOf = pthread_getcpuclockid;
+
+    void init();
+
+    /**
+     * Name the calling thread, apply its role policy and start CPU accounting.
+     */
+    void registerCurrentThread(ThreadRole role, const char *name);
+
+    void unregisterCurrentThread();
+
+    /**
+     * Sample every registered thread's CPU clock; call once per frame.
+     * A per-role summary is logged every logInterval frames (0 disables).
+     */
+    void sampleFrame(uint32_t logInterval = 300);
+
+    inline const Stats &getStats(ThreadRole role) const { return stats[(size_t) role]; }
+
+    /**
+     * @return kernel thread ids of every registered thread with the role
+     */
+    std::vector<pid_t> threadIds(ThreadRole role);
+
+    inline const CpuTopology &getTopology() const { return topology; }
+};
@@ -0,0 +1,178 @@
+#include "transform_hierarchy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+    const uint32_t noParent = UINT32_MAX;
+}
+
+void TransformHierarchy::markDirty(uint32_t index) {
+    dirty[index] = 1;
+    firstDirty = std::min<size_t>(firstDirty, index);
+}
+
+TransformHierarchy::NodeId TransformHierarchy::create(NodeId parent) {
+    NodeId id;
+    if (!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+    } else {
+        id = (NodeId) indexOf.size();
+        indexOf.push_back(0);
+        parentOf.push_back(none);
+    }
+    // Appending keeps parents ahead of children, but not depth order.
+    auto index = (uint32_t) ids.size();
+    indexOf[id] = index;
+    parentOf[id] = parent;
+    ids.push_back(id);
+    parentIndex.push_back(parent == none ? noParent : indexOf[parent]);
+    posX.push_back(0);
+    posY.push_back(0);
+    rotation.push_back(0);
+    scale.push_back(1);
+    world.push_back(Affine2D::identity());
+    dirty.push_back(0);
+    markDirty(index);
+    needsSort = true;
+    return id;
+}
+
+void TransformHierarchy::destroy(NodeId id) {
+    if (needsSort) {
+        sortByDepth();
+    }
+    // Children follow their parents, so one forward sweep from the node
+    // collects the whole subtree.
+    std::vector<uint8_t> doomed(ids.size(), 0);
+    doomed[indexOf[id]] = 1;
+    for (size_t i = indexOf[id] + 1; i < ids.size(); i++) {
+        if (parentIndex[i] != noParent && doomed[parentIndex[i]]) {
+            doomed[i] = 1;
+        }
+    }
+    std::vector<uint32_t> remap(ids.size(), noParent);
+    size_t out = 0;
+    for (size_t i = 0; i < ids.size(); i++) {
+        if (doomed[i]) {
+            freeIds.push_back(ids[i]);
+            continue;
+        }
+        remap[i] = (uint32_t) out;
+        ids[out] = ids[i];
+        parentIndex[out] = parentIndex[i] == noParent ? noParent : remap[parentIndex[i]];
+        posX[out] = posX[i];
+        posY[out] = posY[i];
+        rotation[out] = rotation[i];
+        scale[out] = scale[i];
+        world[out] = world[i];
+        dirty[out] = dirty[i];
+        indexOf[ids[out]] = (uint32_t) out;
+        out++;
+    }
+    for (auto *v: {&posX, &posY, &rotation, &scale}) {
+        v->resize(out);
+    }
+    ids.resize(out);
+    parentIndex.resize(out);
+    world.resize(out);
+    dirty.resize(out);
+    firstDirty = 0;
+}
+
+bool TransformHierarchy::setParent(NodeId id, NodeId parent) {
+    // A cycle would have no root to sort from.
+    for (NodeId walk = parent; walk != none; walk = parentOf[walk]) {
+        if (walk == id) {
+            return false;
+        }
+    }
+    parentOf[id] = parent;
+    needsSort = true;
+    markDirty(indexOf[id]);
+    return true;
+}
+
+void TransformHierarchy::setLocal(NodeId id, float x, float y, float radians,
+                                  float uniformScale) {
+    auto i = indexOf[id];
+    posX[i] = x;
+    posY[i] = y;
+    rotation[i] = radians;
+    scale[i] = uniformScale;
+    markDirty(i);
+}
+
+void TransformHierarchy::sortByDepth() {
+    needsSort = false;
+    size_t n = ids.size();
+    std::vector<uint32_t> depth(n, UINT32_MAX);
+    for (size_t i = 0; i < n; i++) {
+        // Walk up to the first node with a known depth, then fill back down.
+        uint32_t d = 0;
+        NodeId walk = ids[i];
+        while (walk != none && depth[indexOf[walk]] == UINT32_MAX) {
+            walk = parentOf[walk];
+            d++;
+        }
+        uint32_t base = walk == none ? 0 : depth[indexOf[walk]] + 1;
+        walk = ids[i];
+        while (walk != none && depth[indexOf[walk]] == UINT32_MAX) {
+            depth[indexOf[walk]] = base + --d;
+            walk = parentOf[walk];
+        }
+    }
+    std::vector<uint32_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&depth](uint32_t l, uint32_t r) {
+        return depth[l] < depth[r];
+    });
+    auto permute = [&order](auto &v) {
+        auto copy = v;
+        for (size_t i = 0; i < order.size(); i++) {
+            v[i] = copy[order[i]];
+        }
+    };
+    permute(ids);
+    permute(posX);
+    permute(posY);
+    permute(rotation);
+    permute(scale);
+    permute(world);
+    permute(dirty);
+    for (size_t i = 0; i < n; i++) {
+        indexOf[ids[i]] = (uint32_t) i;
+    }
+    for (size_t i = 0; i < n; i++) {
+        auto p = parentOf[ids[i]];
+        parentIndex[i] = p == none ? noParent : indexOf[p];
+    }
+    firstDirty = 0;
+}
+
+void TransformHierarchy::update() {
+    if (needsSort) {
+        sortByDepth();
+    }
+    size_t n = ids.size();
+    for (size_t i = firstDirty; i < n; i++) {
+        auto p = parentIndex[i];
+        if (p != noParent && dirty[p]) {
+            dirty[i] = 1;
+        }
+        if (!dirty[i]) {
+            continue;
+        }
+        float cs = std::cos(rotation[i]) * scale[i];
+        float sn = std::sin(rotation[i]) * scale[i];
+        Affine2D local{cs, sn, -sn, cs, posX[i], posY[i]};
+        world[i] = p == noParent ? local : world[p] * local;
+    }
+    // Flags are consumed only after the pass so children can still see them.
+    if (firstDirty < n) {
+        std::fill(dirty.begin() + firstDirty, dirty.end(), 0);
+    }
+    firstDirty = SIZE_MAX;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * 2D affine transform: x' = a*x + c*y + tx, y' = b*x + d*y + ty.
+ */
+struct Affine2D {
+    float a, b, c, d, tx, ty;
+
+    static Affine2D identity() { return Affine2D{1, 0, 0, 1, 0, 0}; }
+
+    /**
+     * this * o: apply o first, then this.
+     */
+    inline Affine2D operator*(const Affine2D &o) const {
+        return Affine2D{a * o.a + c * o.b, b * o.a + d * o.b,
+                        a * o.c + c * o.d, b * o.c + d * o.d,
+                        a * o.tx + c * o.ty + tx, b * o.tx + d * o.ty + ty};
+    }
+};
+
+/**
+ * Parent/child transform tree stored as flat arrays sorted by depth, so
+ * every parent precedes its children. setLocal() only flags the node;
+ * update() makes one forward pass starting at the first dirty node,
+ * recomputing world transforms for flagged nodes and, through the
+ * propagated flag, their descendants. Untouched subtrees cost a flag
+ * test each. Structural changes (reparenting, removal) re-sort lazily.
+ */
+class TransformHierarchy {
+public:
+    typedef uint32_t NodeId;
+    static constexpr NodeId none = UINT32_MAX;
+
+private:
+    // Dense, depth-sorted arrays.
+    std::vector<NodeId> ids;
+    std::vector<uint32_t> parentIndex;
+    std::vector<float> posX, posY, rotation, scale;
+    std::vector<Affine2D> world;
+    std::vector<uint8_t> dirty;
+
+    // Stable id -> dense index, and parent ids for re-sorting.
+    std::vector<uint32_t> indexOf;
+    std::vector<NodeId> parentOf;
+    std::vector<NodeId> freeIds;
+    size_t firstDirty = SIZE_MAX;
+    bool needsSort = false;
+
+    void markDirty(uint32_t index);
+
+    void sortByDepth();
+
+public:
+    NodeId create(NodeId parent = none);
+
+    /**
+     * Remove a node together with its whole subtree.
+     */
+    void destroy(NodeId id);
+
+    /**
+     * Move a node (with its subtree) under another parent, or to the root.
+     * @return false, changing nothing, if parent is the node itself or one
+     *         of its descendants
+     */
+    bool setParent(NodeId id, NodeId parent);
+
+    void setLocal(NodeId id, float x, float y, float radians, float uniformScale);
+
+    /**
+     * Bring every world transform up to date.
+     */
+    void update();
+
+    inline const Affine2D &worldOf(NodeId id) const { return world[indexOf[id]]; }
+
+    inline size_t size() const { return ids.size(); }
+};
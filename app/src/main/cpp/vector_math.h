@@ -0,0 +1,382 @@
+#pragma once
+
+#include <cmath>
+#include <type_traits>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#define VECTOR_MATH_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define VECTOR_MATH_SSE 1
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+#endif
+
+/*
+ * Small vector/matrix library for engine math.
+ * Everything is usable in constant expressions through a scalar path;
+ * at run time Vec4, Mat4 and Quat switch to NEON or SSE (SSE4.1 dot
+ * products, AVX for two-column matrix products) chosen at compile time.
+ * Matrices are column-major, as OpenGL expects.
+ */
+
+struct Vec2 {
+    float x, y;
+
+    constexpr Vec2 operator+(Vec2 o) const { return Vec2{x + o.x, y + o.y}; }
+
+    constexpr Vec2 operator-(Vec2 o) const { return Vec2{x - o.x, y - o.y}; }
+
+    constexpr Vec2 operator*(float s) const { return Vec2{x * s, y * s}; }
+
+    constexpr bool operator==(const Vec2 &) const = default;
+};
+
+constexpr float dot(Vec2 a, Vec2 b) { return a.x * b.x + a.y * b.y; }
+
+inline float length(Vec2 v) { return std::sqrt(dot(v, v)); }
+
+struct Vec3 {
+    float x, y, z;
+
+    constexpr Vec3 operator+(Vec3 o) const { return Vec3{x + o.x, y + o.y, z + o.z}; }
+
+    constexpr Vec3 operator-(Vec3 o) const { return Vec3{x - o.x, y - o.y, z - o.z}; }
+
+    constexpr Vec3 operator*(float s) const { return Vec3{x * s, y * s, z * s}; }
+
+    constexpr Vec3 operator-() const { return Vec3{-x, -y, -z}; }
+
+    constexpr bool operator==(const Vec3 &) const = default;
+};
+
+constexpr float dot(Vec3 a, Vec3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+constexpr Vec3 cross(Vec3 a, Vec3 b) {
+    return Vec3{a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+inline float length(Vec3 v) { return std::sqrt(dot(v, v)); }
+
+inline Vec3 normalize(Vec3 v) { return v * (1.0f / length(v)); }
+
+struct alignas(16) Vec4 {
+    float x, y, z, w;
+
+    constexpr bool operator==(const Vec4 &) const = default;
+};
+
+namespace vmath_detail {
+#if VECTOR_MATH_NEON
+    typedef float32x4_t f4;
+
+    inline f4 load(const float *p) { return vld1q_f32(p); }
+
+    inline void store(float *p, f4 v) { vst1q_f32(p, v); }
+
+    inline f4 splat(float v) { return vdupq_n_f32(v); }
+
+    inline f4 add(f4 a, f4 b) { return vaddq_f32(a, b); }
+
+    inline f4 sub(f4 a, f4 b) { return vsubq_f32(a, b); }
+
+    inline f4 mul(f4 a, f4 b) { return vmulq_f32(a, b); }
+
+    inline f4 madd(f4 acc, f4 a, f4 b) { return vmlaq_f32(acc, a, b); }
+
+    inline float hsum(f4 v) {
+#if defined(__aarch64__)
+        return vaddvq_f32(v);
+#else
+        float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+        return vget_lane_f32(vpadd_f32(s, s), 0);
+#endif
+    }
+
+    inline float dot4(f4 a, f4 b) { return hsum(mul(a, b)); }
+#elif VECTOR_MATH_SSE
+    typedef __m128 f4;
+
+    inline f4 load(const float *p) { return _mm_load_ps(p); }
+
+    inline void store(float *p, f4 v) { _mm_store_ps(p, v); }
+
+    inline f4 splat(float v) { return _mm_set1_ps(v); }
+
+    inline f4 add(f4 a, f4 b) { return _mm_add_ps(a, b); }
+
+    inline f4 sub(f4 a, f4 b) { return _mm_sub_ps(a, b); }
+
+    inline f4 mul(f4 a, f4 b) { return _mm_mul_ps(a, b); }
+
+    inline f4 madd(f4 acc, f4 a, f4 b) { return _mm_add_ps(acc, _mm_mul_ps(a, b)); }
+
+    inline float dot4(f4 a, f4 b) {
+#if defined(__SSE4_1__)
+        return _mm_cvtss_f32(_mm_dp_ps(a, b, 0xf1));
+#else
+        f4 m = _mm_mul_ps(a, b);
+        f4 s = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+        s = _mm_add_ss(s, _mm_movehl_ps(s, s));
+        return _mm_cvtss_f32(s);
+#endif
+    }
+#endif
+}
+
+constexpr Vec4 operator+(const Vec4 &a, const Vec4 &b) {
+#if VECTOR_MATH_NEON || VECTOR_MATH_SSE
+    if (!std::is_constant_evaluated()) {
+        Vec4 r;
+        vmath_detail::store(&r.x, vmath_detail::add(vmath_detail::load(&a.x),
+                                                     vmath_detail::load(&b.x)));
+        return r;
+    }
+#endif
+    return Vec4{a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w};
+}
+
+constexpr Vec4 operator-(const Vec4 &a, const Vec4 &b) {
+#if VECTOR_MATH_NEON || VECTOR_MATH_SSE
+    if (!std::is_constant_evaluated()) {
+        Vec4 r;
+        vmath_detail::store(&r.x, vmath_detail::sub(vmath_detail::load(&a.x),
+                                                     vmath_detail::load(&b.x)));
+        return r;
+    }
+#endif
+    return Vec4{a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w};
+}
+
+constexpr Vec4 operator*(const Vec4 &a, float s) {
+#if VECTOR_MATH_NEON || VECTOR_MATH_SSE
+    if (!std::is_constant_evaluated()) {
+        Vec4 r;
+        vmath_detail::store(&r.x, vmath_detail::mul(vmath_detail::load(&a.x),
+                                                     vmath_detail::splat(s)));
+        return r;
+    }
+#endif
+    return Vec4{a.x * s, a.y * s, a.z * s, a.w * s};
+}
+
+constexpr float dot(const Vec4 &a, const Vec4 &b) {
+#if VECTOR_MATH_NEON || VECTOR_MATH_SSE
+    if (!std::is_constant_evaluated()) {
+        return vmath_detail::dot4(vmath_detail::load(&a.x), vmath_detail::load(&b.x));
+    }
+#endif
+    return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+inline float length(const Vec4 &v) { return std::sqrt(dot(v, v)); }
+
+/**
+ * Column-major 4x4 matrix: m[column * 4 + row].
+ */
+struct alignas(16) Mat4 {
+    float m[16];
+
+    static constexpr Mat4 identity() {
+        return Mat4{{1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1}};
+    }
+
+    static constexpr Mat4 translation(Vec3 t) {
+        return Mat4{{1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, t.x, t.y, t.z, 1}};
+    }
+
+    static constexpr Mat4 scale(Vec3 s) {
+        return Mat4{{s.x, 0, 0, 0, 0, s.y, 0, 0, 0, 0, s.z, 0, 0, 0, 0, 1}};
+    }
+
+    /**
+     * Same matrix as glOrthof().
+     */
+    static constexpr Mat4 ortho(float left, float right, float bottom, float top, float near,
+                                float far) {
+        return Mat4{{2 / (right - left), 0, 0, 0,
+                     0, 2 / (top - bottom), 0, 0,
+                     0, 0, -2 / (far - near), 0,
+                     -(right + left) / (right - left), -(top + bottom) / (top - bottom),
+                     -(far + near) / (far - near), 1}};
+    }
+
+    /**
+     * Same matrix as gluPerspective(); fovY in radians.
+     */
+    static inline Mat4 perspective(float fovY, float aspect, float near, float far) {
+        float f = 1.0f / std::tan(fovY / 2);
+        return Mat4{{f / aspect, 0, 0, 0,
+                     0, f, 0, 0,
+                     0, 0, (far + near) / (near - far), -1,
+                     0, 0, 2 * far * near / (near - far), 0}};
+    }
+
+    constexpr Vec4 column(int c) const {
+        return Vec4{m[c * 4], m[c * 4 + 1], m[c * 4 + 2], m[c * 4 + 3]};
+    }
+
+    constexpr bool operator==(const Mat4 &) const = default;
+};
+
+constexpr Vec4 operator*(const Mat4 &a, const Vec4 &v) {
+#if VECTOR_MATH_NEON || VECTOR_MATH_SSE
+    if (!std::is_constant_evaluated()) {
+        using namespace vmath_detail;
+        f4 r = mul(load(a.m), splat(v.x));
+        r = madd(r, load(a.m + 4), splat(v.y));
+        r = madd(r, load(a.m + 8), splat(v.z));
+        r = madd(r, load(a.m + 12), splat(v.w));
+        Vec4 out;
+        store(&out.x, r);
+        return out;
+    }
+#endif
+    Vec4 out{0, 0, 0, 0};
+    float *o[4] = {&out.x, &out.y, &out.z, &out.w};
+    for (int row = 0; row < 4; row++) {
+        *o[row] = a.m[row] * v.x + a.m[4 + row] * v.y + a.m[8 + row] * v.z + a.m[12 + row] * v.w;
+    }
+    return out;
+}
+
+constexpr Mat4 operator*(const Mat4 &a, const Mat4 &b) {
+#if defined(__AVX__) && VECTOR_MATH_SSE
+    if (!std::is_constant_evaluated()) {
+        // Two result columns per 256-bit step.
+        __m256 a0 = _mm256_broadcast_ps((const __m128 *) a.m);
+        __m256 a1 = _mm256_broadcast_ps((const __m128 *) (a.m + 4));
+        __m256 a2 = _mm256_broadcast_ps((const __m128 *) (a.m + 8));
+        __m256 a3 = _mm256_broadcast_ps((const __m128 *) (a.m + 12));
+        Mat4 r;
+        for (int c = 0; c < 16; c += 8) {
+            __m256 acc = _mm256_mul_ps(a0, _mm256_setr_ps(
+                    b.m[c], b.m[c], b.m[c], b.m[c], b.m[c + 4], b.m[c + 4], b.m[c + 4], b.m[c + 4]));
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(a1, _mm256_setr_ps(
+                    b.m[c + 1], b.m[c + 1], b.m[c + 1], b.m[c + 1],
+                    b.m[c + 5], b.m[c + 5], b.m[c + 5], b.m[c + 5])));
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(a2, _mm256_setr_ps(
+                    b.m[c + 2], b.m[c + 2], b.m[c + 2], b.m[c + 2],
+                    b.m[c + 6], b.m[c + 6], b.m[c + 6], b.m[c + 6])));
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(a3, _mm256_setr_ps(
+                    b.m[c + 3], b.m[c + 3], b.m[c + 3], b.m[c + 3],
+                    b.m[c + 7], b.m[c + 7], b.m[c + 7], b.m[c + 7])));
+            // Mat4 is only 16-byte aligned.
+            _mm256_storeu_ps(r.m + c, acc);
+        }
+        return r;
+    }
+#elif VECTOR_MATH_NEON || VECTOR_MATH_SSE
+    if (!std::is_constant_evaluated()) {
+        Mat4 r;
+        for (int c = 0; c < 4; c++) {
+            Vec4 col = a * b.column(c);
+            vmath_detail::store(r.m + c * 4, vmath_detail::load(&col.x));
+        }
+        return r;
+    }
+#endif
+    Mat4 r{};
+    for (int c = 0; c < 4; c++) {
+        for (int row = 0; row < 4; row++) {
+            float s = 0;
+            for (int k = 0; k < 4; k++) {
+                s += a.m[k * 4 + row] * b.m[c * 4 + k];
+            }
+            r.m[c * 4 + row] = s;
+        }
+    }
+    return r;
+}
+
+constexpr Mat4 transpose(const Mat4 &a) {
+    Mat4 r{};
+    for (int c = 0; c < 4; c++) {
+        for (int row = 0; row < 4; row++) {
+            r.m[row * 4 + c] = a.m[c * 4 + row];
+        }
+    }
+    return r;
+}
+
+/**
+ * Rotation quaternion, w being the scalar part.
+ */
+struct alignas(16) Quat {
+    float x, y, z, w;
+
+    static constexpr Quat identity() { return Quat{0, 0, 0, 1}; }
+
+    static inline Quat fromAxisAngle(Vec3 axis, float radians) {
+        Vec3 n = normalize(axis);
+        float s = std::sin(radians / 2);
+        return Quat{n.x * s, n.y * s, n.z * s, std::cos(radians / 2)};
+    }
+
+    constexpr bool operator==(const Quat &) const = default;
+};
+
+/**
+ * Hamilton product: apply b first, then a.
+ */
+constexpr Quat operator*(const Quat &a, const Quat &b) {
+    return Quat{a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+                a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+                a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+                a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z};
+}
+
+constexpr float dot(const Quat &a, const Quat &b) {
+    return dot(Vec4{a.x, a.y, a.z, a.w}, Vec4{b.x, b.y, b.z, b.w});
+}
+
+inline Quat normalize(const Quat &q) {
+    float s = 1.0f / std::sqrt(dot(q, q));
+    return Quat{q.x * s, q.y * s, q.z * s, q.w * s};
+}
+
+constexpr Vec3 rotate(const Quat &q, Vec3 v) {
+    // v + 2w(u x v) + 2u x (u x v), u being the vector part.
+    Vec3 u{q.x, q.y, q.z};
+    Vec3 t = cross(u, v) * 2;
+    return v + t * q.w + cross(u, t);
+}
+
+constexpr Mat4 toMat4(const Quat &q) {
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+    return Mat4{{1 - 2 * (yy + zz), 2 * (xy + wz), 2 * (xz - wy), 0,
+                 2 * (xy - wz), 1 - 2 * (xx + zz), 2 * (yz + wx), 0,
+                 2 * (xz + wy), 2 * (yz - wx), 1 - 2 * (xx + yy), 0,
+                 0, 0, 0, 1}};
+}
+
+/**
+ * Shortest-path spherical interpolation; falls back to nlerp when the
+ * inputs are nearly parallel.
+ */
+inline Quat slerp(const Quat &a, Quat b, float t) {
+    float cosTheta = dot(a, b);
+    if (cosTheta < 0) {
+        b = Quat{-b.x, -b.y, -b.z, -b.w};
+        cosTheta = -cosTheta;
+    }
+    float wa, wb;
+    if (cosTheta > 0.9995f) {
+        wa = 1 - t;
+        wb = t;
+    } else {
+        float theta = std::acos(cosTheta);
+        float inv = 1.0f / std::sin(theta);
+        wa = std::sin((1 - t) * theta) * inv;
+        wb = std::sin(t * theta) * inv;
+    }
+    return normalize(Quat{a.x * wa + b.x * wb, a.y * wa + b.y * wb, a.z * wa + b.z * wb,
+                          a.w * wa + b.w * wb});
+}
@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""Aggregate hot-path perf records and compare them with a baseline.
+
+Reads logcat output containing perf-record lines (logged by the engine on
+every termDisplay) or Google Benchmark JSON files, such as the host
+suite's (engine_bench; see host/CMakeLists.txt):
+
+    adb logcat -d -s native-activity > session.txt
+    tools/perf_compare.py session.txt
+    tools/perf_compare.py session.txt --save baseline.json
+    tools/perf_compare.py session.txt --baseline baseline.json
+
+Records are labelled with where they were emitted: "termDisplay", or the
+scenario name for replays (see session_replay.h); --label selects one.
+
+Per path, the mean is weighted by iterations across records; p50, p90 and
+p99 are the median of the per-record values. cpu_time is only reported
+when every record measured it; device records do not. With --baseline, exits 1
+when a mean or p90 grew by more than --threshold percent and --min-ns
+nanoseconds. A saved baseline is itself Google Benchmark JSON.
+"""
+
+import argparse
+import json
+import re
+import statistics
+import sys
+
+RECORD = re.compile(r"perf-record (\{.*\})")
+UNITS = {"ns": 1, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def read_runs(paths, label=None):
+    """All benchmark entries, times converted to ns; only records with the
+    given context label, if any."""
+    runs = []
+    for path in paths or ["-"]:
+        stream = sys.stdin if path == "-" else open(path, encoding="utf-8", errors="replace")
+        with stream:
+            text = stream.read()
+        documents = []
+        if text.lstrip().startswith("{"):
+            documents.append(json.loads(text))
+        for match in RECORD.finditer(text):
+            try:
+                documents.append(json.loads(match.group(1)))
+            except ValueError:
+                pass
+        for document in documents:
+            if label and document.get("context", {}).get("label") != label:
+                continue
+            for run in document.get("benchmarks", []):
+                if run.get("run_type", "iteration") != "iteration":
+                    continue
+                scale = UNITS.get(run.get("time_unit", "ns"), 1)
+                entry = {"name": run["name"], "iterations": run.get("iterations", 1)}
+                for key in ("real_time", "cpu_time", "p50", "p90", "p99", "max"):
+                    if key in run:
+                        entry[key] = run[key] * scale
+                runs.append(entry)
+    return runs
+
+
+def aggregate(runs):
+    results = {}
+    for name in dict.fromkeys(run["name"] for run in runs):
+        group = [run for run in runs if run["name"] == name]
+        iterations = sum(run["iterations"] for run in group)
+        result = {
+            "name": name,
+            "run_type": "iteration",
+            "iterations": iterations,
+            "real_time": sum(run["real_time"] * run["iterations"] for run in group) / iterations,
+            "time_unit": "ns",
+        }
+        # Device records carry wall time only; keep cpu_time where it was measured.
+        if all("cpu_time" in run for run in group):
+            result["cpu_time"] = sum(run["cpu_time"] * run["iterations"]
+                                     for run in group) / iterations
+        for key in ("p50", "p90", "p99"):
+            values = [run[key] for run in group if key in run]
+            if values:
+                result[key] = statistics.median(values)
+        values = [run["max"] for run in group if "max" in run]
+        if values:
+            result["max"] = max(values)
+        results[name] = result
+    return results
+
+
+def print_results(results, baseline):
+    width = max([16] + [len(name) + 2 for name in results])
+    print(f"{'path':<{width}}{'iterations':>12}{'mean':>12}{'cpu':>12}{'p50':>12}{'p90':>12}"
+          f"{'p99':>12}{'vs base':>10}")
+    for name, r in results.items():
+        base = baseline.get(name)
+        change = f"{(r['real_time'] / base['real_time'] - 1) * 100:+9.1f}%" if base else ""
+        # Benchmark JSON has no percentiles, and device records no cpu_time.
+        cells = "".join(f"{r[key]:>12.0f}" if key in r else f"{'-':>12}"
+                        for key in ("real_time", "cpu_time", "p50", "p90", "p99"))
+        print(f"{name:<{width}}{r['iterations']:>12}{cells}{change:>10}")
+
+
+def compare(results, baseline, threshold, min_ns):
+    regressions = []
+    for name, r in results.items():
+        base = baseline.get(name)
+        if not base:
+            continue
+        for key in ("real_time", "p90"):
+            if key not in r or key not in base:
+                continue
+            delta = r[key] - base[key]
+            if delta > min_ns and delta > base[key] * threshold / 100:
+                regressions.append(f"{name} {key}: {base[key]:.0f} -> {r[key]:.0f} ns")
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("inputs", nargs="*", help="logcat output or benchmark JSON; stdin if none")
+    parser.add_argument("--label", help="only records with this context label")
+    parser.add_argument("--save", metavar="FILE", help="write the results as a baseline")
+    parser.add_argument("--baseline", metavar="FILE", help="compare with a baseline")
+    parser.add_argument("--threshold", type=float, default=10, help="percent, default 10")
+    parser.add_argument("--min-ns", type=float, default=100, help="ignore smaller growth")
+    args = parser.parse_args()
+
+    runs = read_runs(args.inputs, args.label)
+    if not runs:
+        sys.exit("no perf records found")
+    results = aggregate(runs)
+    baseline = {}
+    if args.baseline:
+        baseline = aggregate(read_runs([args.baseline]))
+    print_results(results, baseline)
+    if args.save:
+        with open(args.save, "w", encoding="utf-8") as out:
+            json.dump({"context": {"label": "baseline"}, "benchmarks": list(results.values())},
+                      out, indent=2)
+    if args.baseline:
+        regressions = compare(results, baseline, args.threshold, args.min_ns)
+        for regression in regressions:
+            print("regression: " + regression)
+        if regressions:
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""Aggregate startup-record lines from logcat over many launches.
+
+Collect launches with e.g.
+
+    for i in $(seq 20); do
+        adb shell am force-stop com.example.native_activity
+        adb shell am start -W -n com.example.native_activity/android.app.NativeActivity
+        sleep 3
+    done
+    adb logcat -d -s native-activity > launches.txt
+
+then run
+
+    tools/startup_report.py launches.txt
+    tools/startup_report.py launches.txt --save baseline.json
+    tools/startup_report.py launches.txt --baseline baseline.json
+
+Milestones are reported as time since the launch's first milestone and as
+the step from the previous one. Records carry the build variant; logs
+holding launches of two builds get a side-by-side table of medians, e.g.
+the JNI cache against its baseline:
+
+    ./gradlew installDebug -PjniBaseline=ON   # then collect launches as above
+    ./gradlew installDebug                    # and again, into the same file
+    tools/startup_report.py launches.txt
+
+The first variant seen is the "before" column. With --baseline, exits 1 when a median
+grew by more than --threshold percent and --min-ms milliseconds, so CI can
+fail on cold-start regressions.
+"""
+
+import argparse
+import json
+import re
+import statistics
+import sys
+
+RECORD = re.compile(r"startup-record (\{.*\})")
+
+
+def read_records(paths):
+    records = []
+    for path in paths or ["-"]:
+        stream = sys.stdin if path == "-" else open(path, encoding="utf-8", errors="replace")
+        with stream:
+            for line in stream:
+                match = RECORD.search(line)
+                if match:
+                    try:
+                        records.append(json.loads(match.group(1)))
+                    except ValueError:
+                        pass
+    return records
+
+
+def percentile(values, p):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(round(p / 100 * (len(values) - 1))))]
+
+
+def kind_of(record):
+    """'cold', 'warm', or either followed by the build variant."""
+    kind = record.get("launch", "cold")
+    variant = record.get("variant")
+    return f"{kind} {variant}" if variant else kind
+
+
+def summarize(records):
+    """{launch kind: {metric: {n, median, p90, max}}}; metrics are
+    'at.<milestone>' and 'step.<milestone>'."""
+    summary = {}
+    for kind in sorted({kind_of(r) for r in records}):
+        runs = [r for r in records if kind_of(r) == kind]
+        names = [k for k in runs[0] if k not in ("v", "launch", "variant")]
+        samples = {}
+        for run in runs:
+            previous = None
+            for name in names:
+                value = run.get(name)
+                if value is None:
+                    continue
+                samples.setdefault("at." + name, []).append(value)
+                if previous is not None:
+                    samples.setdefault("step." + name, []).append(value - previous)
+                previous = value
+        summary[kind] = {
+            metric: {
+                "n": len(values),
+                "median": statistics.median(values),
+                "p90": percentile(values, 90),
+                "max": max(values),
+            }
+            for metric, values in samples.items()
+        }
+    return summary
+
+
+def print_summary(summary):
+    for kind, metrics in summary.items():
+        n = max(m["n"] for m in metrics.values())
+        print(f"{kind} launches: {n}")
+        print(f"  {'milestone':<16}{'median':>10}{'p90':>10}{'max':>10}{'step':>10}")
+        for metric, m in metrics.items():
+            if not metric.startswith("at."):
+                continue
+            name = metric[3:]
+            step = metrics.get("step." + name)
+            step_text = f"{step['median']:10.2f}" if step else f"{'':>10}"
+            print(f"  {name:<16}{m['median']:10.2f}{m['p90']:10.2f}{m['max']:10.2f}{step_text}")
+
+
+def print_variants(records, summary):
+    """Before/after medians for each launch kind seen in several variants."""
+    for launch in sorted({r.get("launch", "cold") for r in records}):
+        variants = []
+        for r in records:
+            variant = r.get("variant")
+            if r.get("launch", "cold") == launch and variant and variant not in variants:
+                variants.append(variant)
+        if len(variants) < 2:
+            continue
+        before, after = (summary[f"{launch} {v}"] for v in variants[:2])
+        print(f"{launch} launches, {variants[0]} -> {variants[1]} (medians)")
+        print(f"  {'milestone':<16}{'before':>10}{'after':>10}{'delta':>10}")
+        for metric, b in before.items():
+            a = after.get(metric)
+            if not metric.startswith("at.") or not a:
+                continue
+            print(f"  {metric[3:]:<16}{b['median']:10.2f}{a['median']:10.2f}"
+                  f"{a['median'] - b['median']:+10.2f}")
+
+
+def compare(summary, baseline, threshold, min_ms):
+    regressions = []
+    for kind, metrics in summary.items():
+        for metric, m in metrics.items():
+            base = baseline.get(kind, {}).get(metric)
+            if not base:
+                continue
+            delta = m["median"] - base["median"]
+            if delta > min_ms and delta > base["median"] * threshold / 100:
+                regressions.append(f"{kind} {metric}: {base['median']:.2f} -> "
+                                   f"{m['median']:.2f} ms (+{delta:.2f})")
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("logs", nargs="*", help="logcat output; stdin if none")
+    parser.add_argument("--save", metavar="FILE", help="write the summary as a baseline")
+    parser.add_argument("--baseline", metavar="FILE", help="compare medians to a baseline")
+    parser.add_argument("--threshold", type=float, default=10, help="percent, default 10")
+    parser.add_argument("--min-ms", type=float, default=2, help="ignore smaller growth")
+    args = parser.parse_args()
+
+    records = read_records(args.logs)
+    if not records:
+        sys.exit("no startup-record lines found")
+    summary = summarize(records)
+    print_summary(summary)
+    print_variants(records, summary)
+    if args.save:
+        with open(args.save, "w", encoding="utf-8") as out:
+            json.dump(summary, out, indent=2)
+    if args.baseline:
+        with open(args.baseline, encoding="utf-8") as f:
+            regressions = compare(summary, json.load(f), args.threshold, args.min_ms)
+        for regression in regressions:
+            print("regression: " + regression)
+        if regressions:
+            sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()